@@ -22,6 +22,16 @@ namespace rdkit_extensions
 
 /**
  * Captures all messages issued to RDKit error logging
+ *
+ * Captures are per thread: messages logged on a thread are captured by the
+ * innermost capture on that same thread, or are logged as usual if there is
+ * none. This allows conversions on different threads to capture their own
+ * errors concurrently.
+ *
+ * NOTE: rdErrorLog's enabled state is global. It is saved when the first
+ * capture begins and restored when the last one ends, so programs that capture
+ * on several threads should keep a capture alive on the main thread for the
+ * whole run.
  */
 class RDKIT_EXTENSIONS_API CaptureRDErrorLog : private boost::noncopyable
 {
@@ -36,8 +46,6 @@ class RDKIT_EXTENSIONS_API CaptureRDErrorLog : private boost::noncopyable
 
   private:
     std::stringstream m_messages;
-    std::ostream* m_saved_dp_dest;
-    boost::logging::RDTeeStream* m_saved_teestream;
     bool m_error_log_initial_state = true;
 };
 
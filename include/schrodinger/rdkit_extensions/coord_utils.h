@@ -35,7 +35,9 @@ compute_centroid(const std::vector<RDGeom::Point3D>& positions);
  * and will ignore SetPreferCoordGen if set.
  *
  * @param mol rdkit mol
- * @param frozen_ids vector of atom indexes to NOT generate coordinates for
+ * @param frozen_ids vector of atom indexes to NOT generate coordinates for. For
+ * monomeric molecules, only the polymers containing non-frozen monomers are
+ * laid out again.
  * @return ID of the conformation added to the molecule containing the 2D coords
  */
 RDKIT_EXTENSIONS_API unsigned int
@@ -8,14 +8,15 @@
 #include <QColor>
 #include <QHash>
 #include <QImage>
+#include <QList>
 #include <QPicture>
 #include <QSize>
+#include <string>
+#include <vector>
 
 #include "schrodinger/sketcher/definitions.h"
 #include "schrodinger/sketcher/image_constants.h"
 
-template <typename T> class QList;
-
 namespace RDKit
 {
 class ROMol;
@@ -173,5 +174,36 @@ SKETCHER_API qreal
 get_best_image_scale(const QList<RDKit::ROMol*> all_rdmols,
                      const RenderOptions& opts = RenderOptions());
 
+/**
+ * Render many molecules at once on a pool of threads.  Molecules are rendered
+ * off the calling thread whenever possible; reactions, monomeric molecules and
+ * images that use halo highlighting or the simplified stereo annotation are
+ * rendered on the calling thread.
+ *
+ * @param mols/texts molecules to render
+ * @param format format of the images
+ * @param opts given image generation configuration
+ * @param use_common_scale whether to render all molecules at the same scale,
+ * namely the largest one that allows every molecule to fit within
+ * opts.width_height.  The scale is found while rendering, so there's no need
+ * to call get_best_image_scale first.  If true, opts.scale will be ignored.
+ * @param num_threads number of threads to render on, including the calling
+ * thread, or 0 to use one thread per core
+ * @return byte arrays of data generated from the 2D sketcher, in the same
+ * order as the input
+ * @throw std::exception if any of the molecules can't be rendered
+ */
+SKETCHER_API QList<QByteArray>
+get_batch_image_bytes(const QList<RDKit::ROMol*>& mols, ImageFormat format,
+                      const RenderOptions& opts = RenderOptions(),
+                      bool use_common_scale = false,
+                      unsigned int num_threads = 0);
+SKETCHER_API QList<QByteArray>
+get_batch_image_bytes(const std::vector<std::string>& texts,
+                      ImageFormat format,
+                      const RenderOptions& opts = RenderOptions(),
+                      bool use_common_scale = false,
+                      unsigned int num_threads = 0);
+
 } // namespace sketcher
 } // namespace schrodinger
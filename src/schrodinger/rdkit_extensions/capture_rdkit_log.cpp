@@ -1,31 +1,164 @@
 #include "schrodinger/rdkit_extensions/capture_rdkit_log.h"
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <vector>
+
 namespace schrodinger
 {
 namespace rdkit_extensions
 {
 
-CaptureRDErrorLog::CaptureRDErrorLog() :
-    m_saved_dp_dest(&m_messages),
-    m_saved_teestream(nullptr)
+namespace
+{
+
+// Active captures on the current thread, innermost last
+thread_local std::vector<std::ostream*> t_capture_streams;
+
+// Output from the current thread, while it isn't capturing, that hasn't been
+// written to the original destination yet
+thread_local std::string t_fallback_buffer;
+
+// Serializes writes to the original destination, which is shared by all
+// threads that aren't capturing
+std::mutex g_fallback_mutex;
+
+/**
+ * Stream buffer installed as rdErrorLog's destination while any capture is
+ * active. Writes are forwarded to the innermost capture on the writing thread.
+ * If that thread isn't capturing, they are buffered per thread and written to
+ * the original destination one complete line at a time, so that messages from
+ * different threads aren't interleaved.
+ */
+class ThreadCaptureBuffer : public std::streambuf
 {
+  public:
+    std::atomic<std::ostream*> fallback = nullptr;
+
+  protected:
+    int_type overflow(int_type ch) override
+    {
+        if (traits_type::eq_int_type(ch, traits_type::eof())) {
+            return traits_type::not_eof(ch);
+        }
+        auto c = traits_type::to_char_type(ch);
+        if (!t_capture_streams.empty()) {
+            t_capture_streams.back()->put(c);
+        } else {
+            t_fallback_buffer += c;
+            if (c == '\n') {
+                write_fallback_lines(/* flush = */ false);
+            }
+        }
+        return ch;
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize count) override
+    {
+        if (!t_capture_streams.empty()) {
+            t_capture_streams.back()->write(s, count);
+        } else {
+            t_fallback_buffer.append(s, count);
+            write_fallback_lines(/* flush = */ false);
+        }
+        return count;
+    }
+
+    int sync() override
+    {
+        if (!t_capture_streams.empty()) {
+            t_capture_streams.back()->flush();
+        } else {
+            write_fallback_lines(/* flush = */ true);
+        }
+        return 0;
+    }
+
+  private:
+    /**
+     * Write this thread's buffered output, up to and including the last
+     * newline, to the original destination
+     * @param flush whether to also write any trailing partial line and flush
+     * the destination
+     */
+    void write_fallback_lines(bool flush)
+    {
+        auto count = flush ? t_fallback_buffer.size()
+                           : t_fallback_buffer.rfind('\n') + 1;
+        if (count == 0 && !flush) {
+            // rfind returned npos, so there's no complete line yet
+            return;
+        }
+        if (auto dest = fallback.load()) {
+            std::lock_guard<std::mutex> lock(g_fallback_mutex);
+            dest->write(t_fallback_buffer.data(), count);
+            if (flush) {
+                dest->flush();
+            }
+        }
+        t_fallback_buffer.erase(0, count);
+    }
+};
+
+std::mutex g_capture_mutex;
+size_t g_num_active_captures = 0;
+ThreadCaptureBuffer g_capture_buffer;
+std::ostream g_capture_stream(&g_capture_buffer);
+std::ostream* g_saved_dp_dest = nullptr;
+boost::logging::RDTeeStream* g_saved_teestream = nullptr;
+bool g_saved_enabled_state = true;
+
+} // namespace
+
+CaptureRDErrorLog::CaptureRDErrorLog()
+{
+    std::lock_guard<std::mutex> lock(g_capture_mutex);
     if (rdErrorLog == nullptr) {
         RDLog::InitLogs();
-    } else {
-        // Make sure at least the error log is active
-        // so we can capture something.
+    }
+    // The enabled state is global, so it is saved by the first capture and
+    // restored by the last one. Captures nested on the same thread save it as
+    // well, since that thread may have changed it in between.
+    if (g_num_active_captures == 0) {
+        g_saved_enabled_state = rdErrorLog->df_enabled;
+    } else if (!t_capture_streams.empty()) {
         m_error_log_initial_state = rdErrorLog->df_enabled;
-        rdErrorLog->df_enabled = true;
     }
-    std::swap(rdErrorLog->dp_dest, m_saved_dp_dest);
-    std::swap(rdErrorLog->teestream, m_saved_teestream);
+    // Make sure at least the error log is active so we can capture something.
+    rdErrorLog->df_enabled = true;
+    if (g_num_active_captures++ == 0) {
+        // the tee stream writes to dp_dest and to a second stream, so it
+        // replaces dp_dest for threads that aren't capturing
+        g_saved_dp_dest = rdErrorLog->dp_dest;
+        g_saved_teestream = rdErrorLog->teestream;
+        g_capture_buffer.fallback = g_saved_teestream
+                                        ? g_saved_teestream
+                                        : g_saved_dp_dest;
+        rdErrorLog->dp_dest = &g_capture_stream;
+        rdErrorLog->teestream = nullptr;
+    }
+    t_capture_streams.push_back(&m_messages);
 }
 
 CaptureRDErrorLog::~CaptureRDErrorLog()
 {
-    std::swap(rdErrorLog->dp_dest, m_saved_dp_dest);
-    std::swap(rdErrorLog->teestream, m_saved_teestream);
-    rdErrorLog->df_enabled = m_error_log_initial_state;
+    std::lock_guard<std::mutex> lock(g_capture_mutex);
+    auto capture = std::find(t_capture_streams.rbegin(),
+                             t_capture_streams.rend(), &m_messages);
+    t_capture_streams.erase(std::next(capture).base());
+    if (--g_num_active_captures == 0) {
+        // write out anything this thread logged before it started capturing
+        g_capture_stream.flush();
+        rdErrorLog->dp_dest = g_saved_dp_dest;
+        rdErrorLog->teestream = g_saved_teestream;
+        rdErrorLog->df_enabled = g_saved_enabled_state;
+    } else if (!t_capture_streams.empty()) {
+        rdErrorLog->df_enabled = m_error_log_initial_state;
+    }
+    // otherwise, captures on other threads still need the log to be enabled
 }
 
 std::string CaptureRDErrorLog::messages() const
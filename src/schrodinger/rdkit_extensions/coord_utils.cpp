@@ -3,6 +3,7 @@
 #include "schrodinger/rdkit_extensions/helm/monomer_coordgen.h"
 
 #include <algorithm>
+#include <unordered_set>
 
 #include <rdkit/Geometry/point.h>
 #include <rdkit/GraphMol/Depictor/DepictUtils.h>
@@ -34,7 +35,25 @@ unsigned int compute2DCoords(RDKit::ROMol& mol,
                              const std::vector<unsigned int>& frozen_ids)
 {
     if (isMonomeric(mol)) {
-        return compute_monomer_mol_coords(mol);
+        if (frozen_ids.empty() || mol.getNumConformers() == 0) {
+            return compute_monomer_mol_coords(mol);
+        }
+        // only lay out the polymers with monomers that aren't frozen. Like a
+        // full layout, this adds a new conformer and leaves the existing ones
+        // untouched.
+        std::unordered_set<unsigned int> frozen(frozen_ids.begin(),
+                                                frozen_ids.end());
+        std::vector<unsigned int> changed_monomers;
+        for (auto atom : mol.atoms()) {
+            if (!frozen.contains(atom->getIdx())) {
+                changed_monomers.push_back(atom->getIdx());
+            }
+        }
+        auto conformer = new RDKit::Conformer(mol.getConformer());
+        auto conformer_id = mol.addConformer(conformer, true);
+        update_monomer_mol_coords(mol, changed_monomers, {},
+                                  static_cast<int>(conformer_id));
+        return conformer_id;
     }
 
     RDDepict::Compute2DCoordParameters params;
@@ -0,0 +1,402 @@
+#include "schrodinger/rdkit_extensions/fasta/transcode.h"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include <rdkit/GraphMol/RWMol.h>
+
+#include "schrodinger/rdkit_extensions/fasta/monomers.h"
+#include "schrodinger/rdkit_extensions/fasta/to_rdkit.h"
+#include "schrodinger/rdkit_extensions/fasta/to_string.h"
+#include "schrodinger/rdkit_extensions/helm/helm_parser.h"
+#include "schrodinger/rdkit_extensions/helm/to_rdkit.h"
+#include "schrodinger/rdkit_extensions/helm/to_string.h"
+
+using schrodinger::rdkit_extensions::Format;
+
+static const std::string UNSUPPORTED_FASTA_FORMAT_ERROR{
+    "Please use any of the FASTA_PEPTIDE, FASTA_DNA or FASTA_RNA formats to "
+    "convert FASTA input."};
+
+namespace
+{
+struct [[nodiscard]] fasta_polymer_info {
+    std::string_view polymer_prefix;
+    std::string_view sugar_helm_monomer;
+};
+} // namespace
+
+[[nodiscard]] static fasta_polymer_info get_fasta_polymer_info(Format format);
+
+template <class T> static void append_polymer_helm(
+    fmt::memory_buffer& output_helm, const fasta::fasta_sequence& generic_fasta,
+    T get_helm_monomer_function, std::string_view polymer_prefix,
+    int polymer_number);
+
+[[nodiscard]] static std::string
+get_error_message(std::string_view sequence, unsigned int num_chars_processed,
+                  std::string_view err_msg);
+
+[[nodiscard]] static std::optional<std::string>
+transcode_helm_info(const helm::helm_info& parsed_info);
+
+namespace fasta
+{
+
+// parses fasta sequences from the input text. some notes:
+//  * recognizes '>' prefixed descriptions as sequence annotations
+//  * sequences must immediately follow a sequence annotation, else they'll be
+//    considered as a part of the previous sequence, if there is one
+//  * recognizes sequences/subsequences separated by whitespace as a single
+//    sequence. i.e.
+//                  ABC
+//                  DEF
+//    and
+//                  A B
+//                      C D
+//                  EF
+//
+//    will be recognized as ABCDEF
+//  * sequences can contain gaps and spaces -  these will not be functionally
+//    significant.
+//  * translation stops '*' are not supported
+[[nodiscard]] std::vector<fasta_sequence>
+get_fasta_sequences(std::string_view generic_fasta)
+{
+    std::vector<fasta_sequence> fasta_sequences;
+    std::optional<fasta_sequence> current_sequence;
+
+    auto save_current_sequence = [&]() {
+        if (current_sequence && current_sequence->annotation) {
+            fasta_sequences.push_back(std::move(*current_sequence));
+            current_sequence = std::nullopt;
+        }
+    };
+
+    auto append_to_current_sequence = [&](std::string_view line) {
+        std::copy_if(line.begin(), line.end(),
+                     std::back_inserter(current_sequence->sequence),
+                     [](char c) { return c != '-' && c != ' '; });
+    };
+
+    // walk the lines in place rather than splitting them into copies
+    size_t line_start = 0;
+    while (line_start <= generic_fasta.size()) {
+        auto line_end = generic_fasta.find('\n', line_start);
+        if (line_end == std::string_view::npos) {
+            line_end = generic_fasta.size();
+        }
+        const auto line =
+            generic_fasta.substr(line_start, line_end - line_start);
+        line_start = line_end + 1;
+
+        if (line.empty()) {
+            continue; // skip line
+        } else if (line[0] == '>') {
+            save_current_sequence();
+            current_sequence = {std::string{line.substr(1)}, ""};
+        } else {
+            if (!current_sequence) {
+                current_sequence = {std::nullopt, ""};
+            }
+            append_to_current_sequence(line);
+        }
+    }
+    save_current_sequence();
+
+    for (const auto& [annotation, monomers] : fasta_sequences) {
+        if (monomers.empty()) {
+            throw std::invalid_argument(fmt::format(
+                "There's no sequence associated with annotation, '{}'",
+                *annotation));
+        }
+    }
+    return fasta_sequences;
+}
+
+[[nodiscard]] std::string
+fasta_sequences_to_helm(const std::vector<fasta_sequence>& fasta_sequences,
+                        Format format)
+{
+    if (fasta_sequences.empty()) {
+        throw std::invalid_argument(
+            "Couldn't retrieve any FASTA sequences from input");
+    }
+
+    const auto [polymer_prefix, sugar_helm_monomer] =
+        get_fasta_polymer_info(format);
+
+    fmt::memory_buffer output_helm;
+    int polymer_number = 0;
+    for (const auto& fasta_sequence : fasta_sequences) {
+        static constexpr char polymer_separator{'|'};
+        if (polymer_number != 0) {
+            output_helm.push_back(polymer_separator);
+        }
+
+        if (format == Format::FASTA_PEPTIDE) {
+            append_polymer_helm(output_helm, fasta_sequence,
+                                get_fasta_to_helm_amino_acid, polymer_prefix,
+                                ++polymer_number);
+        } else {
+            append_polymer_helm(
+                output_helm, fasta_sequence,
+                [sugar = sugar_helm_monomer](char one_letter_monomer) {
+                    return get_fasta_to_helm_nucleotide(one_letter_monomer,
+                                                        sugar);
+                },
+                polymer_prefix, ++polymer_number);
+        }
+    }
+    fmt::format_to(std::back_inserter(output_helm), "$$$$V2.0");
+    return {output_helm.data(), output_helm.size()};
+}
+
+[[nodiscard]] std::string fasta_to_helm(const std::string& generic_fasta,
+                                        Format format)
+{
+    const auto fasta_sequences = get_fasta_sequences(generic_fasta);
+
+    // Quotes can't be written verbatim in a HELM annotation, so defer to the
+    // HELM parser for whatever the generated string ends up meaning
+    if (std::any_of(fasta_sequences.begin(), fasta_sequences.end(),
+                    [](const auto& fasta_sequence) {
+                        return fasta_sequence.annotation &&
+                               fasta_sequence.annotation->find('"') !=
+                                   std::string::npos;
+                    })) {
+        std::unique_ptr<::RDKit::RWMol> mol;
+        switch (format) {
+            case Format::FASTA_PEPTIDE:
+                mol = peptide_fasta_to_rdkit(generic_fasta);
+                break;
+            case Format::FASTA_RNA:
+                mol = rna_fasta_to_rdkit(generic_fasta);
+                break;
+            case Format::FASTA_DNA:
+                mol = dna_fasta_to_rdkit(generic_fasta);
+                break;
+            default:
+                throw std::invalid_argument(UNSUPPORTED_FASTA_FORMAT_ERROR);
+        }
+        return helm::rdkit_to_helm(*mol);
+    }
+
+    return fasta_sequences_to_helm(fasta_sequences, format);
+}
+
+[[nodiscard]] std::string helm_to_fasta(const std::string& helm_string)
+{
+    const auto parsed_info = helm::parse_helm(helm_string);
+    if (auto output_fasta = transcode_helm_info(*parsed_info)) {
+        return std::move(*output_fasta);
+    }
+    return rdkit_to_fasta(*helm::helm_to_rdkit(helm_string));
+}
+
+FastaRecordReader::FastaRecordReader(std::istream& input) : m_input(input)
+{
+}
+
+[[nodiscard]] std::optional<std::string> FastaRecordReader::next()
+{
+    std::string record;
+    if (m_next_annotation_line) {
+        record = std::move(*m_next_annotation_line);
+        record.push_back('\n');
+        m_next_annotation_line = std::nullopt;
+    }
+
+    std::string line;
+    while (std::getline(m_input, line)) {
+        if (!line.empty() && line.front() == '>' && !record.empty()) {
+            m_next_annotation_line = std::move(line);
+            return record;
+        } else if (line.empty() && record.empty()) {
+            continue; // skip blank lines between records
+        }
+        record.append(line);
+        record.push_back('\n');
+    }
+
+    if (record.empty()) {
+        return std::nullopt;
+    }
+    return record;
+}
+
+} // namespace fasta
+
+[[nodiscard]] static fasta_polymer_info get_fasta_polymer_info(Format format)
+{
+    // NOTE: DNA is expressed as an RNA polymer with deoxyribose sugars
+    switch (format) {
+        case Format::FASTA_PEPTIDE:
+            return {"PEPTIDE", ""};
+        case Format::FASTA_RNA:
+            return {"RNA", "R"};
+        case Format::FASTA_DNA:
+            return {"RNA", "[dR]"};
+        default:
+            throw std::invalid_argument(UNSUPPORTED_FASTA_FORMAT_ERROR);
+    }
+}
+
+template <class T> static void append_polymer_helm(
+    fmt::memory_buffer& output_helm, const fasta::fasta_sequence& generic_fasta,
+    T get_helm_monomer_function, std::string_view polymer_prefix,
+    int polymer_number)
+{
+    auto out = std::back_inserter(output_helm);
+    fmt::format_to(out, "{}{}{{", polymer_prefix, polymer_number);
+
+    unsigned int num_chars_processed = 0;
+    for (auto monomer : generic_fasta.sequence) {
+        ++num_chars_processed;
+        auto helm_monomer = get_helm_monomer_function(monomer);
+        if (helm_monomer == std::nullopt) {
+            throw std::invalid_argument(
+                get_error_message(generic_fasta.sequence, num_chars_processed,
+                                  "Unsupported monomer"));
+        }
+
+        static constexpr char monomer_separator{'.'};
+        if (num_chars_processed != 1) {
+            output_helm.push_back(monomer_separator);
+        }
+        fmt::format_to(out, "{}", *helm_monomer);
+    }
+    output_helm.push_back('}');
+
+    if (generic_fasta.annotation && !generic_fasta.annotation->empty()) {
+        fmt::format_to(out, "\"{}\"", *generic_fasta.annotation);
+    }
+}
+
+[[nodiscard]] static std::string
+get_error_message(std::string_view sequence, unsigned int num_chars_processed,
+                  std::string_view err_msg)
+{
+    // NOTE: If the input is very long, the pointer to the failed location
+    // becomes less useful. We should truncate the length of the error message
+    // to 101 chars.
+    static constexpr int error_size{101};
+    static constexpr unsigned int prefix_size{error_size / 2};
+    static auto truncate_input = [](const auto& input, const unsigned int pos) {
+        if ((pos >= prefix_size) && (pos + prefix_size) < input.size()) {
+            return input.substr(pos - prefix_size, error_size);
+        } else if (pos >= prefix_size) {
+            return input.substr(pos - prefix_size);
+        } else {
+            return input.substr(
+                0, std::min(input.size(), static_cast<size_t>(error_size)));
+        }
+    };
+
+    size_t num_dashes =
+        (num_chars_processed >= prefix_size ? prefix_size
+                                            : num_chars_processed - 1);
+    return fmt::format(
+        "Malformed FASTA string: check for mistakes around position {}:\n"
+        "{}\n"
+        "{}^\n"
+        "{}",
+        num_chars_processed, truncate_input(sequence, num_chars_processed - 1),
+        std::string(num_dashes, '-'), err_msg);
+}
+
+// Returns the one letter code for a single-character HELM monomer, or
+// std::nullopt if the monomer needs the mol-based conversion
+template <class T> [[nodiscard]] static std::optional<char>
+get_fasta_monomer(const helm::monomer& monomer, T get_fasta_monomer_function)
+{
+    if (monomer.is_smiles || monomer.is_list || monomer.id.size() != 1) {
+        return std::nullopt;
+    }
+    return get_fasta_monomer_function(std::string{monomer.id});
+}
+
+[[nodiscard]] static bool append_peptide_fasta(const helm::polymer& polymer,
+                                               std::string& peptide_fasta)
+{
+    for (const auto& monomer : polymer.monomers) {
+        auto fasta_monomer =
+            get_fasta_monomer(monomer, fasta::get_helm_to_fasta_amino_acid);
+        if (!fasta_monomer) {
+            return false;
+        }
+        peptide_fasta.push_back(*fasta_monomer);
+    }
+    return true;
+}
+
+[[nodiscard]] static bool
+append_nucleotide_fasta(const helm::polymer& polymer,
+                        std::string& nucleotide_fasta)
+{
+    // Only sequences made exclusively of sugar(base)phosphate subunits with a
+    // uniform R or [dR] sugar are transcoded directly. NOTE: the parser strips
+    // the square brackets from multi-character monomer ids
+    const auto& monomers = polymer.monomers;
+    if (monomers.size() % 3 != 0) {
+        return false;
+    }
+
+    const auto& reference_sugar = monomers.front().id;
+    if (reference_sugar != "R" && reference_sugar != "dR") {
+        return false;
+    }
+
+    for (size_t i = 0; i < monomers.size(); i += 3) {
+        const auto& sugar = monomers[i];
+        const auto& base = monomers[i + 1];
+        const auto& phosphate = monomers[i + 2];
+        if (sugar.is_branch || sugar.id != reference_sugar || !base.is_branch ||
+            phosphate.is_branch || phosphate.id != "P") {
+            return false;
+        }
+
+        auto fasta_monomer =
+            get_fasta_monomer(base, fasta::get_helm_to_fasta_nucleotide);
+        if (!fasta_monomer) {
+            return false;
+        }
+        nucleotide_fasta.push_back(*fasta_monomer);
+    }
+    return true;
+}
+
+[[nodiscard]] static std::optional<std::string>
+transcode_helm_info(const helm::helm_info& parsed_info)
+{
+    // NOTE: connections, polymer groups and extended annotations aren't
+    // represented in FASTA, so they're ignored just like in rdkit_to_fasta
+    fmt::memory_buffer output_fasta;
+    for (const auto& polymer : parsed_info.polymers) {
+        if (!polymer.repetitions.empty() || polymer.monomers.empty()) {
+            return std::nullopt;
+        }
+
+        std::string sequence;
+        sequence.reserve(polymer.monomers.size());
+        // PEPTIDE[0-9]* or RNA[0-9]*
+        bool was_transcoded = false;
+        if (polymer.id.front() == 'P') {
+            was_transcoded = append_peptide_fasta(polymer, sequence);
+        } else if (polymer.id.front() == 'R') {
+            was_transcoded = append_nucleotide_fasta(polymer, sequence);
+        }
+        if (!was_transcoded) {
+            return std::nullopt;
+        }
+
+        fmt::format_to(std::back_inserter(output_fasta), ">{}\n{}\n",
+                       polymer.annotation, sequence);
+    }
+    return std::string{output_fasta.data(), output_fasta.size()};
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "schrodinger/rdkit_extensions/definitions.h"
+#include "schrodinger/rdkit_extensions/file_format.h"
+
+#include <istream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fasta
+{
+
+struct [[nodiscard]] fasta_sequence {
+    std::optional<std::string> annotation;
+    std::string sequence;
+};
+
+/*
+ * Splits FASTA text into its annotated sequences. Gaps and spaces are stripped
+ * from the sequences, and sequence lines that aren't preceded by a '>'
+ * annotation are ignored.
+ *
+ * @param generic_fasta: one or more fasta sequences
+ * @throws std::invalid_argument: If an annotation has no sequence
+ */
+[[nodiscard]] std::vector<fasta_sequence>
+get_fasta_sequences(std::string_view generic_fasta);
+
+/*
+ * Builds the HELM string for the given FASTA sequences directly, without
+ * validating the generated HELM.
+ *
+ * @param fasta_sequences: the sequences, as returned by get_fasta_sequences
+ * @param format: one of FASTA_PEPTIDE, FASTA_RNA or FASTA_DNA
+ * @throws std::invalid_argument: If a sequence contains unsupported monomers or
+ *                                if there are no sequences
+ */
+[[nodiscard]] std::string
+fasta_sequences_to_helm(const std::vector<fasta_sequence>& fasta_sequences,
+                        schrodinger::rdkit_extensions::Format format);
+
+/*
+ * Converts FASTA text to HELM without building a monomeric mol. The output is
+ * identical to rdkit_to_helm on the mol returned by the corresponding
+ * *_fasta_to_rdkit api; annotations that can't be written verbatim in HELM are
+ * converted through the mol instead.
+ *
+ * @param generic_fasta: one or more fasta sequences
+ * @param format: one of FASTA_PEPTIDE, FASTA_RNA or FASTA_DNA
+ * @throws std::invalid_argument: If the input is malformed
+ */
+[[nodiscard]] RDKIT_EXTENSIONS_API std::string
+fasta_to_helm(const std::string& generic_fasta,
+              schrodinger::rdkit_extensions::Format format);
+
+/*
+ * Converts a HELM string to FASTA by walking the HELM parse tree instead of
+ * building a monomeric mol. The output is identical to rdkit_to_fasta on the
+ * mol returned by helm_to_rdkit; inputs that can't be transcoded directly
+ * (monomer lists, inline SMILES, repetitions, irregular nucleotides, etc.) are
+ * converted through the mol instead.
+ *
+ * @param helm_string: the HELM input
+ * @throws std::invalid_argument: If the input is malformed or can't be
+ *                                expressed as FASTA
+ */
+[[nodiscard]] RDKIT_EXTENSIONS_API std::string
+helm_to_fasta(const std::string& helm_string);
+
+/*
+ * Reads a multi-record FASTA stream one record at a time, so that arbitrarily
+ * large files can be transcoded without being loaded into memory. Each record
+ * is the '>' annotation line followed by its sequence lines, and can be passed
+ * directly to fasta_to_helm or the *_fasta_to_rdkit apis.
+ *
+ * NOTE: Lines before the first '>' annotation are returned as their own record
+ */
+class RDKIT_EXTENSIONS_API FastaRecordReader
+{
+  public:
+    explicit FastaRecordReader(std::istream& input);
+
+    /**
+     * @return the next FASTA record, or std::nullopt once the stream is
+     *         exhausted
+     */
+    [[nodiscard]] std::optional<std::string> next();
+
+  private:
+    std::istream& m_input;
+    std::optional<std::string> m_next_annotation_line;
+};
+
+} // namespace fasta
@@ -7,6 +7,7 @@
 #include <fmt/ranges.h>
 #include <regex>
 #include <string>
+#include <unordered_map>
 
 #include <rdkit/GraphMol/SmilesParse/SmilesParse.h>
 
@@ -38,6 +39,36 @@ constexpr bool isdigit(unsigned char c) noexcept
     return '0' <= c && c <= '9';
 }
 
+/**
+ * @brief Checks if a token contains a letter that can't appear in a SMILES
+ *        string outside of square brackets, i.e. one that isn't part of the
+ *        organic subset. This is a conservative lexical check: letters that
+ *        RDKit may accept as extensions are never rejected.
+ */
+constexpr bool has_non_organic_subset_letter(std::string_view token) noexcept
+{
+    constexpr std::string_view organic_subset{"BCNOPSFIbcnops"};
+    // letters that RDKit may accept unbracketed, so let the SMILES parser
+    // decide about these
+    constexpr std::string_view deferred_letters{"Haet"};
+
+    for (size_t i = 0; i < token.size(); ++i) {
+        const auto c = token[i];
+        if (!(('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z')) ||
+            organic_subset.find(c) != std::string_view::npos ||
+            deferred_letters.find(c) != std::string_view::npos) {
+            continue;
+        }
+        // the second letter of Cl and Br
+        if (i > 0 && ((c == 'l' && token[i - 1] == 'C') ||
+                      (c == 'r' && token[i - 1] == 'B'))) {
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
 /**
  * @brief Checks if a value can be used as a ratio.
  * @note a ratio is defined as a non-zero unsigned number
@@ -387,6 +418,10 @@ template <class error_handler_t> class [[nodiscard]] parser_t
   private:
     error_handler_t m_error_handler;
 
+    // whether each distinct multi-character monomer id is an inline SMILES.
+    // The keys point into the input, which outlives the parser.
+    std::unordered_map<std::string_view, bool> m_smiles_monomer_ids;
+
     /**
      * @brief Parses a polymer ID, enforcing the prefix (e.g., PEPTIDE) and
      *        the required non-zero numeric suffix (e.g., 1).
@@ -752,9 +787,17 @@ template <class error_handler_t> class [[nodiscard]] parser_t
                 std::ranges::all_of(monomer.id,
                                     [](auto c) { return std::isalnum(c); })) {
                 monomer.is_smiles = false;
-            } else {
-                monomer.is_smiles = is_smiles_monomer(monomer.id);
+                continue;
+            }
+
+            // Monomer ids are usually repeated many times within a HELM
+            // string, so only classify each distinct id once per parse
+            auto [itr, inserted] =
+                m_smiles_monomer_ids.try_emplace(monomer.id, false);
+            if (inserted) {
+                itr->second = is_smiles_monomer(monomer.id);
             }
+            monomer.is_smiles = itr->second;
         }
     }
 
@@ -1927,6 +1970,12 @@ std::optional<helm_info> parse_helm(std::string_view input, bool do_throw)
         return true;
     }
 
+    // Skip the SMILES parser for ids like dR, meA and Orn, which can't be
+    // SMILES without square brackets
+    if (detail::has_non_organic_subset_letter(monomer)) {
+        return false;
+    }
+
     // Parse the SMILES literally
     static const RDKit::v2::SmilesParse::SmilesParserParams smi_opts{
         .sanitize = false, .removeHs = false, .replacements = {}};
@@ -2,6 +2,8 @@
 // Copyright Schrodinger LLC, All Rights Reserved.
 #include "schrodinger/rdkit_extensions/helm.h"
 #include "schrodinger/rdkit_extensions/helm/monomer_coordgen.h"
+#include "schrodinger/rdkit_extensions/helm/monomer_layout_cache.h"
+#include "schrodinger/rdkit_extensions/helm/spatial_grid.h"
 #include "schrodinger/rdkit_extensions/coord_utils.h"
 #include "schrodinger/rdkit_extensions/monomer_directions.h"
 
@@ -32,15 +34,20 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <cmath>
+#include <exception>
 #include <iterator>
+#include <limits>
 #include <map>
 #include <optional>
 #include <queue>
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace schrodinger
@@ -847,7 +854,8 @@ lay_out_turn(RDKit::ROMol& polymer, RDKit::Conformer& conformer,
         current_pos.y += step_y;
 
         conformer.setAtomPos(monomer_idx, current_pos);
-        placed_monomers_idcs.insert(monomer_idx);
+        placed_monomers_idcs.insert(
+            polymer.getAtomWithIdx(monomer_idx)->getProp<int>(ORIGINAL_INDEX));
     }
 
     // Calculate position for next segment: one more rotation and step
@@ -988,18 +996,120 @@ double score_coiling_layout(const RDKit::ROMol& polymer,
 }
 
 /**
- * Computes turn information for coiling chain layout.
- *
+ * The turns of a coiling layout candidate, stored as a prefix table of where
+ * each turn begins and ends. This allows candidates to be scored with a binary
+ * search per monomer instead of a walk over all the turns, and the table can be
+ * reused across candidates to avoid allocating.
+ */
+class CoilingTurnTable
+{
+  public:
+    /**
+     * Fill the table with the turns computed by
+     * compute_coiling_turns_for_chain_with_params for the same parameters.
+     *
+     * @return false if the parameters are invalid or produce no turns
+     */
+    bool fill(unsigned int total_monomers, int increment, int turn_size,
+              int chain_size, int first_chain_size)
+    {
+        m_turn_starts.clear();
+        m_turn_ends.clear();
+        unsigned int residues_accounted = 0;
+        unsigned int current_chain_size = first_chain_size;
+        while (residues_accounted < total_monomers) {
+            if (turn_size < 0) {
+                return false;
+            }
+            unsigned int turn_position =
+                residues_accounted + current_chain_size;
+            if (turn_position >= total_monomers) {
+                break;
+            }
+            m_turn_starts.push_back(turn_position);
+            m_turn_ends.push_back(turn_position +
+                                  static_cast<unsigned int>(turn_size));
+            residues_accounted += current_chain_size + turn_size;
+            current_chain_size = chain_size;
+            turn_size += increment;
+        }
+        return !m_turn_starts.empty();
+    }
+
+    /**
+     * Same as get_position_in_coils_double for the turns in the table
+     */
+    double get_position(unsigned int monomer_idx) const
+    {
+        // turns never overlap, so their ends are strictly increasing
+        auto turn_idx = static_cast<size_t>(
+            std::upper_bound(m_turn_ends.begin(), m_turn_ends.end(),
+                             monomer_idx) -
+            m_turn_ends.begin());
+        int begin_of_section = turn_idx == 0 ? 0 : m_turn_ends[turn_idx - 1];
+        if (turn_idx < m_turn_ends.size()) {
+            int section_number = turn_idx * 2;
+            int section_size = m_turn_starts[turn_idx] - begin_of_section;
+            if (monomer_idx >= m_turn_starts[turn_idx]) {
+                // we're in the turn
+                section_number += 1;
+                begin_of_section = m_turn_starts[turn_idx];
+                section_size = m_turn_ends[turn_idx] - m_turn_starts[turn_idx];
+            }
+            return section_number +
+                   static_cast<double>(monomer_idx + 1 - begin_of_section) /
+                       (section_size + 1);
+        }
+        // we're in the last segment, which is assumed to have the same size as
+        // the last complete segment
+        auto num_turns = m_turn_starts.size();
+        int last_begin_of_section =
+            num_turns < 2 ? 0 : m_turn_ends[num_turns - 2];
+        int section_size = m_turn_starts.back() - last_begin_of_section;
+        int section_number = num_turns * 2;
+        return section_number +
+               static_cast<double>(monomer_idx - begin_of_section) /
+                   (section_size + 1);
+    }
+
+    /**
+     * Same as score_coiling_layout for the turns in the table, rounded to a
+     * float, as candidates have always been compared. Scoring stops as soon as
+     * the score can't be lower than `score_to_beat`.
+     *
+     * @return the score, or std::nullopt if it can't beat `score_to_beat`
+     */
+    std::optional<float>
+    score(const std::vector<CustomBondInfo>& custom_bonds,
+          float score_to_beat) const
+    {
+        // all bond scores are positive, so the running score only grows
+        double total_score = 0.0;
+        for (const auto& bond : custom_bonds) {
+            double distance = std::abs(get_position(bond.monomer_j) -
+                                       get_position(bond.monomer_i));
+            total_score += (distance - 4.0) * (distance - 4.0);
+            if (static_cast<float>(total_score / custom_bonds.size()) >=
+                score_to_beat) {
+                return std::nullopt;
+            }
+        }
+        return static_cast<float>(total_score / custom_bonds.size());
+    }
+
+  private:
+    std::vector<unsigned int> m_turn_starts;
+    // one past the last monomer of each turn
+    std::vector<unsigned int> m_turn_ends;
+};
+
+/**
  * Analyzes CUSTOM_BONDs to determine if the polymer can be laid out as a
  * coiling pattern where chains alternate between top and bottom positions
  * (y = 0, -1, +1, -2, +2, ...), with each turn progressively longer to
  * approximate an ellipse.
- *
- * @param polymer The polymer molecule to analyze
- * @return Vector of turn information if coiling layout is feasible, empty
- *         vector otherwise
  */
-static std::vector<TurnInfo>
+std::vector<TurnInfo>
 compute_coiling_turns_for_chain(const RDKit::ROMol& polymer)
 {
     // Extract all CUSTOM_BONDs
@@ -1033,7 +1143,14 @@ compute_coiling_turns_for_chain(const RDKit::ROMol& polymer)
     // progressively smaller (the equivalent of reversing the sequence). The
     // best layout will be the one that minimizes the distance between connected
     // monomers and their ideal positions in the layers.
-    std::vector<std::vector<TurnInfo>> possible_layouts;
+    struct CoilingParams {
+        int increment;
+        int first_turn_size;
+        int chain_size;
+        int first_chain_size;
+    };
+    std::vector<CoilingParams> candidates;
+    auto num_monomers = polymer.getNumAtoms();
     for (auto increment : {2, -2}) {
         for (auto turn_size = 0; turn_size < 3; ++turn_size) {
             for (auto chain_size = 1; chain_size < 8; ++chain_size) {
@@ -1047,41 +1164,46 @@ compute_coiling_turns_for_chain(const RDKit::ROMol& polymer)
                         int placed_residues = first_chain_size;
                         int current_turn_size = first_turn_size;
                         while (static_cast<unsigned int>(placed_residues) <
-                               polymer.getNumAtoms()) {
+                               num_monomers) {
                             placed_residues += current_turn_size + chain_size;
                             current_turn_size += abs(increment);
                         }
                         first_turn_size = current_turn_size - abs(increment);
                     }
-                    auto turns = compute_coiling_turns_for_chain_with_params(
-                        polymer, increment, first_turn_size, chain_size,
-                        first_chain_size);
-                    if (!turns.empty()) {
-                        possible_layouts.push_back(turns);
-                    }
+                    candidates.push_back({increment, first_turn_size,
+                                          chain_size, first_chain_size});
                 }
             }
         }
     }
+
+    // The first candidate with the lowest score wins, so the search can stop
+    // as soon as a perfect score is found, and a candidate's scoring can stop
+    // as soon as it can't beat the best one so far
+    std::optional<CoilingParams> best_params;
+    float best_score = std::numeric_limits<float>::infinity();
+    CoilingTurnTable turn_table;
+    for (const auto& params : candidates) {
+        if (!turn_table.fill(num_monomers, params.increment,
+                             params.first_turn_size, params.chain_size,
+                             params.first_chain_size)) {
+            continue;
+        }
+        if (auto score = turn_table.score(custom_bonds, best_score)) {
+            best_score = *score;
+            best_params = params;
+            if (best_score == 0.0f) {
+                break;
+            }
+        }
+    }
     // return the best_scoring layout, or empty vector if no valid layouts found
-    if (possible_layouts.empty()) {
+    if (!best_params) {
         return {};
     }
-
-    std::vector<std::pair<std::vector<TurnInfo>, float>> layouts_with_scores;
-    std::transform(possible_layouts.begin(), possible_layouts.end(),
-                   std::back_inserter(layouts_with_scores),
-                   [&polymer, &custom_bonds](const auto& layout) {
-                       return std::make_pair(
-                           layout,
-                           score_coiling_layout(polymer, layout, custom_bonds));
-                   });
-    auto min_layout_and_score =
-        std::min_element(layouts_with_scores.begin(), layouts_with_scores.end(),
-                         [](const auto& layout1, const auto& layout2) {
-                             return layout1.second < layout2.second;
-                         });
-    return min_layout_and_score->first;
+    return compute_coiling_turns_for_chain_with_params(
+        polymer, best_params->increment, best_params->first_turn_size,
+        best_params->chain_size, best_params->first_chain_size);
 }
 
 /**
@@ -2266,33 +2388,89 @@ static bool positions_clash(const RDGeom::Point3D& pos1,
               pos1.y - pos2.y < -MONOMER_CLASH_DISTANCE));
 }
 
-static bool clashes_with_placed_polymers(
-    const RDKit::ROMol& polymer,
-    const std::vector<RDKit::ROMOL_SPTR>& placed_polymers)
+/**
+ * The polymers that have already been positioned by lay_out_polymers, indexed
+ * so that a new polymer can be checked for clashes against all of them without
+ * comparing it to every placed monomer. The index is updated incrementally as
+ * each polymer is placed.
+ */
+class PlacedPolymers
 {
-    for (auto placed_polymer : placed_polymers) {
-        auto bonds_between =
-            get_bonds_between_polymers(polymer, *placed_polymer);
-        if (needs_vertical_flip_due_to_clashes(polymer, *placed_polymer,
-                                               bonds_between)) {
-            return true;
+  public:
+    /**
+     * Add a polymer whose coordinates are final
+     */
+    void add(const RDKit::ROMOL_SPTR& polymer)
+    {
+        auto polymer_idx = m_polymers.size();
+        m_polymers.push_back(polymer);
+        const auto& conformer = polymer->getConformer();
+        for (auto monomer : polymer->atoms()) {
+            m_monomers[monomer->getProp<unsigned int>(ORIGINAL_INDEX)] = {
+                polymer_idx, monomer->getIdx()};
+            m_grid.insert(m_positions.size(),
+                          conformer.getAtomPos(monomer->getIdx()));
+            m_positions.push_back(conformer.getAtomPos(monomer->getIdx()));
         }
-        // do a basic monomer coordinate clash check
+    }
+
+    /**
+     * Check whether `polymer` has bonds to any of the placed polymers that
+     * clash with its own bonds, or has monomers that clash with placed ones
+     */
+    bool clashes_with(const RDKit::ROMol& polymer) const
+    {
+        // same as get_bonds_between_polymers for each placed polymer, but
+        // only for the ones that are actually bonded to `polymer`
+        std::map<size_t, BOND_IDX_VEC> bonds_by_placed_polymer;
         for (auto monomer : polymer.atoms()) {
-            auto monomer_pos =
-                polymer.getConformer().getAtomPos(monomer->getIdx());
-            for (auto placed_monomer : placed_polymer->atoms()) {
-                auto placed_monomer_pos =
-                    placed_polymer->getConformer().getAtomPos(
-                        placed_monomer->getIdx());
-                if (positions_clash(monomer_pos, placed_monomer_pos)) {
-                    return true;
+            std::vector<int> bonded_monomers_indices;
+            monomer->getPropIfPresent<std::vector<int>>(
+                BOND_TO, bonded_monomers_indices);
+            for (auto bonded_idx : bonded_monomers_indices) {
+                auto placed_monomer = m_monomers.find(bonded_idx);
+                if (placed_monomer != m_monomers.end()) {
+                    auto [polymer_idx, placed_monomer_idx] =
+                        placed_monomer->second;
+                    bonds_by_placed_polymer[polymer_idx].push_back(
+                        {monomer->getIdx(), placed_monomer_idx});
                 }
             }
         }
+        for (const auto& [polymer_idx, bonds] : bonds_by_placed_polymer) {
+            if (needs_vertical_flip_due_to_clashes(
+                    polymer, *m_polymers[polymer_idx], bonds)) {
+                return true;
+            }
+        }
+
+        // do a basic monomer coordinate clash check
+        const RDGeom::Point3D clash_offset(MONOMER_CLASH_DISTANCE,
+                                           MONOMER_CLASH_DISTANCE, 0);
+        for (const auto& monomer_pos : polymer.getConformer().getPositions()) {
+            auto clashes = [&](unsigned int placed_monomer_idx) {
+                return positions_clash(monomer_pos,
+                                       m_positions[placed_monomer_idx]);
+            };
+            if (m_grid.any_of(monomer_pos - clash_offset,
+                              monomer_pos + clash_offset, clashes)) {
+                return true;
+            }
+        }
+        return false;
     }
-    return false;
-}
+
+  private:
+    std::vector<RDKit::ROMOL_SPTR> m_polymers;
+    // ORIGINAL_INDEX of each placed monomer -> index of its polymer in
+    // m_polymers and its own index within that polymer
+    std::unordered_map<unsigned int, std::pair<size_t, unsigned int>>
+        m_monomers;
+    // positions of all placed monomers, indexed by their id in m_grid
+    std::vector<RDGeom::Point3D> m_positions;
+    SpatialGrid m_grid{MONOMER_CLASH_DISTANCE};
+};
+
 /**
  * Resolve geometric clashes and topological crossings between
  * `polymer_to_orient` and `reference_polymer` by flipping `polymer_to_orient`
@@ -2335,7 +2513,7 @@ static void resolve_polymer_clashes_and_crossings(
 static void
 orient_polymer(RDKit::ROMol& polymer_to_orient,
                const RDKit::ROMol& reference_polymer, bool polymer_was_rotated,
-               const std::vector<RDKit::ROMOL_SPTR>& placed_polymers)
+               const PlacedPolymers& placed_polymers)
 {
     auto polymer_bonds =
         get_bonds_between_polymers(polymer_to_orient, reference_polymer);
@@ -2354,7 +2532,7 @@ orient_polymer(RDKit::ROMol& polymer_to_orient,
     resolve_polymer_clashes_and_crossings(polymer_to_orient, reference_polymer,
                                           polymer_bonds, invert_placement);
 
-    if (clashes_with_placed_polymers(polymer_to_orient, placed_polymers)) {
+    if (placed_polymers.clashes_with(polymer_to_orient)) {
         invert_placement = true;
         place_polymer_below_reference(polymer_to_orient, reference_polymer,
                                       polymer_bonds, invert_placement);
@@ -2399,10 +2577,15 @@ static void remove_cxsmiles_labels(RDKit::ROMol& monomer_mol)
  * Adjust CHEM polymers (polymers with a single monomer typically used to
  * connect a polymer back to itself or two polymers together) to position them
  * between the two polymers they are connecting.
+ *
+ * @param moved_monomers if given, set to true for every CHEM monomer that was
+ * moved
  */
-static void adjust_chem_polymer_coords(RDKit::ROMol& monomer_mol)
+static void
+adjust_chem_polymer_coords(const RDKit::ROMol& monomer_mol,
+                           RDKit::Conformer& conformer,
+                           std::vector<bool>* moved_monomers = nullptr)
 {
-    auto& conformer = monomer_mol.getConformer();
     for (auto monomer : monomer_mol.atoms()) {
         if (!boost::starts_with(get_polymer_id(monomer), "CHEM")) {
             continue;
@@ -2433,6 +2616,11 @@ static void adjust_chem_polymer_coords(RDKit::ROMol& monomer_mol)
             }
         }
         new_pos.x += x_offset;
+        if (moved_monomers != nullptr &&
+            (new_pos - conformer.getAtomPos(monomer->getIdx())).lengthSq() >
+                0) {
+            (*moved_monomers)[monomer->getIdx()] = true;
+        }
         conformer.setAtomPos(monomer->getIdx(), new_pos);
     }
 }
@@ -2492,16 +2680,145 @@ static bool are_double_stranded_nucleic_acid(RDKit::ROMOL_SPTR polymer1,
     return polymer_bonds.size() >= 2;
 }
 
-void lay_out_polymers(
+/**
+ * @return whether the optional cancellation flag of a layout has been set
+ */
+static bool is_cancelled(const std::atomic<bool>* cancelled)
+{
+    return cancelled != nullptr && cancelled->load(std::memory_order_relaxed);
+}
+
+/**
+ * Runs lay_out_polymer on all the given polymers using up to `num_threads`
+ * threads, and works out how many of those layouts are identical to the ones a
+ * sequential layout would produce.
+ *
+ * A polymer's local layout only depends on the other polymers through which of
+ * the monomers it is bonded to have already been placed, which sequentially
+ * are the ones placed by the layouts of earlier polymers. Each polymer is
+ * therefore laid out assuming all those monomers were placed, and the
+ * assumption is checked once all layouts are done.
+ *
+ * @return the number of leading polymers whose layouts are final. Their
+ * monomers are added to `placed_monomers_idcs`. The coordinates of the
+ * remaining polymers are reset so that they can be laid out sequentially.
+ */
+static size_t
+lay_out_polymers_concurrently(const std::vector<RDKit::ROMOL_SPTR>& polymers,
+                              const std::vector<bool>& rotate_polymers,
+                              std::unordered_set<int>& placed_monomers_idcs,
+                              const unsigned int num_threads,
+                              const std::atomic<bool>* cancelled)
+{
+    std::unordered_map<int, size_t> polymer_idx_by_monomer;
+    for (size_t i = 0; i < polymers.size(); ++i) {
+        for (auto monomer : polymers[i]->atoms()) {
+            if (!polymer_idx_by_monomer
+                     .emplace(monomer->getProp<int>(ORIGINAL_INDEX), i)
+                     .second) {
+                // a monomer shared between polymers; there's no telling
+                // which one places it first
+                return 0;
+            }
+        }
+    }
+
+    // the monomers in earlier polymers bonded to each polymer, along with the
+    // index of the polymer they belong to
+    std::vector<std::vector<std::pair<int, size_t>>> assumed_placed(
+        polymers.size());
+    std::vector<std::unordered_set<int>> placed_monomers_per_polymer(
+        polymers.size());
+    std::vector<RDGeom::POINT3D_VECT> initial_positions(polymers.size());
+    for (size_t i = 0; i < polymers.size(); ++i) {
+        for (auto monomer : polymers[i]->atoms()) {
+            std::vector<int> bonded_monomers_indices;
+            monomer->getPropIfPresent<std::vector<int>>(
+                BOND_TO, bonded_monomers_indices);
+            for (auto bonded_idx : bonded_monomers_indices) {
+                auto bonded_polymer = polymer_idx_by_monomer.find(bonded_idx);
+                if (bonded_polymer != polymer_idx_by_monomer.end() &&
+                    bonded_polymer->second < i) {
+                    assumed_placed[i].push_back(
+                        {bonded_idx, bonded_polymer->second});
+                    placed_monomers_per_polymer[i].insert(bonded_idx);
+                }
+            }
+        }
+        initial_positions[i] = polymers[i]->getConformer().getPositions();
+    }
+
+    std::vector<std::exception_ptr> errors(polymers.size());
+    std::atomic<size_t> next_idx = 0;
+    auto lay_out_next_polymers = [&]() {
+        for (auto i = next_idx++; i < polymers.size(); i = next_idx++) {
+            if (is_cancelled(cancelled)) {
+                return;
+            }
+            try {
+                lay_out_polymer(*polymers[i], placed_monomers_per_polymer[i],
+                                rotate_polymers[i]);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+    // this thread lays out polymers too
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < std::min<size_t>(num_threads, polymers.size());
+         ++i) {
+        workers.emplace_back(lay_out_next_polymers);
+    }
+    lay_out_next_polymers();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (is_cancelled(cancelled)) {
+        // some polymers may not have been laid out at all
+        return 0;
+    }
+
+    for (size_t i = 0; i < polymers.size(); ++i) {
+        auto was_placed = [&](const std::pair<int, size_t>& monomer) {
+            auto [monomer_idx, polymer_idx] = monomer;
+            return placed_monomers_per_polymer[polymer_idx].contains(
+                monomer_idx);
+        };
+        if (!std::ranges::all_of(assumed_placed[i], was_placed)) {
+            for (auto j = i; j < polymers.size(); ++j) {
+                polymers[j]->getConformer().getPositions() =
+                    initial_positions[j];
+            }
+            return i;
+        }
+        // only rethrow once we know a sequential layout would have failed
+        // the same way
+        if (errors[i]) {
+            std::rethrow_exception(errors[i]);
+        }
+        for (auto monomer : polymers[i]->atoms()) {
+            auto monomer_idx = monomer->getProp<int>(ORIGINAL_INDEX);
+            if (placed_monomers_per_polymer[i].contains(monomer_idx)) {
+                placed_monomers_idcs.insert(monomer_idx);
+            }
+        }
+    }
+    return polymers.size();
+}
+
+/**
+ * @return the polymer each of the given polymers is positioned relative to
+ * (null for the first one), and whether each of them should be rotated when
+ * laid out
+ */
+static std::pair<std::vector<RDKit::ROMOL_SPTR>, std::vector<bool>>
+get_layout_parents(
     const std::vector<RDKit::ROMOL_SPTR>& polymers,
     const std::map<RDKit::ROMOL_SPTR, RDKit::ROMOL_SPTR>& parent_polymer)
 {
-    std::unordered_set<int> placed_monomers_idcs{};
-    std::vector<RDKit::ROMOL_SPTR> placed_polymers;
-
-    // lay out the polymers in connection order so connected polymers are laid
-    // out next to each other.
-    for (auto polymer : polymers) {
+    std::vector<RDKit::ROMOL_SPTR> parents(polymers.size());
+    std::vector<bool> rotate_polymers(polymers.size(), false);
+    for (size_t i = 0; i < polymers.size(); ++i) {
         // If a polymer has no entry in parent_polymer, it's either the first to
         // be placed or it is not connected to any other polymer in the HELM
         // graph. In the second case, use the last placed polymer as the
@@ -2509,35 +2826,88 @@ void lay_out_polymers(
         // positioned relative to the previous one (typically stacked
         // vertically), instead of all being placed relative to a null parent at
         // the origin, which would make them overlap.
-        RDKit::ROMOL_SPTR parent = nullptr;
-        if (parent_polymer.contains(polymer)) {
-            parent = parent_polymer.at(polymer);
-        } else if (!placed_polymers.empty()) {
-            parent = placed_polymers.back();
+        if (parent_polymer.contains(polymers[i])) {
+            parents[i] = parent_polymer.at(polymers[i]);
+        } else if (i > 0) {
+            parents[i] = polymers[i - 1];
         }
         // For double stranded nucleic acids we want to lay out the first
         // polymer normally and then rotate the other polymer 180° so the
         // strands run anti-parallel to each other
-        bool rotate_polymer = (parent != nullptr) &&
-                              are_double_stranded_nucleic_acid(polymer, parent);
-        lay_out_polymer(*polymer, placed_monomers_idcs, rotate_polymer);
-        if (parent != nullptr) {
-            orient_polymer(*polymer, *parent, rotate_polymer, placed_polymers);
+        rotate_polymers[i] =
+            (parents[i] != nullptr) &&
+            are_double_stranded_nucleic_acid(polymers[i], parents[i]);
+    }
+    return {parents, rotate_polymers};
+}
+
+/**
+ * Lays out the given polymers in connection order, so that connected polymers
+ * are laid out next to each other. Each polymer is first laid out on its own
+ * and then oriented relative to its parent polymer and the polymers already
+ * placed.
+ *
+ * @param num_threads number of threads used to lay out the polymers on their
+ * own. Orienting them is always sequential, and the result doesn't depend on
+ * the number of threads.
+ * @param cancelled if given, checked between polymers; once set, the layout is
+ * abandoned and the polymer coordinates should be discarded
+ */
+void lay_out_polymers(
+    const std::vector<RDKit::ROMOL_SPTR>& polymers,
+    const std::map<RDKit::ROMOL_SPTR, RDKit::ROMOL_SPTR>& parent_polymer,
+    const unsigned int num_threads = 1,
+    const std::atomic<bool>* cancelled = nullptr)
+{
+    auto [parents, rotate_polymers] =
+        get_layout_parents(polymers, parent_polymer);
+
+    std::unordered_set<int> placed_monomers_idcs{};
+    size_t num_laid_out = 0;
+    if (num_threads > 1 && polymers.size() > 1) {
+        num_laid_out =
+            lay_out_polymers_concurrently(polymers, rotate_polymers,
+                                          placed_monomers_idcs, num_threads,
+                                          cancelled);
+    }
+    for (auto i = num_laid_out; i < polymers.size(); ++i) {
+        if (is_cancelled(cancelled)) {
+            return;
+        }
+        lay_out_polymer(*polymers[i], placed_monomers_idcs,
+                        rotate_polymers[i]);
+    }
+
+    PlacedPolymers placed_polymers;
+    for (size_t i = 0; i < polymers.size(); ++i) {
+        if (is_cancelled(cancelled)) {
+            return;
         }
-        placed_polymers.push_back(polymer);
+        if (parents[i] != nullptr) {
+            orient_polymer(*polymers[i], *parents[i], rotate_polymers[i],
+                           placed_polymers);
+        }
+        placed_polymers.add(polymers[i]);
     }
 }
 
 bool has_no_clashes(const RDKit::ROMol& monomer_mol)
 {
-    const auto& conformer = monomer_mol.getConformer();
-    auto positions = conformer.getPositions();
-    for (size_t i = 0; i < positions.size(); i++) {
-        for (size_t j = i + 1; j < positions.size(); j++) {
-            if (positions_clash(positions[i], positions[j])) {
-                return false;
-            }
+    const auto& positions = monomer_mol.getConformer().getPositions();
+    // each monomer is only compared against the ones in nearby grid cells
+    // that were checked before it
+    SpatialGrid grid(MONOMER_CLASH_DISTANCE);
+    const RDGeom::Point3D clash_offset(MONOMER_CLASH_DISTANCE,
+                                       MONOMER_CLASH_DISTANCE, 0);
+    for (unsigned int i = 0; i < positions.size(); i++) {
+        auto clashes = [&](unsigned int j) {
+            return positions_clash(positions[i], positions[j]);
+        };
+        if (grid.any_of(positions[i] - clash_offset,
+                        positions[i] + clash_offset, clashes)) {
+            return false;
         }
+        grid.insert(i, positions[i]);
     }
     return true;
 }
@@ -2611,49 +2981,84 @@ bool bonds_are_too_close(const RDGeom::Point3D& begin1_pos,
                                               end2_pos) < BOND_CLASH_DISTANCE);
 }
 
+/**
+ * @return whether two bonds that don't share a monomer cross or are too close
+ * to each other
+ */
+static bool bonds_clash(const RDKit::Conformer& conformer,
+                        const RDKit::Bond* bond1, const RDKit::Bond* bond2)
+{
+    // skip if the bonds share an atom
+    if (bond1->getBeginAtomIdx() == bond2->getBeginAtomIdx() ||
+        bond1->getBeginAtomIdx() == bond2->getEndAtomIdx() ||
+        bond1->getEndAtomIdx() == bond2->getBeginAtomIdx() ||
+        bond1->getEndAtomIdx() == bond2->getEndAtomIdx()) {
+        return false;
+    }
+    return bonds_are_too_close(conformer.getAtomPos(bond1->getBeginAtomIdx()),
+                               conformer.getAtomPos(bond1->getEndAtomIdx()),
+                               conformer.getAtomPos(bond2->getBeginAtomIdx()),
+                               conformer.getAtomPos(bond2->getEndAtomIdx()));
+}
+
+/**
+ * @return the bounding box of the given bond grown by BOND_CLASH_DISTANCE,
+ * which is the same box bonds_are_too_close() uses to rule out pairs of bonds
+ */
+static std::pair<RDGeom::Point3D, RDGeom::Point3D>
+get_bond_clash_box(const RDKit::Conformer& conformer, const RDKit::Bond* bond)
+{
+    auto begin_pos = conformer.getAtomPos(bond->getBeginAtomIdx());
+    auto end_pos = conformer.getAtomPos(bond->getEndAtomIdx());
+    const RDGeom::Point3D clash_offset(BOND_CLASH_DISTANCE, BOND_CLASH_DISTANCE,
+                                       0);
+    RDGeom::Point3D min_corner(std::min(begin_pos.x, end_pos.x),
+                               std::min(begin_pos.y, end_pos.y), 0);
+    RDGeom::Point3D max_corner(std::max(begin_pos.x, end_pos.x),
+                               std::max(begin_pos.y, end_pos.y), 0);
+    return {min_corner - clash_offset, max_corner + clash_offset};
+}
+
 bool has_no_bond_crossings(const RDKit::ROMol& monomer_mol)
 {
     const auto& conformer = monomer_mol.getConformer();
-    for (size_t i = 0; i < monomer_mol.getNumBonds(); i++) {
+    // Each bond is registered with its clash box, so only bonds sharing a grid
+    // cell need to be compared
+    SpatialGrid grid(MONOMER_BOND_LENGTH);
+    for (unsigned int i = 0; i < monomer_mol.getNumBonds(); i++) {
         auto bond1 = monomer_mol.getBondWithIdx(i);
-        auto begin1_pos = conformer.getAtomPos(bond1->getBeginAtomIdx());
-        auto end1_pos = conformer.getAtomPos(bond1->getEndAtomIdx());
-
-        for (size_t j = i + 1; j < monomer_mol.getNumBonds(); j++) {
-            auto bond2 = monomer_mol.getBondWithIdx(j);
-            // skip if the bonds share an atom
-            if (bond1->getBeginAtomIdx() == bond2->getBeginAtomIdx() ||
-                bond1->getBeginAtomIdx() == bond2->getEndAtomIdx() ||
-                bond1->getEndAtomIdx() == bond2->getBeginAtomIdx() ||
-                bond1->getEndAtomIdx() == bond2->getEndAtomIdx()) {
-                continue;
-            }
-            auto begin2_pos = conformer.getAtomPos(bond2->getBeginAtomIdx());
-            auto end2_pos = conformer.getAtomPos(bond2->getEndAtomIdx());
-            if (bonds_are_too_close(begin1_pos, end1_pos, begin2_pos,
-                                    end2_pos)) {
-                return false;
-            }
+        auto clashes = [&](unsigned int j) {
+            return bonds_clash(conformer, bond1, monomer_mol.getBondWithIdx(j));
+        };
+        auto [min_corner, max_corner] = get_bond_clash_box(conformer, bond1);
+        if (grid.any_of(min_corner, max_corner, clashes)) {
+            return false;
         }
+        grid.insert(i, min_corner, max_corner);
     }
     return true;
 }
 
+static bool is_stretched_bond(const RDKit::Conformer& conformer,
+                              const RDKit::Bond* bond)
+{
+    float flexibility = 1.0;
+    // non-backbone bonds can be more flexible so we allow them to stretch
+    // more without flagging a failure
+    if (!is_backbone_bond(bond)) {
+        flexibility = NON_BACKBONE_BOND_FLEXIBILITY;
+    }
+    auto begin_pos = conformer.getAtomPos(bond->getBeginAtomIdx());
+    auto end_pos = conformer.getAtomPos(bond->getEndAtomIdx());
+    auto bond_length = (end_pos - begin_pos).length();
+    return bond_length > MAX_BOND_STRETCH * MONOMER_BOND_LENGTH * flexibility;
+}
+
 static bool has_no_stretched_bonds(const RDKit::ROMol& monomer_mol)
 {
     const auto& conformer = monomer_mol.getConformer();
     for (auto bond : monomer_mol.bonds()) {
-        float flexibility = 1.0;
-        // non-backbone bonds can be more flexible so we allow them to stretch
-        // more without flagging a failure
-        if (!is_backbone_bond(bond)) {
-            flexibility = NON_BACKBONE_BOND_FLEXIBILITY;
-        }
-        auto begin_pos = conformer.getAtomPos(bond->getBeginAtomIdx());
-        auto end_pos = conformer.getAtomPos(bond->getEndAtomIdx());
-        auto bond_length = (end_pos - begin_pos).length();
-        if (bond_length >
-            MAX_BOND_STRETCH * MONOMER_BOND_LENGTH * flexibility) {
+        if (is_stretched_bond(conformer, bond)) {
             return false;
         }
     }
@@ -3246,7 +3651,15 @@ void resize_monomers(
     mol.getRingInfo()->reset();
 }
 
-unsigned int compute_monomer_mol_coords(RDKit::ROMol& monomer_mol)
+/**
+ * Lays out each polymer in the given monomer mol on its own and then positions
+ * them relative to each other
+ *
+ * @return The id of the conformer added to the molecule with the computed
+ * coordinates
+ */
+static unsigned int lay_out_by_polymers(RDKit::ROMol& monomer_mol,
+                                        const unsigned int num_threads)
 {
     // clear layout related props so we can start a fresh layout
     clear_layout_props(monomer_mol);
@@ -3256,46 +3669,377 @@ unsigned int compute_monomer_mol_coords(RDKit::ROMol& monomer_mol)
     if (is_single_linear_polymer(monomer_mol)) {
         lay_out_snaked_linear_polymer(*polymers[0]);
     } else {
-        lay_out_polymers(polymers, parent_polymer);
+        lay_out_polymers(polymers, parent_polymer, num_threads);
     }
 
     remove_cxsmiles_labels(monomer_mol);
 
     auto conformer_id =
         copy_polymer_coords_to_monomer_mol(monomer_mol, polymers);
-    adjust_chem_polymer_coords(monomer_mol);
+    adjust_chem_polymer_coords(monomer_mol, monomer_mol.getConformer());
 
     // clear layout related props to prevent leaking "internal" props
     clear_layout_props(monomer_mol);
+    return conformer_id;
+}
+
+/**
+ * Lays out a monomer mol by topological units. This considers rings as a single
+ * unit, even if they are made of monomers that belong to different polymers.
+ * Branching chains are also considered separate units.
+ *
+ * @param monomer_mol_copy a copy of the monomer mol to lay out. The unit ids
+ * are stored on its monomers, so the original mol is left untouched.
+ * @param num_threads number of threads used to lay out the individual units
+ * @param cancelled if given, the layout is abandoned once it gets set
+ * @return the laid out units, or an empty vector if their coordinates are not
+ * valid either or if the layout was cancelled
+ */
+static std::vector<RDKit::ROMOL_SPTR>
+lay_out_topological_units(RDKit::ROMol& monomer_mol_copy,
+                          const unsigned int num_threads,
+                          const std::atomic<bool>* cancelled = nullptr)
+{
+    clear_layout_props(monomer_mol_copy);
+    remove_cxsmiles_labels(monomer_mol_copy);
+    monomer_mol_copy.getRingInfo()->reset();
+    auto [units, parent_unit] = break_into_topological_units(monomer_mol_copy);
+    lay_out_polymers(units, parent_unit, num_threads, cancelled);
+    if (is_cancelled(cancelled)) {
+        return {};
+    }
+    monomer_mol_copy.clearConformers();
+    copy_polymer_coords_to_monomer_mol(monomer_mol_copy, units);
+    if (!coordinates_are_valid(monomer_mol_copy)) {
+        return {};
+    }
+    return units;
+}
+
+/**
+ * Replaces the polymer layout of the given monomer mol with the coordinates of
+ * the given topological units if there are any, or warns that the polymer
+ * layout is kept despite being invalid.
+ *
+ * @return The id of the conformer holding the final coordinates
+ */
+static unsigned int
+use_topological_units_layout(RDKit::ROMol& monomer_mol,
+                             const unsigned int conformer_id,
+                             const std::vector<RDKit::ROMOL_SPTR>& units)
+{
+    if (units.empty()) {
+        std::cerr << "Warning: Generated coordinates for monomer mol "
+                     "contain clashes, bond crossings, or stretched bonds."
+                  << std::endl;
+        return conformer_id;
+    }
+    // the new coordinates are valid, copy them back to the original mol.
+    // remove the previous conformer first
+    monomer_mol.removeConformer(conformer_id);
+    return copy_polymer_coords_to_monomer_mol(monomer_mol, units);
+}
 
-    if (!coordinates_are_valid(monomer_mol)) {
+/**
+ * Lays out the given monomer mol, trying the topological units if the polymer
+ * layout isn't valid
+ *
+ * @return The id of the conformer added to the molecule with the computed
+ * coordinates
+ */
+static unsigned int lay_out_monomer_mol(RDKit::ROMol& monomer_mol,
+                                        const unsigned int num_threads)
+{
+    if (num_threads <= 1) {
+        auto conformer_id = lay_out_by_polymers(monomer_mol, num_threads);
+        if (coordinates_are_valid(monomer_mol)) {
+            return conformer_id;
+        }
         // the coordinates are not good, try breaking the molecule into
-        // topological units. This considers rings as a single unit, even if
-        // they are made of monomers that belong to different polymers.
-        // Branching chains are also considered separate units. create a copy of
-        // monomer_mol to avoid modifying the original
+        // topological units instead
         RDKit::ROMol monomer_mol_copy(monomer_mol);
-        monomer_mol_copy.getRingInfo()->reset();
-        auto [units, parent_unit] =
-            break_into_topological_units(monomer_mol_copy);
-        lay_out_polymers(units, parent_unit);
-        monomer_mol_copy.clearConformers();
-        copy_polymer_coords_to_monomer_mol(monomer_mol_copy, units);
-        if (coordinates_are_valid(monomer_mol_copy)) {
-            // the new coordinates are valid, copy them back to the original
-            // mol. remove the previous conformer first
-            monomer_mol.removeConformer(conformer_id);
-            conformer_id =
-                copy_polymer_coords_to_monomer_mol(monomer_mol, units);
+        auto units = lay_out_topological_units(monomer_mol_copy, num_threads);
+        return use_topological_units_layout(monomer_mol, conformer_id, units);
+    }
+
+    // Lay out the topological units in the background while the polymers are
+    // being laid out, and abandon them as soon as the polymer layout turns out
+    // to be valid. The units are still only used when the polymer layout is
+    // invalid, so the result is the same as with a single thread.
+    RDKit::ROMol monomer_mol_copy(monomer_mol);
+    std::atomic<bool> units_layout_cancelled = false;
+    std::vector<RDKit::ROMOL_SPTR> units;
+    std::exception_ptr units_layout_error;
+    std::thread units_layout([&]() {
+        try {
+            units = lay_out_topological_units(monomer_mol_copy, 1,
+                                              &units_layout_cancelled);
+        } catch (...) {
+            units_layout_error = std::current_exception();
+        }
+    });
+
+    unsigned int conformer_id = 0;
+    bool polymer_layout_is_valid = false;
+    try {
+        // the background layout takes up one of the threads
+        conformer_id = lay_out_by_polymers(monomer_mol, num_threads - 1);
+        polymer_layout_is_valid = coordinates_are_valid(monomer_mol);
+    } catch (...) {
+        units_layout_cancelled = true;
+        units_layout.join();
+        throw;
+    }
+    if (polymer_layout_is_valid) {
+        units_layout_cancelled = true;
+    }
+    units_layout.join();
+    if (polymer_layout_is_valid) {
+        return conformer_id;
+    }
+    if (units_layout_error) {
+        std::rethrow_exception(units_layout_error);
+    }
+    return use_topological_units_layout(monomer_mol, conformer_id, units);
+}
+
+unsigned int compute_monomer_mol_coords(RDKit::ROMol& monomer_mol,
+                                        const unsigned int num_threads)
+{
+    auto layout_cache = get_monomer_layout_cache();
+    if (layout_cache == nullptr) {
+        return lay_out_monomer_mol(monomer_mol, num_threads);
+    }
+
+    auto key = get_monomer_layout_key(monomer_mol);
+    if (auto positions = layout_cache->get(key);
+        positions.has_value() &&
+        positions->size() == monomer_mol.getNumAtoms()) {
+        // make the same changes to the mol as the layout would
+        clear_layout_props(monomer_mol);
+        remove_cxsmiles_labels(monomer_mol);
+        auto conformer = new RDKit::Conformer(monomer_mol.getNumAtoms());
+        conformer->getPositions() = std::move(*positions);
+        monomer_mol.addConformer(conformer);
+        return conformer->getId();
+    }
+    auto conformer_id = lay_out_monomer_mol(monomer_mol, num_threads);
+    layout_cache->insert(key,
+                         monomer_mol.getConformer(conformer_id).getPositions());
+    return conformer_id;
+}
+
+/**
+ * Same as coordinates_are_valid, but only checks the given monomers and the
+ * bonds to them against the rest of the mol. Everything else is assumed to be
+ * valid already.
+ */
+static bool
+coordinates_are_valid_around(const RDKit::ROMol& monomer_mol,
+                             const RDKit::Conformer& conformer,
+                             const std::vector<bool>& monomers_to_check)
+{
+    const auto& positions = conformer.getPositions();
+    SpatialGrid monomer_grid(MONOMER_CLASH_DISTANCE);
+    for (unsigned int i = 0; i < positions.size(); ++i) {
+        monomer_grid.insert(i, positions[i]);
+    }
+    const RDGeom::Point3D clash_offset(MONOMER_CLASH_DISTANCE,
+                                       MONOMER_CLASH_DISTANCE, 0);
+    for (unsigned int i = 0; i < positions.size(); ++i) {
+        if (!monomers_to_check[i]) {
+            continue;
+        }
+        auto clashes = [&](unsigned int j) {
+            return j != i && positions_clash(positions[i], positions[j]);
+        };
+        if (monomer_grid.any_of(positions[i] - clash_offset,
+                                positions[i] + clash_offset, clashes)) {
+            return false;
+        }
+    }
+
+    SpatialGrid bond_grid(MONOMER_BOND_LENGTH);
+    for (auto bond : monomer_mol.bonds()) {
+        auto [min_corner, max_corner] = get_bond_clash_box(conformer, bond);
+        bond_grid.insert(bond->getIdx(), min_corner, max_corner);
+    }
+    for (auto bond : monomer_mol.bonds()) {
+        if (!monomers_to_check[bond->getBeginAtomIdx()] &&
+            !monomers_to_check[bond->getEndAtomIdx()]) {
+            continue;
+        }
+        if (is_stretched_bond(conformer, bond)) {
+            return false;
+        }
+        auto clashes = [&](unsigned int j) {
+            return bonds_clash(conformer, bond, monomer_mol.getBondWithIdx(j));
+        };
+        auto [min_corner, max_corner] = get_bond_clash_box(conformer, bond);
+        if (bond_grid.any_of(min_corner, max_corner, clashes)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Lays out again the given polymers that contain any of the changed monomers,
+ * and repositions the polymers that were oriented relative to them. All other
+ * polymers keep their coordinates from `previous_conformer`.
+ *
+ * @param moved_monomers set to whether each monomer in the mol may have been
+ * moved
+ * @return false if every polymer needs to be laid out again, in which case the
+ * polymer coordinates are left untouched
+ */
+static bool lay_out_changed_polymers(
+    const std::vector<RDKit::ROMOL_SPTR>& polymers,
+    const std::map<RDKit::ROMOL_SPTR, RDKit::ROMOL_SPTR>& parent_polymer,
+    const RDKit::Conformer& previous_conformer,
+    const std::unordered_set<unsigned int>& changed_monomers,
+    std::vector<bool>& moved_monomers)
+{
+    auto [parents, rotate_polymers] =
+        get_layout_parents(polymers, parent_polymer);
+    std::unordered_map<const RDKit::ROMol*, size_t> polymer_idcs;
+    for (size_t i = 0; i < polymers.size(); ++i) {
+        polymer_idcs[polymers[i].get()] = i;
+    }
+
+    // polymers are always sorted so that parents come before their children
+    std::vector<bool> needs_layout(polymers.size(), false);
+    std::vector<bool> needs_orienting(polymers.size(), false);
+    for (size_t i = 0; i < polymers.size(); ++i) {
+        for (auto monomer : polymers[i]->atoms()) {
+            if (changed_monomers.contains(
+                    monomer->getProp<unsigned int>(ORIGINAL_INDEX))) {
+                needs_layout[i] = true;
+                break;
+            }
+        }
+        needs_orienting[i] =
+            needs_layout[i] ||
+            (parents[i] != nullptr &&
+             needs_orienting[polymer_idcs.at(parents[i].get())]);
+    }
+    if (std::find(needs_layout.begin(), needs_layout.end(), false) ==
+        needs_layout.end()) {
+        return false;
+    }
+
+    // every polymer that isn't laid out again is considered placed
+    std::unordered_set<int> placed_monomers_idcs;
+    for (size_t i = 0; i < polymers.size(); ++i) {
+        auto& conformer = polymers[i]->getConformer();
+        for (auto monomer : polymers[i]->atoms()) {
+            auto monomer_idx = monomer->getProp<unsigned int>(ORIGINAL_INDEX);
+            moved_monomers[monomer_idx] = needs_orienting[i];
+            if (!needs_layout[i]) {
+                conformer.setAtomPos(
+                    monomer->getIdx(),
+                    previous_conformer.getAtomPos(monomer_idx));
+                placed_monomers_idcs.insert(monomer_idx);
+            }
+        }
+    }
+    for (size_t i = 0; i < polymers.size(); ++i) {
+        if (needs_layout[i]) {
+            lay_out_polymer(*polymers[i], placed_monomers_idcs,
+                            rotate_polymers[i]);
+        }
+    }
+
+    PlacedPolymers placed_polymers;
+    for (size_t i = 0; i < polymers.size(); ++i) {
+        if (!needs_orienting[i]) {
+            placed_polymers.add(polymers[i]);
+        }
+    }
+    for (size_t i = 0; i < polymers.size(); ++i) {
+        if (!needs_orienting[i]) {
+            continue;
+        }
+        if (parents[i] != nullptr) {
+            orient_polymer(*polymers[i], *parents[i], rotate_polymers[i],
+                           placed_polymers);
         } else {
-            std::cerr << "Warning: Generated coordinates for monomer mol "
-                         "contain clashes, bond crossings, or stretched bonds."
-                      << std::endl;
+            // keep the first polymer where it was, using the monomers that
+            // existed before the edit as a reference
+            std::vector<RDGeom::Point3D> new_positions;
+            std::vector<RDGeom::Point3D> previous_positions;
+            auto& conformer = polymers[i]->getConformer();
+            for (auto monomer : polymers[i]->atoms()) {
+                auto monomer_idx =
+                    monomer->getProp<unsigned int>(ORIGINAL_INDEX);
+                if (!changed_monomers.contains(monomer_idx)) {
+                    new_positions.push_back(
+                        conformer.getAtomPos(monomer->getIdx()));
+                    previous_positions.push_back(
+                        previous_conformer.getAtomPos(monomer_idx));
+                }
+            }
+            if (!new_positions.empty()) {
+                auto offset = compute_centroid(previous_positions) -
+                              compute_centroid(new_positions);
+                for (auto& pos : conformer.getPositions()) {
+                    pos += offset;
+                }
+            }
         }
-        clear_layout_props(monomer_mol_copy);
+        placed_polymers.add(polymers[i]);
     }
+    return true;
+}
 
-    return conformer_id;
+void update_monomer_mol_coords(
+    RDKit::ROMol& monomer_mol,
+    const std::vector<unsigned int>& changed_monomers,
+    const std::vector<unsigned int>& changed_bonds, const int conformer_id)
+{
+    auto& conformer = monomer_mol.getConformer(conformer_id);
+    std::unordered_set<unsigned int> changed_monomer_idcs(
+        changed_monomers.begin(), changed_monomers.end());
+    for (auto bond_idx : changed_bonds) {
+        auto bond = monomer_mol.getBondWithIdx(bond_idx);
+        changed_monomer_idcs.insert(bond->getBeginAtomIdx());
+        changed_monomer_idcs.insert(bond->getEndAtomIdx());
+    }
+
+    clear_layout_props(monomer_mol);
+    auto [polymers, parent_polymer] = break_into_polymers(monomer_mol);
+    std::vector<bool> moved_monomers(monomer_mol.getNumAtoms(), false);
+    auto laid_out =
+        lay_out_changed_polymers(polymers, parent_polymer, conformer,
+                                 changed_monomer_idcs, moved_monomers);
+    remove_cxsmiles_labels(monomer_mol);
+
+    if (laid_out) {
+        RDKit::Conformer new_conformer(monomer_mol.getNumAtoms());
+        for (const auto& polymer : polymers) {
+            for (auto monomer : polymer->atoms()) {
+                new_conformer.setAtomPos(
+                    monomer->getProp<unsigned int>(ORIGINAL_INDEX),
+                    polymer->getConformer().getAtomPos(monomer->getIdx()));
+            }
+        }
+        // CHEM monomers are moved to sit between the polymers they connect,
+        // so they need to be checked too
+        adjust_chem_polymer_coords(monomer_mol, new_conformer, &moved_monomers);
+        clear_layout_props(monomer_mol);
+        if (coordinates_are_valid_around(monomer_mol, new_conformer,
+                                         moved_monomers)) {
+            conformer.getPositions() = new_conformer.getPositions();
+            return;
+        }
+    }
+    clear_layout_props(monomer_mol);
+
+    // the edit couldn't be laid out locally, lay out the whole mol again
+    RDKit::ROMol monomer_mol_copy(monomer_mol);
+    monomer_mol_copy.clearConformers();
+    compute_monomer_mol_coords(monomer_mol_copy);
+    conformer.getPositions() = monomer_mol_copy.getConformer().getPositions();
 }
 
 } // namespace rdkit_extensions
@@ -46,11 +46,39 @@ struct CustomBondInfo {
 
 /**
  * @param monomer_mol monomeric molecule
+ * @param num_threads number of threads used to lay out the individual polymers
+ * before they are positioned relative to each other. With more than one
+ * thread, the fallback layout by topological units, which is only used if the
+ * polymer layout has clashes, is also started right away on a separate thread.
+ * The computed coordinates are the same regardless of the number of threads.
  * @return The id of the conformer added to the molecule with the computed
  * coordinates
  */
 unsigned int RDKIT_EXTENSIONS_API
-compute_monomer_mol_coords(RDKit::ROMol& monomer_mol);
+compute_monomer_mol_coords(RDKit::ROMol& monomer_mol,
+                           unsigned int num_threads = 1);
+
+/**
+ * Updates the coordinates of a monomer mol after a local edit, such as adding a
+ * monomer to a chain or connecting two monomers, without laying out the whole
+ * mol again. Only the polymers containing a changed monomer are laid out again,
+ * and only the polymers positioned relative to them are moved; the rest keep
+ * their coordinates. If the result clashes around the moved monomers, or if
+ * every polymer was changed, the whole mol is laid out again instead.
+ *
+ * @param monomer_mol monomeric molecule
+ * @param changed_monomers indices of the monomers that were added or modified.
+ * When monomers are removed, their remaining neighbors should be passed.
+ * @param changed_bonds indices of the bonds that were added or modified
+ * @param conformer_id id of the conformer holding the coordinates from before
+ * the edit, which is updated in place. The positions of changed monomers are
+ * ignored.
+ */
+void RDKIT_EXTENSIONS_API update_monomer_mol_coords(
+    RDKit::ROMol& monomer_mol,
+    const std::vector<unsigned int>& changed_monomers,
+    const std::vector<unsigned int>& changed_bonds = {},
+    int conformer_id = -1);
 
 /**
  * Scores the entire coiling layout based on all custom bonds. The lower the
@@ -66,6 +94,19 @@ double RDKIT_EXTENSIONS_API score_coiling_layout(
     const RDKit::ROMol& polymer, const std::vector<TurnInfo>& turns,
     const std::vector<CustomBondInfo>& custom_bonds);
 
+/**
+ * Computes turn information for coiling chain layout. Every combination of
+ * chain size, first chain size, first turn size and turn size increment is
+ * scored with score_coiling_layout, and the turns of the first layout with the
+ * lowest score are returned.
+ *
+ * @param polymer The polymer molecule to analyze
+ * @return Vector of turn information if coiling layout is feasible, empty
+ *         vector otherwise
+ */
+std::vector<TurnInfo> RDKIT_EXTENSIONS_API
+compute_coiling_turns_for_chain(const RDKit::ROMol& polymer);
+
 /**
  * @return a float number representing the position of the monomer within the
  * coiling layout.
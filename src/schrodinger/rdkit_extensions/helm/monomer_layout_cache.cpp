@@ -0,0 +1,234 @@
+#include "schrodinger/rdkit_extensions/helm/monomer_layout_cache.h"
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <fmt/format.h>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+
+#include <rdkit/GraphMol/ROMol.h>
+
+#include "schrodinger/rdkit_extensions/helm.h"
+
+namespace schrodinger
+{
+namespace rdkit_extensions
+{
+
+namespace
+{
+// labels longer than this are SMILES rather than monomer symbols
+constexpr size_t MAX_SYMBOL_LABEL_LENGTH = 4;
+
+// the cache used by compute_monomer_mol_coords
+std::mutex g_layout_cache_mutex;
+std::shared_ptr<MonomerLayoutCache> g_layout_cache;
+} // namespace
+
+DirectoryMonomerLayoutStore::DirectoryMonomerLayoutStore(
+    const boost::filesystem::path& directory) :
+    m_directory(directory)
+{
+    boost::system::error_code error;
+    boost::filesystem::create_directories(m_directory, error);
+    if (error || !boost::filesystem::is_directory(m_directory)) {
+        throw std::runtime_error(
+            fmt::format("Couldn't create the monomer layout directory {}",
+                        m_directory.string()));
+    }
+}
+
+boost::filesystem::path
+DirectoryMonomerLayoutStore::get_file_path(const std::string& key) const
+{
+    return m_directory /
+           fmt::format("{:016x}.layout", get_monomer_layout_key_hash(key));
+}
+
+std::optional<std::vector<RDGeom::Point3D>>
+DirectoryMonomerLayoutStore::load(const std::string& key)
+{
+    boost::filesystem::ifstream file(get_file_path(key));
+    std::string stored_key;
+    size_t num_positions = 0;
+    if (!std::getline(file, stored_key) || stored_key != key ||
+        !(file >> num_positions)) {
+        // missing file, or another layout with the same hash
+        return std::nullopt;
+    }
+    std::vector<RDGeom::Point3D> positions(num_positions);
+    for (auto& pos : positions) {
+        if (!(file >> pos.x >> pos.y >> pos.z)) {
+            return std::nullopt;
+        }
+    }
+    return positions;
+}
+
+void DirectoryMonomerLayoutStore::save(
+    const std::string& key, const std::vector<RDGeom::Point3D>& positions)
+{
+    // write to a temporary file first so that readers never see a partially
+    // written layout
+    auto file_path = get_file_path(key);
+    auto tmp_path = boost::filesystem::unique_path(
+        file_path.string() + ".%%%%-%%%%-%%%%.tmp");
+    {
+        boost::filesystem::ofstream file(tmp_path);
+        file << key << '\n' << positions.size() << '\n';
+        file << std::setprecision(std::numeric_limits<double>::max_digits10);
+        for (const auto& pos : positions) {
+            file << pos.x << ' ' << pos.y << ' ' << pos.z << '\n';
+        }
+        if (!file.flush()) {
+            file.close();
+            boost::system::error_code error;
+            boost::filesystem::remove(tmp_path, error);
+            return;
+        }
+    }
+    boost::system::error_code error;
+    boost::filesystem::rename(tmp_path, file_path, error);
+    if (error) {
+        boost::filesystem::remove(tmp_path, error);
+    }
+}
+
+MonomerLayoutCache::MonomerLayoutCache(
+    const size_t max_size, std::shared_ptr<MonomerLayoutStore> store) :
+    m_max_size(max_size),
+    m_store(std::move(store))
+{
+}
+
+std::optional<std::vector<RDGeom::Point3D>>
+MonomerLayoutCache::get(const std::string& key)
+{
+    {
+        std::scoped_lock lock(m_mutex);
+        auto entry = m_entries_by_hash.find(get_monomer_layout_key_hash(key));
+        if (entry != m_entries_by_hash.end() && entry->second->key == key) {
+            // mark the layout as the most recently used one
+            m_entries.splice(m_entries.begin(), m_entries, entry->second);
+            return entry->second->positions;
+        }
+    }
+    if (m_store == nullptr) {
+        return std::nullopt;
+    }
+    // don't hold the lock while reading from the store
+    auto positions = m_store->load(key);
+    if (positions.has_value()) {
+        std::scoped_lock lock(m_mutex);
+        insert_in_memory(key, *positions);
+    }
+    return positions;
+}
+
+void MonomerLayoutCache::insert(const std::string& key,
+                                const std::vector<RDGeom::Point3D>& positions)
+{
+    {
+        std::scoped_lock lock(m_mutex);
+        insert_in_memory(key, positions);
+    }
+    if (m_store != nullptr) {
+        m_store->save(key, positions);
+    }
+}
+
+void MonomerLayoutCache::insert_in_memory(
+    const std::string& key, const std::vector<RDGeom::Point3D>& positions)
+{
+    if (m_max_size == 0) {
+        return;
+    }
+    auto hash = get_monomer_layout_key_hash(key);
+    if (auto entry = m_entries_by_hash.find(hash);
+        entry != m_entries_by_hash.end()) {
+        m_entries.erase(entry->second);
+        m_entries_by_hash.erase(entry);
+    } else if (m_entries.size() == m_max_size) {
+        m_entries_by_hash.erase(
+            get_monomer_layout_key_hash(m_entries.back().key));
+        m_entries.pop_back();
+    }
+    m_entries.push_front({key, positions});
+    m_entries_by_hash[hash] = m_entries.begin();
+}
+
+size_t MonomerLayoutCache::size() const
+{
+    std::scoped_lock lock(m_mutex);
+    return m_entries.size();
+}
+
+void MonomerLayoutCache::clear()
+{
+    std::scoped_lock lock(m_mutex);
+    m_entries.clear();
+    m_entries_by_hash.clear();
+}
+
+std::string get_monomer_layout_key(const RDKit::ROMol& monomer_mol)
+{
+    // The layout depends on the order of the monomers and bonds, so they are
+    // described in index order instead of being canonicalized
+    std::string key = fmt::format("{} {}|", monomer_mol.getNumAtoms(),
+                                  monomer_mol.getNumBonds());
+    for (auto monomer : monomer_mol.atoms()) {
+        std::string label;
+        monomer->getPropIfPresent(ATOM_LABEL, label);
+        if (label.size() > MAX_SYMBOL_LABEL_LENGTH) {
+            // SMILES monomers are relabeled when the mol is laid out, so
+            // treat them all alike so that the key doesn't change
+            label.clear();
+        }
+        bool is_branch = false;
+        monomer->getPropIfPresent(BRANCH_MONOMER, is_branch);
+        key += fmt::format(
+            "{},{},{},{},{};", label,
+            monomer->getMonomerInfo() ? get_polymer_id(monomer) : "",
+            monomer->getMonomerInfo() ? get_residue_number(monomer) : 0,
+            is_branch, is_dummy_atom(monomer));
+    }
+    key += '|';
+    for (auto bond : monomer_mol.bonds()) {
+        std::string custom_bond;
+        bond->getPropIfPresent(CUSTOM_BOND, custom_bond);
+        std::string linkage;
+        bond->getPropIfPresent(LINKAGE, linkage);
+        key += fmt::format("{}-{},{},{},{};", bond->getBeginAtomIdx(),
+                           bond->getEndAtomIdx(),
+                           static_cast<int>(bond->getBondType()), custom_bond,
+                           linkage);
+    }
+    return key;
+}
+
+std::uint64_t get_monomer_layout_key_hash(const std::string& key)
+{
+    // 64 bit FNV-1a
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+void set_monomer_layout_cache(std::shared_ptr<MonomerLayoutCache> cache)
+{
+    std::scoped_lock lock(g_layout_cache_mutex);
+    g_layout_cache = std::move(cache);
+}
+
+std::shared_ptr<MonomerLayoutCache> get_monomer_layout_cache()
+{
+    std::scoped_lock lock(g_layout_cache_mutex);
+    return g_layout_cache;
+}
+
+} // namespace rdkit_extensions
+} // namespace schrodinger
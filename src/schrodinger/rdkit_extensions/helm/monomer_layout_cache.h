@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+#include <rdkit/Geometry/point.h>
+
+#include "schrodinger/rdkit_extensions/definitions.h"
+
+namespace RDKit
+{
+class ROMol;
+} // namespace RDKit
+
+namespace schrodinger
+{
+namespace rdkit_extensions
+{
+
+/**
+ * Persistent storage for the layouts held by a MonomerLayoutCache, so that
+ * they survive being evicted from memory and can be shared between processes.
+ * Implementations must be safe to call from several threads at once.
+ */
+class RDKIT_EXTENSIONS_API MonomerLayoutStore
+{
+  public:
+    virtual ~MonomerLayoutStore() = default;
+
+    /**
+     * @param key layout key, as returned by get_monomer_layout_key
+     * @return the coordinates stored for the key, if any
+     */
+    [[nodiscard]] virtual std::optional<std::vector<RDGeom::Point3D>>
+    load(const std::string& key) = 0;
+
+    /**
+     * Store the coordinates for the given key, replacing any previous ones
+     */
+    virtual void save(const std::string& key,
+                      const std::vector<RDGeom::Point3D>& positions) = 0;
+};
+
+/**
+ * Stores each layout in its own file in the given directory. Files are written
+ * atomically, so several processes may share the same directory. Failing to
+ * read or write a file is treated as a cache miss rather than an error.
+ */
+class RDKIT_EXTENSIONS_API DirectoryMonomerLayoutStore
+    : public MonomerLayoutStore
+{
+  public:
+    /**
+     * @param directory where the layouts are stored; created if needed
+     * @throws std::runtime_error if the directory can't be created
+     */
+    explicit DirectoryMonomerLayoutStore(
+        const boost::filesystem::path& directory);
+
+    [[nodiscard]] std::optional<std::vector<RDGeom::Point3D>>
+    load(const std::string& key) override;
+
+    void save(const std::string& key,
+              const std::vector<RDGeom::Point3D>& positions) override;
+
+  private:
+    [[nodiscard]] boost::filesystem::path
+    get_file_path(const std::string& key) const;
+
+    boost::filesystem::path m_directory;
+};
+
+/**
+ * A bounded, thread safe cache of monomer mol layouts that evicts the least
+ * recently used layout once full. Layouts that aren't in memory are looked up
+ * in the optional store, and new layouts are written to it.
+ */
+class RDKIT_EXTENSIONS_API MonomerLayoutCache
+{
+  public:
+    /**
+     * @param max_size maximum number of layouts kept in memory
+     * @param store optional persistent storage for the layouts
+     */
+    explicit MonomerLayoutCache(
+        size_t max_size, std::shared_ptr<MonomerLayoutStore> store = nullptr);
+
+    /**
+     * @param key layout key, as returned by get_monomer_layout_key
+     * @return the coordinates cached for the key, if any
+     */
+    [[nodiscard]] std::optional<std::vector<RDGeom::Point3D>>
+    get(const std::string& key);
+
+    /**
+     * Cache the coordinates for the given key, replacing any previous ones
+     */
+    void insert(const std::string& key,
+                const std::vector<RDGeom::Point3D>& positions);
+
+    /**
+     * @return the number of layouts currently held in memory
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * Drop all layouts held in memory. The store is left untouched.
+     */
+    void clear();
+
+  private:
+    struct Entry {
+        std::string key;
+        std::vector<RDGeom::Point3D> positions;
+    };
+
+    // must be called with m_mutex locked
+    void insert_in_memory(const std::string& key,
+                          const std::vector<RDGeom::Point3D>& positions);
+
+    const size_t m_max_size;
+    std::shared_ptr<MonomerLayoutStore> m_store;
+    mutable std::mutex m_mutex;
+    // most recently used first
+    std::list<Entry> m_entries;
+    // hash of each key -> its entry; a colliding key simply replaces the
+    // entry
+    std::unordered_map<std::uint64_t, std::list<Entry>::iterator>
+        m_entries_by_hash;
+};
+
+/**
+ * @return a string describing everything the layout of the given monomer mol
+ * depends on: the monomers and their polymers, in index order, and the bonds
+ * between them along with their linkages. Mols with the same key get the same
+ * coordinates from compute_monomer_mol_coords.
+ */
+[[nodiscard]] RDKIT_EXTENSIONS_API std::string
+get_monomer_layout_key(const RDKit::ROMol& monomer_mol);
+
+/**
+ * @return a hash of the given layout key that is stable across processes and
+ * platforms, suitable for naming files
+ */
+[[nodiscard]] RDKIT_EXTENSIONS_API std::uint64_t
+get_monomer_layout_key_hash(const std::string& key);
+
+/**
+ * Set the cache used by compute_monomer_mol_coords to reuse the layouts of mols
+ * that were laid out before. No cache is used by default.
+ *
+ * @param cache the cache to use, or nullptr to stop caching layouts
+ */
+RDKIT_EXTENSIONS_API void
+set_monomer_layout_cache(std::shared_ptr<MonomerLayoutCache> cache);
+
+/**
+ * @return the cache used by compute_monomer_mol_coords, if any
+ */
+[[nodiscard]] RDKIT_EXTENSIONS_API std::shared_ptr<MonomerLayoutCache>
+get_monomer_layout_cache();
+
+} // namespace rdkit_extensions
+} // namespace schrodinger
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <rdkit/Geometry/point.h>
+
+namespace schrodinger::rdkit_extensions
+{
+
+/**
+ * A uniform 2D grid used to find monomers or bonds that are close enough to
+ * clash without testing every pair. Items are registered by id with their
+ * (x, y) bounding box, and are stored in every cell the box overlaps, so any
+ * two items whose boxes overlap are guaranteed to share at least one cell.
+ *
+ * The grid only keeps ids, so callers are responsible for the exact geometry
+ * test. Items may be added or removed at any time, which allows the grid to be
+ * updated incrementally as monomers get placed or items move.
+ */
+class SpatialGrid
+{
+  public:
+    /**
+     * @param cell_size side of each grid cell. Best chosen to be around the
+     * size of the boxes that will be registered or queried.
+     */
+    explicit SpatialGrid(double cell_size) : m_cell_size(cell_size)
+    {
+    }
+
+    /**
+     * Register the item with the given id as covering the given box
+     */
+    void insert(unsigned int id, const RDGeom::Point3D& min_corner,
+                const RDGeom::Point3D& max_corner)
+    {
+        auto [min_col, min_row] = get_cell(min_corner);
+        auto [max_col, max_row] = get_cell(max_corner);
+        if (!is_reasonably_sized(min_col, min_row, max_col, max_row)) {
+            // don't flood the grid with very long bonds or infinite
+            // coordinates; these are returned by every query instead
+            m_oversized_ids.push_back(id);
+            return;
+        }
+        for (auto col = min_col; col <= max_col; ++col) {
+            for (auto row = min_row; row <= max_row; ++row) {
+                m_cells[get_key(col, row)].push_back(id);
+            }
+        }
+    }
+
+    /**
+     * Register the item with the given id as a single point
+     */
+    void insert(unsigned int id, const RDGeom::Point3D& pos)
+    {
+        insert(id, pos, pos);
+    }
+
+    /**
+     * Unregister the item with the given id, which must have been registered
+     * with exactly the given box
+     */
+    void remove(unsigned int id, const RDGeom::Point3D& min_corner,
+                const RDGeom::Point3D& max_corner)
+    {
+        auto remove_from = [id](std::vector<unsigned int>& ids) {
+            ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+        };
+        auto [min_col, min_row] = get_cell(min_corner);
+        auto [max_col, max_row] = get_cell(max_corner);
+        if (!is_reasonably_sized(min_col, min_row, max_col, max_row)) {
+            remove_from(m_oversized_ids);
+            return;
+        }
+        for (auto col = min_col; col <= max_col; ++col) {
+            for (auto row = min_row; row <= max_row; ++row) {
+                auto cell = m_cells.find(get_key(col, row));
+                if (cell == m_cells.end()) {
+                    continue;
+                }
+                remove_from(cell->second);
+                if (cell->second.empty()) {
+                    m_cells.erase(cell);
+                }
+            }
+        }
+    }
+
+    /**
+     * Call `predicate` with the id of every item whose cells overlap the given
+     * box, until it returns true. Ids may be visited more than once.
+     *
+     * @return whether `predicate` returned true for any item
+     */
+    template <typename Predicate>
+    bool any_of(const RDGeom::Point3D& min_corner,
+                const RDGeom::Point3D& max_corner, Predicate&& predicate) const
+    {
+        for (auto id : m_oversized_ids) {
+            if (predicate(id)) {
+                return true;
+            }
+        }
+        auto [min_col, min_row] = get_cell(min_corner);
+        auto [max_col, max_row] = get_cell(max_corner);
+        if (!is_reasonably_sized(min_col, min_row, max_col, max_row)) {
+            // visit every registered item instead of every cell in the box
+            for (const auto& [key, ids] : m_cells) {
+                for (auto id : ids) {
+                    if (predicate(id)) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+        for (auto col = min_col; col <= max_col; ++col) {
+            for (auto row = min_row; row <= max_row; ++row) {
+                auto cell = m_cells.find(get_key(col, row));
+                if (cell == m_cells.end()) {
+                    continue;
+                }
+                for (auto id : cell->second) {
+                    if (predicate(id)) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+  private:
+    // Items covering more cells than this on either axis are not stored in
+    // the cells themselves
+    static constexpr std::int64_t MAX_CELLS_PER_AXIS = 64;
+
+    std::pair<std::int64_t, std::int64_t>
+    get_cell(const RDGeom::Point3D& pos) const
+    {
+        return {to_cell_index(pos.x), to_cell_index(pos.y)};
+    }
+
+    std::int64_t to_cell_index(double coord) const
+    {
+        // clamp so that huge or non-finite coordinates can't overflow
+        constexpr double LIMIT = 1e15;
+        auto index = std::floor(coord / m_cell_size);
+        if (!(index > -LIMIT)) {
+            return static_cast<std::int64_t>(-LIMIT);
+        }
+        return static_cast<std::int64_t>(std::min(index, LIMIT));
+    }
+
+    static bool is_reasonably_sized(std::int64_t min_col, std::int64_t min_row,
+                                    std::int64_t max_col, std::int64_t max_row)
+    {
+        return max_col - min_col < MAX_CELLS_PER_AXIS &&
+               max_row - min_row < MAX_CELLS_PER_AXIS;
+    }
+
+    static std::uint64_t get_key(std::int64_t col, std::int64_t row)
+    {
+        // fold both indices into a single key; collisions only cost extra
+        // candidates, never missed ones
+        return (static_cast<std::uint64_t>(col) << 32) ^
+               static_cast<std::uint64_t>(row);
+    }
+
+    double m_cell_size;
+    std::unordered_map<std::uint64_t, std::vector<unsigned int>> m_cells;
+    std::vector<unsigned int> m_oversized_ids;
+};
+
+} // namespace schrodinger::rdkit_extensions
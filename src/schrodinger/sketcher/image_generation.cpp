@@ -4,9 +4,18 @@
 
 #include "schrodinger/sketcher/image_generation.h"
 
+#include <algorithm>
+#include <barrier>
+#include <exception>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <functional>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <variant>
+#include <vector>
 
 #include <QBuffer>
 #include <QByteArray>
@@ -16,21 +25,34 @@
 #include <QList>
 #include <QPainter>
 #include <QPixmap>
+#include <QStyleOptionGraphicsItem>
 #include <QSvgGenerator>
+#include <QTransform>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/assign.hpp>
 #include <boost/bimap.hpp>
+#include <rdkit/GraphMol/RWMol.h>
 #include <unordered_map>
 
+#include "schrodinger/rdkit_extensions/helm.h"
 #include "schrodinger/sketcher/font_loader.h"
 #include "schrodinger/sketcher/model/sketcher_model.h"
-#include "schrodinger/sketcher/molviewer/scene.h"
 #include "schrodinger/sketcher/molviewer/constants.h"
+#include "schrodinger/sketcher/molviewer/fonts.h"
+#include "schrodinger/sketcher/molviewer/scene.h"
+#include "schrodinger/sketcher/molviewer/scene_utils.h"
+#include "schrodinger/sketcher/rdkit/mol_update.h"
+#include "schrodinger/sketcher/rdkit/rgroup.h"
 
 /// a function that returns a paint device at the specified size
 using PaintDeviceFunction =
     std::function<std::shared_ptr<QPaintDevice>(const QSize&)>;
 
+/// a function that renders an image to a paint device that it constructs
+/// using the given PaintDeviceFunction
+using PaintFunction =
+    std::function<std::shared_ptr<QPaintDevice>(const PaintDeviceFunction&)>;
+
 template <> struct std::hash<QColor> {
     std::size_t operator()(const QColor& c) const noexcept
     {
@@ -79,11 +101,10 @@ const ImageFormatBimapType IMAGE_FORMAT_EXT_BIMAP =
 /**
  * @internal
  * Helper function to inject line colors data from the given RenderOptions into
- * the given MolModel
+ * the given molecule
  */
-void setLineColors(MolModel& model, const RenderOptions& opts)
+void setLineColors(const RDKit::ROMol* mol, const RenderOptions& opts)
 {
-    auto mol = model.getMol();
     // clear all line colors
     for (auto atom : mol->atoms()) {
         atom->clearProp(USER_COLOR);
@@ -130,11 +151,10 @@ void setHaloHighlightings(MolModel& model, const RenderOptions& opts)
 /**
  * @internal
  * Helper function to inject atom labels data from the given RenderOptions into
- * the given MolModel
+ * the given molecule
  */
-void setAtomLabels(MolModel& model, const RenderOptions& opts)
+void setAtomLabels(const RDKit::ROMol* mol, const RenderOptions& opts)
 {
-    auto mol = model.getMol();
     for (auto [index, text] : asKeyValue(opts.rdatom_index_to_label)) {
         auto atom = mol->getAtomWithIdx(index);
         atom->setProp(RDKit::common_properties::_displayLabel, text);
@@ -219,13 +239,15 @@ void add_to_mol_model(MolModel& mol_model, const std::string& text)
     add_text_to_mol_model(mol_model, text);
 }
 
-void paint_scene_to_given_paint_device(QPaintDevice* device,
-                                       const QGraphicsScene& scene,
-                                       const QRectF& scene_rect,
-                                       const RenderOptions& opts)
+/**
+ * Set up the given painter and paint the background
+ *
+ * @return the rect of the painter's viewport that scene_rect should be
+ * rendered into, which keeps the aspect ratio of scene_rect
+ */
+QRectF prepare_painter(QPainter& painter, const QRectF& scene_rect,
+                       const RenderOptions& opts)
 {
-
-    QPainter painter(device);
     auto target_rect = painter.viewport();
     painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing);
     painter.fillRect(target_rect, opts.background_color);
@@ -241,6 +263,16 @@ void paint_scene_to_given_paint_device(QPaintDevice* device,
     QRectF centered_rect(0, 0, scene_rect.width() * scale,
                          scene_rect.height() * scale);
     centered_rect.moveCenter(target_rect.center());
+    return centered_rect;
+}
+
+void paint_scene_to_given_paint_device(QPaintDevice* device,
+                                       const QGraphicsScene& scene,
+                                       const QRectF& scene_rect,
+                                       const RenderOptions& opts)
+{
+    QPainter painter(device);
+    auto centered_rect = prepare_painter(painter, scene_rect, opts);
 
     // QGraphicsScene::render is non-const, but we have to jump through const
     // hoops to consistently pass a QGraphicsScene through get_image_bytes and
@@ -253,14 +285,189 @@ void paint_scene_to_given_paint_device(QPaintDevice* device,
                                                 scene_rect);
 }
 
+/**
+ * Paint the given graphics items, which don't need to belong to a scene, in
+ * the same way that QGraphicsScene::render would paint them if they did
+ */
+void paint_items_to_given_paint_device(QPaintDevice* device,
+                                       std::vector<QGraphicsItem*> items,
+                                       const QRectF& scene_rect,
+                                       const RenderOptions& opts)
+{
+    QPainter painter(device);
+    auto centered_rect = prepare_painter(painter, scene_rect, opts);
+    painter.setClipRect(centered_rect, Qt::IntersectClip);
+    QTransform transform;
+    transform.translate(centered_rect.left(), centered_rect.top());
+    transform.scale(centered_rect.width() / scene_rect.width(),
+                    centered_rect.height() / scene_rect.height());
+    transform.translate(-scene_rect.left(), -scene_rect.top());
+    painter.setWorldTransform(transform, true);
+
+    // items with the same z value are painted in the order they were created
+    std::stable_sort(items.begin(), items.end(),
+                     [](auto* item1, auto* item2) {
+                         return item1->zValue() < item2->zValue();
+                     });
+    for (auto* item : items) {
+        if (!item->isVisible()) {
+            continue;
+        }
+        painter.save();
+        painter.setWorldTransform(item->sceneTransform(), true);
+        QStyleOptionGraphicsItem option;
+        option.exposedRect = item->boundingRect();
+        item->paint(&painter, &option);
+        painter.restore();
+    }
+}
+
+/**
+ * @return whether the given molecule can be painted using
+ * paint_mol_without_scene.  Monomeric molecules, halo highlighting and the
+ * simplified stereo annotation all require a Scene.
+ */
+bool can_paint_without_scene(const RDKit::ROMol& mol, const RenderOptions& opts)
+{
+    return mol.getNumAtoms() > 0 && !rdkit_extensions::isMonomeric(mol) &&
+           opts.rdatom_index_to_halo_color.isEmpty() &&
+           opts.rdbond_index_to_halo_color.isEmpty() &&
+           !opts.show_simplified_stereo_annotation;
+}
+
+/**
+ * @return the given rect with the padding that's added around saved images
+ */
+QRectF get_padded_rect(const QRectF& rect)
+{
+    return rect.adjusted(-SAVED_PICTURE_PADDING, -SAVED_PICTURE_PADDING,
+                         SAVED_PICTURE_PADDING, SAVED_PICTURE_PADDING);
+}
+
+/**
+ * The display settings and fonts used to create SceneFreeMolItems.  Neither is
+ * thread safe, so each thread that renders molecules needs its own instance,
+ * which must outlive any items created with it.
+ */
+struct SceneFreeRenderSettings {
+    explicit SceneFreeRenderSettings(const RenderOptions& opts)
+    {
+        // the SketcherModel is only used for its display settings, so that
+        // they match the ones used by the Scene
+        sketcher_model.loadRenderOptions(opts);
+        fonts.setSize(sketcher_model.getFontSize());
+    }
+
+    SketcherModel sketcher_model;
+    Fonts fonts;
+};
+
+/**
+ * Graphics items for a molecule, created once, directly from the molecule,
+ * without setting up a MolModel, undo stack or Scene.  The molecule is
+ * prepared the same way that MolModel::addMol prepares it.  The items don't
+ * belong to a scene, so they're deleted along with this object.
+ */
+class SceneFreeMolItems
+{
+  public:
+    /**
+     * @pre can_paint_without_scene(input, opts)
+     */
+    SceneFreeMolItems(const RDKit::ROMol& input, const RenderOptions& opts,
+                      const SceneFreeRenderSettings& settings) :
+        m_mol(input)
+    {
+        prepare_mol(m_mol);
+        auto atoms = m_mol.atoms();
+        if (std::any_of(atoms.begin(), atoms.end(), [](auto* atom) {
+                return is_attachment_point(atom);
+            })) {
+            renumber_attachment_points(&m_mol);
+        }
+        update_molecule_on_change(m_mol);
+        assign_deferred_CIP_labels(m_mol);
+        setLineColors(&m_mol, opts);
+        setAtomLabels(&m_mol, opts);
+
+        const auto& sketcher_model = settings.sketcher_model;
+        m_items = std::get<0>(create_graphics_items_for_mol(
+            &m_mol, settings.fonts,
+            *sketcher_model.getAtomDisplaySettingsPtr(),
+            *sketcher_model.getBondDisplaySettingsPtr(),
+            sketcher_model.hasDarkColorScheme()));
+        QRectF items_rect;
+        for (auto* item : m_items) {
+            items_rect |= item->sceneBoundingRect();
+        }
+        m_rect = get_padded_rect(items_rect);
+    }
+
+    ~SceneFreeMolItems()
+    {
+        // bond items refer to their atom items, so delete the items in the
+        // reverse order that they were created in
+        std::for_each(m_items.rbegin(), m_items.rend(),
+                      [](auto* item) { delete item; });
+    }
+
+    SceneFreeMolItems(const SceneFreeMolItems&) = delete;
+    SceneFreeMolItems& operator=(const SceneFreeMolItems&) = delete;
+
+    /**
+     * @return the rect to render, including padding
+     */
+    QRectF getRect() const
+    {
+        return m_rect;
+    }
+
+    /**
+     * Construct a paint device and render the items to it
+     */
+    std::shared_ptr<QPaintDevice>
+    paint(const RenderOptions& opts,
+          const PaintDeviceFunction& instantiate_paint_device_to_size) const
+    {
+        auto image_size = get_image_size(opts, m_rect);
+        auto paint_device = instantiate_paint_device_to_size(image_size);
+        paint_items_to_given_paint_device(paint_device.get(), m_items, m_rect,
+                                          opts);
+        return paint_device;
+    }
+
+  private:
+    RDKit::RWMol m_mol;
+    std::vector<QGraphicsItem*> m_items;
+    QRectF m_rect;
+};
+
+/**
+ * Construct a paint device and render the given molecule to it without
+ * setting up a MolModel, undo stack or Scene
+ *
+ * @pre can_paint_without_scene(input, opts)
+ */
+std::shared_ptr<QPaintDevice> paint_mol_without_scene(
+    const RDKit::ROMol& input, const RenderOptions& opts,
+    const PaintDeviceFunction& instantiate_paint_device_to_size)
+{
+    load_font_resources();
+    SceneFreeRenderSettings settings(opts);
+    SceneFreeMolItems items(input, opts, settings);
+    return items.paint(opts, instantiate_paint_device_to_size);
+}
+
 template <typename T>
 void init_molviewer_image(MolModel& mol_model, SketcherModel& sketcher_model,
                           const T& input, const RenderOptions& opts)
 {
     add_to_mol_model(mol_model, input);
-    setLineColors(mol_model, opts);
+    // the image is painted right away, so don't wait for the model to be idle
+    mol_model.assignDeferredCIPLabels();
+    setLineColors(mol_model.getMol(), opts);
     setHaloHighlightings(mol_model, opts);
-    setAtomLabels(mol_model, opts);
+    setAtomLabels(mol_model.getMol(), opts);
     sketcher_model.loadRenderOptions(opts);
 }
 
@@ -274,6 +481,49 @@ Scene get_scene(MolModel* mol_model, SketcherModel* sketcher_model,
     return Scene(mol_model, sketcher_model, parent);
 }
 
+/**
+ * A MolModel and Scene set up to render a single input
+ */
+class ImageScene
+{
+  public:
+    template <typename T>
+    ImageScene(const T& input, const RenderOptions& opts) :
+        m_mol_model(&m_undo_stack),
+        m_scene(get_scene(&m_mol_model, &m_sketcher_model))
+    {
+        init_molviewer_image(m_mol_model, m_sketcher_model, input, opts);
+    }
+
+    const Scene& getScene() const
+    {
+        return m_scene;
+    }
+
+  private:
+    QUndoStack m_undo_stack;
+    MolModel m_mol_model;
+    SketcherModel m_sketcher_model;
+    Scene m_scene;
+};
+
+template <typename T> std::shared_ptr<QPaintDevice>
+paint_scene(const T& input, const RenderOptions& opts,
+            const PaintDeviceFunction& instantiate_paint_device_to_size);
+
+/**
+ * Construct a paint device and render the given input to it using a MolModel
+ * and Scene
+ */
+template <typename T> std::shared_ptr<QPaintDevice> paint_scene_using_mol_model(
+    const T& input, const RenderOptions& opts,
+    const PaintDeviceFunction& instantiate_paint_device_to_size)
+{
+    ImageScene image_scene(input, opts);
+    return paint_scene(image_scene.getScene(), opts,
+                       instantiate_paint_device_to_size);
+}
+
 /**
  * Construct a paint device and render the given input to it
  *
@@ -289,13 +539,22 @@ template <typename T> std::shared_ptr<QPaintDevice>
 paint_scene(const T& input, const RenderOptions& opts,
             const PaintDeviceFunction& instantiate_paint_device_to_size)
 {
-    QUndoStack undo_stack;
-    MolModel mol_model(&undo_stack);
-    SketcherModel sketcher_model;
-    auto scene = get_scene(&mol_model, &sketcher_model);
-    init_molviewer_image(mol_model, sketcher_model, input, opts);
+    return paint_scene_using_mol_model(input, opts,
+                                       instantiate_paint_device_to_size);
+}
 
-    return paint_scene(scene, opts, instantiate_paint_device_to_size);
+// Paint molecules without a Scene whenever possible, since setting up the
+// MolModel and Scene is much more expensive than the painting itself
+template <> std::shared_ptr<QPaintDevice>
+paint_scene(const RDKit::ROMol& input, const RenderOptions& opts,
+            const PaintDeviceFunction& instantiate_paint_device_to_size)
+{
+    if (can_paint_without_scene(input, opts)) {
+        return paint_mol_without_scene(input, opts,
+                                       instantiate_paint_device_to_size);
+    }
+    return paint_scene_using_mol_model(input, opts,
+                                       instantiate_paint_device_to_size);
 }
 
 // Save the scene directly as it is; used to save an image from SketcherWidget
@@ -303,9 +562,7 @@ template <> std::shared_ptr<QPaintDevice>
 paint_scene(const Scene& input, const RenderOptions& opts,
             const PaintDeviceFunction& instantiate_paint_device_to_size)
 {
-    auto scene_rect = input.getSceneItemsBoundingRect();
-    scene_rect.adjust(-SAVED_PICTURE_PADDING, -SAVED_PICTURE_PADDING,
-                      SAVED_PICTURE_PADDING, SAVED_PICTURE_PADDING);
+    auto scene_rect = get_padded_rect(input.getSceneItemsBoundingRect());
     auto image_size = get_image_size(opts, scene_rect);
     auto paint_device = instantiate_paint_device_to_size(image_size);
     paint_scene_to_given_paint_device(paint_device.get(), input, scene_rect,
@@ -421,20 +678,28 @@ void post_process_svg(QByteArray& svg_data, const RenderOptions& opts)
     svg_data = svg_string.toUtf8();
 }
 
-template <typename T> QByteArray
-get_image_bytes(const T& input, ImageFormat format, const RenderOptions& opts)
+/**
+ * Render an image and return its data
+ *
+ * @param paint A function that renders the image to a paint device that it
+ * constructs using the given PaintDeviceFunction
+ * @param format The format of the image
+ * @param opts The settings used for rendering
+ */
+QByteArray get_image_bytes_using(const PaintFunction& paint, ImageFormat format,
+                                 const RenderOptions& opts)
 {
     QBuffer buffer;
 
     if (format == ImageFormat::PNG) {
-        auto image = get_qimage(input, opts);
+        auto paint_device = paint(instantiate_qimage_to_size);
+        auto image = dynamic_cast<QImage*>(paint_device.get());
         buffer.open(QIODevice::WriteOnly);
-        image.save(&buffer, "PNG");
+        image->save(&buffer, "PNG");
         buffer.close();
 
     } else if (format == ImageFormat::SVG) {
-        auto paint_device =
-            paint_scene<T>(input, opts, instantiate_qsvggenerator_to_size);
+        auto paint_device = paint(instantiate_qsvggenerator_to_size);
         auto svg_gen = dynamic_cast<QSvgGenerator*>(paint_device.get());
         // instantiate_qsvggenerator_to_size constructed a new QBuffer on the
         // heap during the paint_scene call.  We assign that QBuffer to a smart
@@ -453,6 +718,226 @@ get_image_bytes(const T& input, ImageFormat format, const RenderOptions& opts)
     return buffer.data();
 }
 
+template <typename T> QByteArray
+get_image_bytes(const T& input, ImageFormat format, const RenderOptions& opts)
+{
+    auto paint = [&input, &opts](const auto& instantiate_paint_device_to_size) {
+        return paint_scene<T>(input, opts, instantiate_paint_device_to_size);
+    };
+    return get_image_bytes_using(paint, format, opts);
+}
+
+/**
+ * @return graphics items for the given molecule, or nullptr if it can only be
+ * rendered using a Scene
+ */
+std::unique_ptr<SceneFreeMolItems>
+create_scene_free_items(const RDKit::ROMol& mol, const RenderOptions& opts,
+                        const SceneFreeRenderSettings& settings)
+{
+    if (!can_paint_without_scene(mol, opts)) {
+        return nullptr;
+    }
+    return std::make_unique<SceneFreeMolItems>(mol, opts, settings);
+}
+
+std::unique_ptr<SceneFreeMolItems>
+create_scene_free_items(const std::string& text, const RenderOptions& opts,
+                        const SceneFreeRenderSettings& settings)
+{
+    auto mol_or_reaction = convert_text_to_mol_or_reaction(
+        text, rdkit_extensions::Format::AUTO_DETECT);
+    auto mol = std::get_if<boost::shared_ptr<RDKit::RWMol>>(&mol_or_reaction);
+    // reactions require a Scene, as does the size limit that MolModel enforces
+    // for text input
+    if (mol == nullptr || (*mol)->getNumAtoms() > MAX_NUM_ATOMS_FOR_IMPORT) {
+        return nullptr;
+    }
+    return create_scene_free_items(**mol, opts, settings);
+}
+
+/**
+ * Render all of the given inputs using num_threads threads, including this
+ * one.  Each thread renders its share of the molecules without a Scene, using
+ * its own display settings and fonts.  Inputs that require a Scene are
+ * rendered on this thread once the others are done with them.
+ *
+ * If use_common_scale is true, each thread keeps the graphics items that it
+ * created until every input has been measured, so that the common scale is
+ * found without laying out any molecule twice.
+ */
+template <typename T> QList<QByteArray>
+get_batch_image_bytes(const std::vector<const T*>& inputs, ImageFormat format,
+                      const RenderOptions& opts, const bool use_common_scale,
+                      unsigned int num_threads)
+{
+    const auto num_inputs = inputs.size();
+    if (num_inputs == 0) {
+        return {};
+    }
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    num_threads =
+        static_cast<unsigned int>(std::min<size_t>(num_threads, num_inputs));
+    // this must happen before any other thread uses the fonts
+    load_font_resources();
+
+    std::vector<std::unique_ptr<SceneFreeMolItems>> mol_items(num_inputs);
+    std::vector<std::unique_ptr<ImageScene>> image_scenes(num_inputs);
+    // a vector<bool> can't safely be written to from several threads
+    std::vector<char> needs_scene(num_inputs, false);
+    std::vector<QByteArray> results(num_inputs);
+    std::vector<std::exception_ptr> errors(num_inputs);
+    // the options to paint with once the common scale, if any, is known
+    auto paint_opts = opts;
+    std::barrier sync_point(static_cast<std::ptrdiff_t>(num_threads));
+
+    auto paint_mol_items = [&](size_t i) {
+        try {
+            auto paint = [&](const auto& instantiate_paint_device_to_size) {
+                return mol_items[i]->paint(paint_opts,
+                                           instantiate_paint_device_to_size);
+            };
+            results[i] = get_image_bytes_using(paint, format, paint_opts);
+        } catch (...) {
+            errors[i] = std::current_exception();
+        }
+        // the items must be deleted on the thread that owns their fonts
+        mol_items[i].reset();
+    };
+
+    auto set_common_scale = [&]() {
+        for (size_t i = 0; i < num_inputs; ++i) {
+            if (!needs_scene[i]) {
+                continue;
+            }
+            try {
+                image_scenes[i] =
+                    std::make_unique<ImageScene>(*inputs[i], opts);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+        auto common_scale = std::numeric_limits<qreal>::max();
+        for (size_t i = 0; i < num_inputs; ++i) {
+            QRectF rect;
+            if (mol_items[i] != nullptr) {
+                rect = mol_items[i]->getRect();
+            } else if (image_scenes[i] != nullptr) {
+                rect = get_padded_rect(
+                    image_scenes[i]->getScene().getSceneItemsBoundingRect());
+            } else {
+                continue;
+            }
+            common_scale =
+                std::min(common_scale, get_scale(rect, opts.width_height));
+        }
+        if (common_scale < std::numeric_limits<qreal>::max()) {
+            paint_opts.scale = common_scale;
+        }
+    };
+
+    // errors that aren't specific to a single input, e.g. from setting up a
+    // thread's fonts.  Exceptions must not escape a worker thread, and every
+    // thread must still arrive at the barrier, so they're rethrown on this
+    // thread once the workers have been joined.
+    std::vector<std::exception_ptr> thread_errors(num_threads);
+
+    auto render_share = [&](size_t thread_idx) {
+        std::optional<SceneFreeRenderSettings> settings;
+        try {
+            settings.emplace(opts);
+            for (auto i = thread_idx; i < num_inputs; i += num_threads) {
+                try {
+                    mol_items[i] =
+                        create_scene_free_items(*inputs[i], opts, *settings);
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                    continue;
+                }
+                if (mol_items[i] == nullptr) {
+                    needs_scene[i] = true;
+                } else if (!use_common_scale) {
+                    paint_mol_items(i);
+                }
+            }
+        } catch (...) {
+            thread_errors[thread_idx] = std::current_exception();
+        }
+        if (use_common_scale) {
+            // wait for every molecule to be measured, and for this thread to
+            // measure everything that requires a Scene
+            sync_point.arrive_and_wait();
+            if (thread_idx == 0) {
+                try {
+                    set_common_scale();
+                } catch (...) {
+                    thread_errors[thread_idx] = std::current_exception();
+                }
+            }
+            sync_point.arrive_and_wait();
+            for (auto i = thread_idx; i < num_inputs; i += num_threads) {
+                if (mol_items[i] != nullptr) {
+                    paint_mol_items(i);
+                }
+            }
+        }
+        // the items must be deleted on the thread that owns their fonts, even
+        // if they weren't painted
+        for (auto i = thread_idx; i < num_inputs; i += num_threads) {
+            mol_items[i].reset();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    try {
+        for (size_t i = 1; i < num_threads; ++i) {
+            workers.emplace_back(render_share, i);
+        }
+    } catch (...) {
+        // the threads that weren't started will never arrive at the barrier,
+        // so drop them from it to let the others finish.  Their inputs aren't
+        // rendered, since this error is rethrown anyway.
+        thread_errors[workers.size() + 1] = std::current_exception();
+        for (auto i = workers.size() + 1; i < num_threads; ++i) {
+            sync_point.arrive_and_drop();
+        }
+    }
+    render_share(0);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (auto& error : thread_errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    for (size_t i = 0; i < num_inputs; ++i) {
+        if (!needs_scene[i] || errors[i]) {
+            continue;
+        }
+        try {
+            if (image_scenes[i] == nullptr) {
+                results[i] = get_image_bytes(*inputs[i], format, paint_opts);
+            } else {
+                results[i] = get_image_bytes(image_scenes[i]->getScene(),
+                                             format, paint_opts);
+                image_scenes[i].reset();
+            }
+        } catch (...) {
+            errors[i] = std::current_exception();
+        }
+    }
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    return QList<QByteArray>(results.begin(), results.end());
+}
+
 template <typename T> void save_image_file(const T& input,
                                            const std::string& filename,
                                            const RenderOptions& opts)
@@ -560,6 +1045,32 @@ void save_image_file(const std::string& text, const std::string& filename,
     save_image_file<std::string>(text, filename, opts);
 }
 
+QList<QByteArray> get_batch_image_bytes(const QList<RDKit::ROMol*>& mols,
+                                        ImageFormat format,
+                                        const RenderOptions& opts,
+                                        const bool use_common_scale,
+                                        const unsigned int num_threads)
+{
+    std::vector<const RDKit::ROMol*> inputs(mols.begin(), mols.end());
+    return get_batch_image_bytes(inputs, format, opts, use_common_scale,
+                                 num_threads);
+}
+
+QList<QByteArray> get_batch_image_bytes(const std::vector<std::string>& texts,
+                                        ImageFormat format,
+                                        const RenderOptions& opts,
+                                        const bool use_common_scale,
+                                        const unsigned int num_threads)
+{
+    std::vector<const std::string*> inputs;
+    inputs.reserve(texts.size());
+    for (const auto& text : texts) {
+        inputs.push_back(&text);
+    }
+    return get_batch_image_bytes(inputs, format, opts, use_common_scale,
+                                 num_threads);
+}
+
 qreal get_best_image_scale(const QList<RDKit::ROMol*> all_rdmols,
                            const RenderOptions& opts)
 {
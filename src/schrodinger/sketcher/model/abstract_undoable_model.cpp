@@ -1,5 +1,6 @@
 #include "schrodinger/sketcher/model/abstract_undoable_model.h"
 
+#include <algorithm>
 #include <stdexcept>
 
 #include <QUndoStack>
@@ -23,6 +24,13 @@ AbstractUndoableModel::AbstractUndoableModel(QUndoStack* const undo_stack,
 void AbstractUndoableModel::setUndoStack(QUndoStack* const undo_stack)
 {
     m_undo_stack = undo_stack;
+    m_first_undiscarded_command = 0;
+    m_num_discardable_commands = 0;
+}
+
+int AbstractUndoableModel::getUndoStackIndex() const
+{
+    return m_undo_stack == nullptr ? -1 : m_undo_stack->index();
 }
 
 void AbstractUndoableModel::doCommand(const std::function<void()> redo,
@@ -32,6 +40,7 @@ void AbstractUndoableModel::doCommand(const std::function<void()> redo,
     throwIfAlreadyAllowingEdits();
     UndoableModelUndoCommand* command =
         new UndoableModelUndoCommand(this, redo, undo, description);
+    int index_before_push = m_undo_stack->index();
     try {
         m_undo_stack->push(command);
     } catch (std::exception&) {
@@ -40,6 +49,10 @@ void AbstractUndoableModel::doCommand(const std::function<void()> redo,
         delete command;
         throw;
     }
+    // the index only changes if the command wasn't added to a macro
+    m_num_discardable_commands = m_undo_stack->index() > index_before_push
+                                     ? m_undo_stack->index() - 1
+                                     : m_undo_stack->index();
 }
 
 void AbstractUndoableModel::throwIfAlreadyAllowingEdits()
@@ -57,40 +70,88 @@ void AbstractUndoableModel::throwIfAlreadyAllowingEdits()
 
 UndoMacroRAII AbstractUndoableModel::createUndoMacro(const QString& description)
 {
-    return UndoMacroRAII(m_undo_stack, description);
+    return UndoMacroRAII(this, description);
 }
 
 void AbstractUndoableModel::beginUndoMacro(const QString& description)
 {
     m_undo_stack->beginMacro(description);
+    // QUndoStack undoes the commands of a macro in reverse order, so this
+    // command's undo runs after all of the others
+    doCommand([this]() { onUndoMacroStarted(); },
+              [this]() { onUndoMacroFinished(); }, description);
 }
 
 void AbstractUndoableModel::endUndoMacro()
 {
+    doCommand([this]() { onUndoMacroFinished(); },
+              [this]() { onUndoMacroStarted(); }, QString());
     m_undo_stack->endMacro();
 }
 
-UndoMacroRAII::UndoMacroRAII(QUndoStack* undo_stack,
+/**
+ * Discard the given command, along with all of its children, if it was created
+ * by the given model
+ */
+static void discard_commands(const QUndoCommand* command,
+                             const AbstractUndoableModel* model)
+{
+    // QUndoStack only gives out const pointers to its commands, but discarding
+    // a command doesn't change anything that the stack relies on
+    auto* discardable = dynamic_cast<const DiscardableUndoCommand*>(command);
+    if (discardable != nullptr && discardable->getModel() == model) {
+        const_cast<DiscardableUndoCommand*>(discardable)->discard();
+    }
+    for (int i = 0; i < command->childCount(); ++i) {
+        discard_commands(command->child(i), model);
+    }
+}
+
+void AbstractUndoableModel::discardOldestCommands(
+    const std::function<bool()>& should_discard)
+{
+    // If commands were undone and then replaced by a push, or if the stack was
+    // cleared, the commands from the new command's index onwards aren't the
+    // ones that were checked before
+    m_first_undiscarded_command =
+        std::min(m_first_undiscarded_command, m_num_discardable_commands);
+    while (m_first_undiscarded_command < m_num_discardable_commands &&
+           should_discard()) {
+        discard_commands(m_undo_stack->command(m_first_undiscarded_command),
+                         this);
+        ++m_first_undiscarded_command;
+    }
+}
+
+void AbstractUndoableModel::onUndoMacroStarted()
+{
+}
+
+void AbstractUndoableModel::onUndoMacroFinished()
+{
+}
+
+UndoMacroRAII::UndoMacroRAII(AbstractUndoableModel* model,
                              const QString& description) :
-    m_undo_stack(undo_stack)
+    m_model(model)
 {
-    m_undo_stack->beginMacro(description);
+    m_model->beginUndoMacro(description);
 }
 
 UndoMacroRAII::UndoMacroRAII(UndoMacroRAII&& other)
 {
-    this->m_undo_stack = other.m_undo_stack;
-    other.m_undo_stack = nullptr;
+    this->m_model = other.m_model;
+    other.m_model = nullptr;
     // The macro has already been begun by other, so we don't want to call
     // beginMacro again
 }
 
 UndoMacroRAII::~UndoMacroRAII()
 {
-    // m_undo_stack will be nullptr if this object has been moved from, in which
+    // m_model will be nullptr if this object has been moved from, in which
     // case the moved-to object is now responsible for ending the macro
-    if (m_undo_stack) {
-        m_undo_stack->endMacro();
+    if (m_model) {
+        m_model->endUndoMacro();
     }
 }
 
@@ -16,6 +16,8 @@ namespace schrodinger
 namespace sketcher
 {
 
+class AbstractUndoableModel;
+
 /**
  * An RAII class for creating undo macros in a QUndoStack
  */
@@ -23,10 +25,10 @@ class SKETCHER_API UndoMacroRAII
 {
   public:
     /**
-     * @param undo_stack The undo stack to create a macro in
+     * @param model The model to create a macro for
      * @param description A description of the macro
      */
-    UndoMacroRAII(QUndoStack* undo_stack, const QString& description);
+    UndoMacroRAII(AbstractUndoableModel* model, const QString& description);
 
     // move constructor, which will prevent the moved-from object from ending
     // the macro when it's destroyed
@@ -44,7 +46,7 @@ class SKETCHER_API UndoMacroRAII
     ~UndoMacroRAII();
 
   protected:
-    QUndoStack* m_undo_stack;
+    AbstractUndoableModel* m_model;
 };
 
 /**
@@ -81,6 +83,12 @@ class SKETCHER_API UndoMacroRAII
  * this will raise an exception.  Without the exception, this would instead
  * result in a downstream crash.
  *
+ * Every undo macro created by this class starts and ends with a command that
+ * calls onUndoMacroStarted and onUndoMacroFinished, respectively.  These are
+ * called when the macro is initially done, as well as whenever it's undone or
+ * redone, so subclasses can use them to coalesce the signals emitted by the
+ * commands in the macro.
+ *
  */
 class SKETCHER_API AbstractUndoableModel : public QObject
 {
@@ -98,6 +106,13 @@ class SKETCHER_API AbstractUndoableModel : public QObject
      */
     void setUndoStack(QUndoStack* const undo_stack);
 
+    /**
+     * @return the index of the undo stack's current command, or -1 if there is
+     * no undo stack.  The index doesn't change while an undo macro is open.
+     * See QUndoStack::index.
+     */
+    int getUndoStackIndex() const;
+
     /**
      * Return an RAII object that will manage the lifetime of an undo macro
      * @param description A description of the macro
@@ -170,8 +185,45 @@ class SKETCHER_API AbstractUndoableModel : public QObject
             this, redo, undo, merge_func, merge_id, init_data, description));
     }
 
+    /**
+     * Discard this model's commands on the undo stack, oldest first, for as
+     * long as should_discard returns true.  Discarded commands stay on the
+     * stack, so commands from other models are unaffected, but undoing or
+     * redoing them no longer does anything.  Commands are discarded one
+     * top-level command (i.e. one macro) at a time, and only among the
+     * commands that are done, so a macro that is being built is never
+     * touched.
+     *
+     * This should be called right after doCommand, so that any commands that
+     * the push removed from the redo side of the stack no longer hold on to
+     * their data.  The command that was just pushed is never discarded.  Each
+     * call resumes where the previous one stopped.
+     */
+    void discardOldestCommands(const std::function<bool()>& should_discard);
+
+    /**
+     * Called before any of the commands in an undo macro are done, undone, or
+     * redone.  Macros may be nested, in which case this is called once per
+     * macro.  The default implementation does nothing.
+     */
+    virtual void onUndoMacroStarted();
+
+    /**
+     * Called after all of the commands in an undo macro are done, undone, or
+     * redone.  The default implementation does nothing.
+     */
+    virtual void onUndoMacroFinished();
+
     QUndoStack* m_undo_stack;
 
+    // the index of the oldest top-level command on the undo stack that
+    // discardOldestCommands hasn't discarded yet
+    int m_first_undiscarded_command = 0;
+    // the number of top-level commands that discardOldestCommands may
+    // discard, i.e. all done commands except for the one that doCommand last
+    // pushed, if it was pushed outside of a macro
+    int m_num_discardable_commands = 0;
+
     // m_allow_edits is updated by AbstractUndoableModelUndoCommand immediately
     // before and after running a command
     bool m_allow_edits = false;
@@ -2,6 +2,8 @@
 
 #include <algorithm>
 #include <functional>
+#include <limits>
+#include <utility>
 #include <variant>
 
 #include <fmt/format.h>
@@ -14,6 +16,7 @@
 #include <rdkit/GraphMol/SubstanceGroup.h>
 
 #include <QObject>
+#include <QTimer>
 #include <QUndoStack>
 #include <QtAssert>
 #include <QtGlobal>
@@ -71,6 +74,12 @@ const std::string SECONDARY_CONNECTION_TAG_PROPERTY =
 namespace
 {
 
+/**
+ * The default maximum size of the undo history, in atoms and bonds summed over
+ * all molecule snapshots.  See MolModel::setMaxUndoHistorySize.
+ */
+constexpr size_t DEFAULT_MAX_UNDO_HISTORY_SIZE = 2'000'000;
+
 /**
  * @return a new atom using the specified atomic number
  */
@@ -171,10 +180,111 @@ void strip_notes_and_mol_model_tags(RDKit::ROMol& mol)
     }
 }
 
+/**
+ * @return the atoms or bonds of the given molecule, keyed by their tags
+ */
+template <typename T, typename U>
+std::unordered_map<int, const T*> get_items_by_tag(const U& items)
+{
+    std::unordered_map<int, const T*> items_by_tag;
+    int tag;
+    for (const auto* item : items) {
+        if (item->getPropIfPresent(TAG_PROPERTY, tag)) {
+            items_by_tag.emplace(tag, item);
+        }
+    }
+    return items_by_tag;
+}
+
+/**
+ * Find everything that a command changed in the molecule, where the
+ * molecule's stereochemistry or CIP labels may depend on the change.  Deleted
+ * atoms and bonds are reported through the atoms that they were bound to.
+ *
+ * @param old_mol The molecule from before the command
+ * @param new_mol The molecule from after the command, before
+ * update_molecule_on_change has been called
+ * @return the changed atoms and bonds of new_mol
+ */
+std::pair<std::unordered_set<const RDKit::Atom*>,
+          std::unordered_set<const RDKit::Bond*>>
+get_changed_atoms_and_bonds(const RDKit::ROMol& old_mol,
+                            const RDKit::ROMol& new_mol)
+{
+    std::unordered_set<const RDKit::Atom*> changed_atoms;
+    std::unordered_set<const RDKit::Bond*> changed_bonds;
+    auto old_atoms = get_items_by_tag<RDKit::Atom>(old_mol.atoms());
+    auto new_atoms = get_items_by_tag<RDKit::Atom>(new_mol.atoms());
+    const auto& old_conf = old_mol.getConformer();
+    const auto& new_conf = new_mol.getConformer();
+    for (const auto* atom : new_mol.atoms()) {
+        int tag;
+        auto old_atom = old_atoms.end();
+        if (atom->getPropIfPresent(TAG_PROPERTY, tag)) {
+            old_atom = old_atoms.find(tag);
+        }
+        // query atoms aren't compared, since their queries may have changed
+        if (old_atom == old_atoms.end() || atom->hasQuery() ||
+            old_atom->second->hasQuery() ||
+            atom->getAtomicNum() != old_atom->second->getAtomicNum() ||
+            atom->getIsotope() != old_atom->second->getIsotope() ||
+            atom->getFormalCharge() != old_atom->second->getFormalCharge() ||
+            atom->getNumRadicalElectrons() !=
+                old_atom->second->getNumRadicalElectrons() ||
+            atom->getNumExplicitHs() != old_atom->second->getNumExplicitHs() ||
+            atom->getNoImplicit() != old_atom->second->getNoImplicit() ||
+            atom->getChiralTag() != old_atom->second->getChiralTag() ||
+            (new_conf.getAtomPos(atom->getIdx()) -
+             old_conf.getAtomPos(old_atom->second->getIdx()))
+                    .lengthSq() > 0) {
+            changed_atoms.insert(atom);
+        }
+    }
+    auto get_atom_tag = [](const RDKit::Atom* atom) {
+        int tag = -1;
+        atom->getPropIfPresent(TAG_PROPERTY, tag);
+        return tag;
+    };
+    auto old_bonds = get_items_by_tag<RDKit::Bond>(old_mol.bonds());
+    for (const auto* bond : new_mol.bonds()) {
+        int tag;
+        auto old_bond = old_bonds.end();
+        if (bond->getPropIfPresent(TAG_PROPERTY, tag)) {
+            old_bond = old_bonds.find(tag);
+        }
+        if (old_bond == old_bonds.end() || bond->hasQuery() ||
+            old_bond->second->hasQuery() ||
+            bond->getBondType() != old_bond->second->getBondType() ||
+            bond->getBondDir() != old_bond->second->getBondDir() ||
+            bond->getStereo() != old_bond->second->getStereo() ||
+            get_atom_tag(bond->getBeginAtom()) !=
+                get_atom_tag(old_bond->second->getBeginAtom()) ||
+            get_atom_tag(bond->getEndAtom()) !=
+                get_atom_tag(old_bond->second->getEndAtom())) {
+            changed_bonds.insert(bond);
+        }
+        if (old_bond != old_bonds.end()) {
+            old_bonds.erase(old_bond);
+        }
+    }
+    // the remaining old bonds were deleted
+    for (auto [tag, old_bond] : old_bonds) {
+        for (const auto* old_atom :
+             {old_bond->getBeginAtom(), old_bond->getEndAtom()}) {
+            auto atom = new_atoms.find(get_atom_tag(old_atom));
+            if (atom != new_atoms.end()) {
+                changed_atoms.insert(atom->second);
+            }
+        }
+    }
+    return {changed_atoms, changed_bonds};
+}
+
 } // namespace
 
 MolModelSnapshot::MolModelSnapshot(
-    const RDKit::RWMol& mol, const std::vector<NonMolecularObject>& pluses,
+    const std::shared_ptr<const RDKit::RWMol>& mol,
+    const std::vector<NonMolecularObject>& pluses,
     const std::optional<NonMolecularObject>& arrow,
     const std::unordered_set<AtomTag>& selected_atom_tags,
     const std::unordered_set<BondTag>& selected_bond_tags,
@@ -200,10 +310,48 @@ bool MolModelSnapshot::isSelectionIdentical(const MolModelSnapshot& other)
            m_selected_non_molecular_tags == other.m_selected_non_molecular_tags;
 }
 
+size_t MolModelDelta::size() const
+{
+    size_t size = 0;
+    for (const auto* state : {&before, &after}) {
+        size += state->atoms.size() + state->bonds.size();
+        if (state->stereo_groups.has_value()) {
+            size += state->stereo_groups->size();
+        }
+    }
+    return size;
+}
+
 MolModel::MolModel(QUndoStack* const undo_stack, QObject* parent) :
-    AbstractUndoableModel(undo_stack, parent)
+    AbstractUndoableModel(undo_stack, parent),
+    m_undo_history_size(std::make_shared<size_t>(0)),
+    m_max_undo_history_size(DEFAULT_MAX_UNDO_HISTORY_SIZE)
 {
     initializeMol();
+    m_deferred_CIP_labels_timer.setSingleShot(true);
+    m_deferred_CIP_labels_timer.setInterval(DEFERRED_CIP_LABELS_DELAY_MS);
+    connect(&m_deferred_CIP_labels_timer, &QTimer::timeout, this,
+            &MolModel::assignDeferredCIPLabels);
+}
+
+void MolModel::setMaxUndoHistorySize(const size_t max_size)
+{
+    m_max_undo_history_size = max_size;
+}
+
+void MolModel::assignDeferredCIPLabels()
+{
+    m_deferred_CIP_labels_timer.stop();
+    if (!has_deferred_CIP_labels(m_mol)) {
+        return;
+    }
+    // CIP labels are derived from the rest of the molecule, so they're assigned
+    // in place rather than in an undo command.  Snapshots taken before now
+    // still have deferred labels, which are assigned again once restored.
+    assign_deferred_CIP_labels(m_mol);
+    m_mol_snapshot = nullptr;
+    m_deferred_signals.what_changed |= WhatChanged::MOLECULE;
+    emitDeferredSignals();
 }
 
 void MolModel::initializeMol()
@@ -226,6 +374,7 @@ boost::shared_ptr<RDKit::ROMol> MolModel::getMolForExport() const
 {
     // TODO: add API to export selection as atom/bond properties
     auto mol_copy = boost::make_shared<RDKit::ROMol>(m_mol);
+    assign_deferred_CIP_labels(*mol_copy);
     // Determine HELM-ness from the selection's atom content before stripping,
     // since stripping also clears the per-atom monomeric flags.
     const bool is_monomeric = contains_monomeric_atom(*mol_copy);
@@ -253,6 +402,8 @@ boost::shared_ptr<RDKit::ROMol> MolModel::getSelectedMolForExport()
     // selected, as to preserve any underlying features in the selection; note
     // that RDKit will automatically remove bonds attached to deleted atoms
     RDKit::RWMol mol_copy(m_mol);
+    // labels must be assigned before the molecule is split up
+    assign_deferred_CIP_labels(mol_copy);
     auto [atom_tags, bond_tags, s_group_tags, non_molecular_tags] =
         getAllUnselectedTags();
     mol_copy.beginBatchEdit();
@@ -522,11 +673,16 @@ void MolModel::doCommandUsingSnapshots(const std::function<void()> do_func,
                                        const WhatChangedType to_be_changed)
 {
     Q_ASSERT(!m_allow_edits);
-    auto undo_snapshot = takeSnapshot();
+    auto undo_snapshot = takeSnapshot(to_be_changed);
     m_allow_edits = true;
     do_func();
     if (to_be_changed & WhatChanged::MOLECULE) {
-        update_molecule_on_change(m_mol);
+        // CIP labels are only recalculated in the connected components that
+        // the command changed
+        auto [changed_atoms, changed_bonds] =
+            get_changed_atoms_and_bonds(*undo_snapshot.m_mol, m_mol);
+        update_molecule_on_change(m_mol, changed_atoms, changed_bonds);
+        m_mol_snapshot = nullptr;
     }
     // We don't need to call updateNonMolecularMetadata here since
     // m_tag_to_non_molecular_object (which is what updateNonMolecularMetadata
@@ -536,7 +692,7 @@ void MolModel::doCommandUsingSnapshots(const std::function<void()> do_func,
     // here wouldn't actually do any good.)  updateNonMolecularMetadata is
     // instead called in restoreSnapshot.
     m_allow_edits = false;
-    auto redo_snapshot = takeSnapshot();
+    auto redo_snapshot = takeSnapshot(to_be_changed);
 
     bool selection_changed = !undo_snapshot.isSelectionIdentical(redo_snapshot);
     bool arrow_added =
@@ -557,29 +713,473 @@ void MolModel::doCommandUsingSnapshots(const std::function<void()> do_func,
         restoreSnapshot(redo_snapshot, to_be_changed, selection_changed,
                         arrow_added);
         if (emit_new_molecule_added) {
-            emit newMoleculeAdded();
+            m_deferred_signals.new_molecule_added = true;
+            emitDeferredSignals();
+        }
+    };
+    doCommand(redo, undo, description);
+    if (to_be_changed & WhatChanged::MOLECULE) {
+        discardOldestCommandsIfTooLarge();
+    }
+}
+
+void MolModel::doCommandUsingDeltas(
+    const std::function<void()> do_func, const QString& description,
+    const std::unordered_set<AtomTag>& atom_tags,
+    const std::unordered_set<BondTag>& bond_tags,
+    const WhatChangedType to_be_changed)
+{
+    Q_ASSERT(!m_allow_edits);
+    Q_ASSERT(to_be_changed & WhatChanged::MOLECULE);
+    if (isMonomeric()) {
+        // monomer chains and linkages span many monomers, so monomeric
+        // molecules always use snapshots
+        doCommandUsingSnapshots(do_func, description, to_be_changed);
+        return;
+    }
+    // the snapshots only store the non-molecular objects and the selection
+    auto undo_snapshot = takeSnapshot(WhatChanged::NOTHING);
+    auto first_new_atom_tag = m_next_atom_tag;
+    auto first_new_bond_tag = m_next_bond_tag;
+    MolModelDelta delta;
+    delta.before = getDeltaState(atom_tags, bond_tags, first_new_atom_tag,
+                                 first_new_bond_tag);
+    auto stereo_groups_before = getStereoGroupStates();
+    m_allow_edits = true;
+    do_func();
+    delta.after = getDeltaState(atom_tags, bond_tags, first_new_atom_tag,
+                                first_new_bond_tag);
+    updateMoleculeForDeltaStates(delta.before, delta.after);
+    // update_molecule_on_change may add stereo groups, so we compare them
+    // afterwards
+    auto stereo_groups_after = getStereoGroupStates();
+    if (stereo_groups_before != stereo_groups_after) {
+        delta.before.stereo_groups = std::move(stereo_groups_before);
+        delta.after.stereo_groups = std::move(stereo_groups_after);
+    }
+    m_mol_snapshot = nullptr;
+    m_allow_edits = false;
+    auto redo_snapshot = takeSnapshot(WhatChanged::NOTHING);
+
+    bool selection_changed = !undo_snapshot.isSelectionIdentical(redo_snapshot);
+    bool arrow_added =
+        !undo_snapshot.m_arrow.has_value() && redo_snapshot.m_arrow.has_value();
+    bool arrow_removed =
+        undo_snapshot.m_arrow.has_value() && !redo_snapshot.m_arrow.has_value();
+
+    size_t size = delta.size();
+    *m_undo_history_size += size;
+    auto deleter = [history_size = m_undo_history_size,
+                    size](const MolModelDelta* delta) {
+        *history_size -= size;
+        delete delta;
+    };
+    auto shared_delta = std::shared_ptr<const MolModelDelta>(
+        new MolModelDelta(std::move(delta)), deleter);
+
+    auto undo = [this, shared_delta, undo_snapshot, to_be_changed,
+                 selection_changed, arrow_removed]() {
+        applyDeltaState(shared_delta->after, shared_delta->before);
+        // undoing the removal of an arrow is equivalent to adding an arrow
+        restoreSnapshot(undo_snapshot, to_be_changed, selection_changed,
+                        arrow_removed);
+    };
+    auto redo = [this, shared_delta, redo_snapshot, to_be_changed,
+                 selection_changed, arrow_added,
+                 is_initial_do = true]() mutable {
+        // on the initial do, do_func has already updated the molecule
+        if (!is_initial_do) {
+            applyDeltaState(shared_delta->before, shared_delta->after);
         }
+        is_initial_do = false;
+        restoreSnapshot(redo_snapshot, to_be_changed, selection_changed,
+                        arrow_added);
     };
     doCommand(redo, undo, description);
+    discardOldestCommandsIfTooLarge();
 }
 
-MolModelSnapshot MolModel::takeSnapshot() const
+void MolModel::discardOldestCommandsIfTooLarge()
 {
-    return MolModelSnapshot(m_mol, m_pluses, m_arrow, m_selected_atom_tags,
+    // the push released any commands that were undone, so only the remaining
+    // history counts.  The new command is never released here.
+    if (m_max_undo_history_size) {
+        discardOldestCommands([this]() {
+            return *m_undo_history_size > m_max_undo_history_size;
+        });
+    }
+}
+
+MolModelDelta::State
+MolModel::getDeltaState(const std::unordered_set<AtomTag>& atom_tags,
+                        const std::unordered_set<BondTag>& bond_tags,
+                        const AtomTag first_new_atom_tag,
+                        const BondTag first_new_bond_tag) const
+{
+    MolModelDelta::State state;
+    const auto& conf = m_mol.getConformer();
+    auto add_atom = [this, &state, &conf](const RDKit::Atom* atom) {
+        auto index = atom->getIdx();
+        state.atoms.push_back({getTagForAtom(atom), index,
+                               std::shared_ptr<RDKit::Atom>(atom->copy()),
+                               conf.getAtomPos(index)});
+    };
+    auto add_bond = [this, &state](const RDKit::Bond* bond) {
+        state.bonds.push_back({getTagForBond(bond), bond->getIdx(),
+                               std::shared_ptr<RDKit::Bond>(bond->copy()),
+                               getTagForAtom(bond->getBeginAtom()),
+                               getTagForAtom(bond->getEndAtom())});
+    };
+    for (auto atom_tag : atom_tags) {
+        if (m_mol.hasAtomBookmark(atom_tag)) {
+            add_atom(getAtomFromTag(atom_tag));
+        }
+    }
+    for (auto bond_tag : bond_tags) {
+        if (m_mol.hasBondBookmark(bond_tag)) {
+            add_bond(getBondFromTag(bond_tag));
+        }
+    }
+    // new atoms and bonds are always appended, so we only need to look at the
+    // end of the molecule to find them
+    for (auto idx = m_mol.getNumAtoms(); idx > 0; --idx) {
+        const auto* atom = m_mol.getAtomWithIdx(idx - 1);
+        auto atom_tag = getTagForAtom(atom);
+        if (atom_tag < first_new_atom_tag) {
+            break;
+        }
+        if (!atom_tags.count(atom_tag)) {
+            add_atom(atom);
+        }
+    }
+    for (auto idx = m_mol.getNumBonds(); idx > 0; --idx) {
+        const auto* bond = m_mol.getBondWithIdx(idx - 1);
+        auto bond_tag = getTagForBond(bond);
+        if (bond_tag < first_new_bond_tag) {
+            break;
+        }
+        if (!bond_tags.count(bond_tag)) {
+            add_bond(bond);
+        }
+    }
+    std::ranges::sort(state.atoms, {}, &MolModelDelta::AtomState::index);
+    std::ranges::sort(state.bonds, {}, &MolModelDelta::BondState::index);
+    return state;
+}
+
+std::vector<MolModelDelta::StereoGroupState>
+MolModel::getStereoGroupStates() const
+{
+    std::vector<MolModelDelta::StereoGroupState> stereo_groups;
+    for (const auto& stereo_group : m_mol.getStereoGroups()) {
+        MolModelDelta::StereoGroupState state{stereo_group.getGroupType(),
+                                              {},
+                                              {},
+                                              stereo_group.getReadId(),
+                                              stereo_group.getWriteId()};
+        for (const auto* atom : stereo_group.getAtoms()) {
+            state.atom_tags.push_back(getTagForAtom(atom));
+        }
+        for (const auto* bond : stereo_group.getBonds()) {
+            state.bond_tags.push_back(getTagForBond(bond));
+        }
+        stereo_groups.push_back(std::move(state));
+    }
+    return stereo_groups;
+}
+
+/**
+ * @param num_items The number of atoms or bonds in the molecule
+ * @param target_and_current_indices The index that an atom or bond must be
+ * moved to, along with its current index
+ * @return the current index of the atom or bond to put at each index.  Atoms
+ * or bonds that aren't in target_and_current_indices keep their relative
+ * order.
+ */
+static std::vector<unsigned int> get_new_order(
+    const unsigned int num_items,
+    const std::vector<std::pair<unsigned int, unsigned int>>&
+        target_and_current_indices)
+{
+    const auto unset = std::numeric_limits<unsigned int>::max();
+    std::vector<unsigned int> order(num_items, unset);
+    std::vector<bool> is_placed(num_items, false);
+    for (auto [target_idx, current_idx] : target_and_current_indices) {
+        order[target_idx] = current_idx;
+        is_placed[current_idx] = true;
+    }
+    unsigned int next_idx = 0;
+    for (auto& current_idx : order) {
+        if (current_idx == unset) {
+            while (is_placed[next_idx]) {
+                ++next_idx;
+            }
+            current_idx = next_idx++;
+        }
+    }
+    return order;
+}
+
+/**
+ * Reorder the atoms and bonds of a molecule.  Bookmarks are recreated from the
+ * tag properties.  The molecule must not have any substance groups.
+ *
+ * @param mol The molecule to reorder
+ * @param atom_order The current index of the atom to put at each index
+ * @param bond_order The current index of the bond to put at each index
+ */
+static void reorder_atoms_and_bonds(RDKit::RWMol& mol,
+                                    const std::vector<unsigned int>& atom_order,
+                                    const std::vector<unsigned int>& bond_order)
+{
+    Q_ASSERT(getSubstanceGroups(mol).empty());
+    std::vector<unsigned int> new_atom_indices(atom_order.size());
+    for (unsigned int i = 0; i < atom_order.size(); ++i) {
+        new_atom_indices[atom_order[i]] = i;
+    }
+    std::vector<unsigned int> new_bond_indices(bond_order.size());
+    for (unsigned int i = 0; i < bond_order.size(); ++i) {
+        new_bond_indices[bond_order[i]] = i;
+    }
+
+    RDKit::RWMol reordered;
+    reordered.updateProps(mol);
+    for (auto atom_idx : atom_order) {
+        auto* atom = mol.getAtomWithIdx(atom_idx)->copy();
+        reordered.addAtom(atom, /* updateLabel = */ false,
+                          /* takeOwnership = */ true);
+        reordered.setAtomBookmark(atom, atom->getProp<int>(TAG_PROPERTY));
+    }
+    for (auto bond_idx : bond_order) {
+        auto* bond = mol.getBondWithIdx(bond_idx)->copy();
+        bond->setOwningMol(reordered);
+        bond->setBeginAtomIdx(new_atom_indices[bond->getBeginAtomIdx()]);
+        bond->setEndAtomIdx(new_atom_indices[bond->getEndAtomIdx()]);
+        for (auto& stereo_atom_idx : bond->getStereoAtoms()) {
+            stereo_atom_idx = new_atom_indices[stereo_atom_idx];
+        }
+        reordered.addBond(bond, /* takeOwnership = */ true);
+        reordered.setBondBookmark(bond, bond->getProp<int>(TAG_PROPERTY));
+    }
+    for (auto conf = mol.beginConformers(); conf != mol.endConformers();
+         ++conf) {
+        auto* reordered_conf = new RDKit::Conformer(atom_order.size());
+        reordered_conf->setId((*conf)->getId());
+        reordered_conf->set3D((*conf)->is3D());
+        for (unsigned int i = 0; i < atom_order.size(); ++i) {
+            reordered_conf->setAtomPos(i, (*conf)->getAtomPos(atom_order[i]));
+        }
+        reordered.addConformer(reordered_conf);
+    }
+    std::vector<RDKit::StereoGroup> stereo_groups;
+    for (const auto& stereo_group : mol.getStereoGroups()) {
+        std::vector<RDKit::Atom*> atoms;
+        for (const auto* atom : stereo_group.getAtoms()) {
+            atoms.push_back(
+                reordered.getAtomWithIdx(new_atom_indices[atom->getIdx()]));
+        }
+        std::vector<RDKit::Bond*> bonds;
+        for (const auto* bond : stereo_group.getBonds()) {
+            bonds.push_back(
+                reordered.getBondWithIdx(new_bond_indices[bond->getIdx()]));
+        }
+        RDKit::StereoGroup reordered_group(stereo_group.getGroupType(),
+                                           std::move(atoms), std::move(bonds),
+                                           stereo_group.getReadId());
+        reordered_group.setWriteId(stereo_group.getWriteId());
+        stereo_groups.push_back(std::move(reordered_group));
+    }
+    reordered.setStereoGroups(std::move(stereo_groups));
+    mol = std::move(reordered);
+}
+
+void MolModel::applyDeltaState(const MolModelDelta::State& from,
+                               const MolModelDelta::State& to)
+{
+    Q_ASSERT(m_allow_edits);
+    std::unordered_set<AtomTag> to_atom_tags;
+    for (const auto& atom_state : to.atoms) {
+        to_atom_tags.insert(atom_state.tag);
+    }
+    std::unordered_set<BondTag> to_bond_tags;
+    for (const auto& bond_state : to.bonds) {
+        to_bond_tags.insert(bond_state.tag);
+    }
+
+    // remove the bonds first so that they don't get implicitly deleted when we
+    // remove an atom
+    for (const auto& bond_state : from.bonds) {
+        if (!to_bond_tags.count(bond_state.tag)) {
+            auto* bond = m_mol.getUniqueBondWithBookmark(bond_state.tag);
+            m_mol.removeBond(bond->getBeginAtomIdx(), bond->getEndAtomIdx());
+        }
+    }
+    for (const auto& atom_state : from.atoms) {
+        if (!to_atom_tags.count(atom_state.tag)) {
+            m_mol.removeAtom(
+                m_mol.getUniqueAtomWithBookmark(atom_state.tag));
+        }
+    }
+
+    // replace the atoms and bonds that are in both states, and append the rest.
+    // Existing atoms and bonds don't move after this point, so we keep track of
+    // where they are.
+    std::vector<std::pair<unsigned int, unsigned int>> atom_indices;
+    for (const auto& atom_state : to.atoms) {
+        unsigned int atom_idx;
+        if (m_mol.hasAtomBookmark(atom_state.tag)) {
+            atom_idx =
+                m_mol.getUniqueAtomWithBookmark(atom_state.tag)->getIdx();
+            // replaceAtom copies the atom, including its tag property, and
+            // updates the bookmark
+            m_mol.replaceAtom(atom_idx, atom_state.atom.get());
+        } else {
+            atom_idx = m_mol.addAtom(atom_state.atom.get(),
+                                     /* updateLabel = */ false);
+            setTagForAtom(m_mol.getAtomWithIdx(atom_idx), atom_state.tag);
+        }
+        m_mol.getConformer().setAtomPos(atom_idx, atom_state.coords);
+        atom_indices.emplace_back(atom_state.index, atom_idx);
+    }
+    std::vector<std::pair<unsigned int, unsigned int>> bond_indices;
+    for (const auto& bond_state : to.bonds) {
+        auto* begin_atom =
+            m_mol.getUniqueAtomWithBookmark(bond_state.begin_atom_tag);
+        auto* end_atom =
+            m_mol.getUniqueAtomWithBookmark(bond_state.end_atom_tag);
+        unsigned int bond_idx;
+        if (m_mol.hasBondBookmark(bond_state.tag)) {
+            bond_idx =
+                m_mol.getUniqueBondWithBookmark(bond_state.tag)->getIdx();
+            m_mol.replaceBond(bond_idx, bond_state.bond.get());
+            // the bond may have been flipped
+            auto* bond = m_mol.getBondWithIdx(bond_idx);
+            bond->setBeginAtomIdx(begin_atom->getIdx());
+            bond->setEndAtomIdx(end_atom->getIdx());
+        } else {
+            auto bond = std::shared_ptr<RDKit::Bond>(bond_state.bond->copy());
+            bond->setOwningMol(m_mol);
+            bond->setBeginAtom(begin_atom);
+            bond->setEndAtom(end_atom);
+            // addBond returns the new number of bonds, *not* the index of the
+            // newly added bond
+            bond_idx = m_mol.addBond(bond.get()) - 1;
+            setTagForBond(m_mol.getBondWithIdx(bond_idx), bond_state.tag);
+        }
+        bond_indices.emplace_back(bond_state.index, bond_idx);
+    }
+
+    // Appending is enough to redo additions and undo removals at the end of
+    // the molecule.  Atoms or bonds removed from the middle of the molecule
+    // have to be moved back to where they were, which requires rebuilding the
+    // molecule.
+    auto is_in_place = [](const auto& indices) {
+        return std::ranges::all_of(indices, [](const auto& target_and_current) {
+            return target_and_current.first == target_and_current.second;
+        });
+    };
+    if (!is_in_place(atom_indices) || !is_in_place(bond_indices)) {
+        reorder_atoms_and_bonds(
+            m_mol, get_new_order(m_mol.getNumAtoms(), atom_indices),
+            get_new_order(m_mol.getNumBonds(), bond_indices));
+        // the stereo atoms of the stored bonds already used the indices of
+        // the to state, so the reordering scrambled them
+        for (const auto& bond_state : to.bonds) {
+            m_mol.getBondWithIdx(bond_state.index)->getStereoAtoms() =
+                bond_state.bond->getStereoAtoms();
+        }
+    }
+
+    if (to.stereo_groups.has_value()) {
+        std::vector<RDKit::StereoGroup> stereo_groups;
+        for (const auto& state : *to.stereo_groups) {
+            std::vector<RDKit::Atom*> atoms;
+            for (auto atom_tag : state.atom_tags) {
+                atoms.push_back(m_mol.getUniqueAtomWithBookmark(atom_tag));
+            }
+            std::vector<RDKit::Bond*> bonds;
+            for (auto bond_tag : state.bond_tags) {
+                bonds.push_back(m_mol.getUniqueBondWithBookmark(bond_tag));
+            }
+            RDKit::StereoGroup stereo_group(state.type, std::move(atoms),
+                                            std::move(bonds), state.read_id);
+            stereo_group.setWriteId(state.write_id);
+            stereo_groups.push_back(std::move(stereo_group));
+        }
+        m_mol.setStereoGroups(std::move(stereo_groups));
+    }
+    updateMoleculeForDeltaStates(from, to);
+    m_mol_snapshot = nullptr;
+}
+
+void MolModel::updateMoleculeForDeltaStates(const MolModelDelta::State& from,
+                                            const MolModelDelta::State& to)
+{
+    std::unordered_set<const RDKit::Atom*> atoms;
+    std::unordered_set<const RDKit::Bond*> bonds;
+    auto add_atom = [this, &atoms](const AtomTag atom_tag) {
+        if (m_mol.hasAtomBookmark(atom_tag)) {
+            atoms.insert(getAtomFromTag(atom_tag));
+        }
+    };
+    for (const auto* state : {&from, &to}) {
+        for (const auto& atom_state : state->atoms) {
+            add_atom(atom_state.tag);
+        }
+        // include the atoms of removed bonds, since their components changed
+        for (const auto& bond_state : state->bonds) {
+            add_atom(bond_state.begin_atom_tag);
+            add_atom(bond_state.end_atom_tag);
+            if (m_mol.hasBondBookmark(bond_state.tag)) {
+                bonds.insert(getBondFromTag(bond_state.tag));
+            }
+        }
+    }
+    update_molecule_on_change(m_mol, atoms, bonds);
+}
+
+MolModelSnapshot MolModel::takeSnapshot(const WhatChangedType what_changed)
+{
+    std::shared_ptr<const RDKit::RWMol> mol;
+    if (what_changed & WhatChanged::MOLECULE) {
+        mol = getMolSnapshot();
+    }
+    return MolModelSnapshot(mol, m_pluses, m_arrow, m_selected_atom_tags,
                             m_selected_bond_tags, m_selected_s_group_tags,
                             m_selected_non_molecular_tags, m_highlighting_info);
 }
 
+std::shared_ptr<const RDKit::RWMol> MolModel::getMolSnapshot()
+{
+    if (m_mol_snapshot == nullptr) {
+        size_t size = m_mol.getNumAtoms() + m_mol.getNumBonds();
+        *m_undo_history_size += size;
+        auto deleter = [history_size = m_undo_history_size,
+                        size](const RDKit::RWMol* mol) {
+            *history_size -= size;
+            delete mol;
+        };
+        m_mol_snapshot = std::shared_ptr<const RDKit::RWMol>(
+            new RDKit::RWMol(m_mol), deleter);
+    }
+    return m_mol_snapshot;
+}
+
 void MolModel::restoreSnapshot(const MolModelSnapshot& snapshot,
                                const WhatChangedType what_changed,
                                const bool selection_changed,
                                const bool arrow_added)
 {
     Q_ASSERT(m_allow_edits);
-    if (what_changed & WhatChanged::MOLECULE) {
-        m_mol = snapshot.m_mol;
-        // we don't need to call update_molecule_on_change since all metadata
-        // was updated before we took the snapshot
+    if (what_changed & WhatChanged::MOLECULE && snapshot.m_mol != nullptr &&
+        snapshot.m_mol != m_mol_snapshot) {
+        // If the snapshot is the current copy of m_mol (i.e. on the initial
+        // do), then m_mol is already up to date.  Otherwise, we don't need to
+        // call update_molecule_on_change since all metadata was updated before
+        // we took the snapshot.  Commands using deltas don't store the
+        // molecule in their snapshots, since they've already updated it.
+        m_mol = *snapshot.m_mol;
+        m_mol_snapshot = snapshot.m_mol;
     }
     if (what_changed & WhatChanged::NON_MOL_OBJS) {
         m_pluses = snapshot.m_pluses;
@@ -595,14 +1195,66 @@ void MolModel::restoreSnapshot(const MolModelSnapshot& snapshot,
 
     if (what_changed & WhatChanged::MOLECULE ||
         what_changed & WhatChanged::NON_MOL_OBJS) {
-        emit modelChanged(what_changed);
+        m_deferred_signals.what_changed |= what_changed;
     }
-    if (selection_changed) {
+    m_deferred_signals.selection_changed |= selection_changed;
+    m_deferred_signals.reaction_arrow_added |= arrow_added;
+    emitDeferredSignals();
+}
+
+void MolModel::emitDeferredSignals()
+{
+    if (m_signal_deferral_depth > 0) {
+        return;
+    }
+    auto deferred_signals = std::exchange(m_deferred_signals, {});
+    if ((deferred_signals.what_changed & WhatChanged::MOLECULE ||
+         deferred_signals.coordinates_changed) &&
+        has_deferred_CIP_labels(m_mol)) {
+        m_deferred_CIP_labels_timer.start();
+    }
+    // signals are blocked outside of commands, but the outermost
+    // SignalCoalescer may be destroyed after its commands have finished
+    bool signals_blocked = blockSignals(false);
+    if (deferred_signals.what_changed != WhatChanged::NOTHING) {
+        emit modelChanged(deferred_signals.what_changed);
+    }
+    if (deferred_signals.coordinates_changed) {
+        emit coordinatesChanged();
+    }
+    if (deferred_signals.selection_changed) {
         emit selectionChanged();
     }
-    if (arrow_added) {
+    if (deferred_signals.reaction_arrow_added) {
         emit reactionArrowAdded();
     }
+    if (deferred_signals.new_molecule_added) {
+        emit newMoleculeAdded();
+    }
+    blockSignals(signals_blocked);
+}
+
+void MolModel::onUndoMacroStarted()
+{
+    ++m_signal_deferral_depth;
+}
+
+void MolModel::onUndoMacroFinished()
+{
+    --m_signal_deferral_depth;
+    emitDeferredSignals();
+}
+
+MolModel::SignalCoalescer::SignalCoalescer(MolModel* mol_model) :
+    m_mol_model(mol_model)
+{
+    ++m_mol_model->m_signal_deferral_depth;
+}
+
+MolModel::SignalCoalescer::~SignalCoalescer()
+{
+    --m_mol_model->m_signal_deferral_depth;
+    m_mol_model->emitDeferredSignals();
 }
 
 void MolModel::addAtom(const Element& element, const RDGeom::Point3D& coords,
@@ -659,8 +1311,8 @@ void MolModel::addAttachmentPoint(const RDGeom::Point3D& coords,
         addAtomChainCommandFunc(create_atom, {coords}, create_bond,
                                 bound_to_atom_tag);
     };
-    doCommandUsingSnapshots(cmd_func, "Add attachment point",
-                            WhatChanged::MOLECULE);
+    doCommandUsingDeltas(cmd_func, "Add attachment point", {bound_to_atom_tag},
+                         {});
 }
 
 /**
@@ -961,7 +1613,7 @@ void MolModel::addAtomChain(const Element& element,
         addAtomChainCommandFunc(create_atom, coords, create_bond,
                                 bound_to_atom_tag);
     };
-    doCommandUsingSnapshots(cmd_func, desc, WhatChanged::MOLECULE);
+    doCommandUsingDeltas(cmd_func, desc, {bound_to_atom_tag}, {});
 }
 
 void MolModel::addAtomChain(
@@ -987,7 +1639,7 @@ void MolModel::addAtomChain(
         addAtomChainCommandFunc(create_atom, coords, create_bond,
                                 bound_to_atom_tag);
     };
-    doCommandUsingSnapshots(cmd_func, desc, WhatChanged::MOLECULE);
+    doCommandUsingDeltas(cmd_func, desc, {bound_to_atom_tag}, {});
 }
 
 void MolModel::addAtomChain(
@@ -1009,7 +1661,7 @@ void MolModel::addAtomChain(
         addAtomChainCommandFunc(create_atom, coords, create_bond,
                                 bound_to_atom_tag);
     };
-    doCommandUsingSnapshots(cmd_func, desc, WhatChanged::MOLECULE);
+    doCommandUsingDeltas(cmd_func, desc, {bound_to_atom_tag}, {});
 }
 
 void MolModel::addAtomChain(
@@ -1031,7 +1683,7 @@ void MolModel::addAtomChain(
         addAtomChainCommandFunc(create_atom, coords, create_bond,
                                 bound_to_atom_tag);
     };
-    doCommandUsingSnapshots(cmd_func, desc, WhatChanged::MOLECULE);
+    doCommandUsingDeltas(cmd_func, desc, {bound_to_atom_tag}, {});
 }
 
 void MolModel::addRGroupChain(const std::vector<unsigned int> r_group_nums,
@@ -1050,7 +1702,7 @@ void MolModel::addRGroupChain(const std::vector<unsigned int> r_group_nums,
                                 bound_to_atom_tag);
     };
 
-    doCommandUsingSnapshots(cmd_func, "Add R group", WhatChanged::MOLECULE);
+    doCommandUsingDeltas(cmd_func, "Add R group", {bound_to_atom_tag}, {});
 }
 
 std::pair<unsigned int, QString>
@@ -1076,7 +1728,7 @@ void MolModel::addBond(const RDKit::Atom* const start_atom,
         auto create_bond = std::bind(make_new_bond, bond_type, bond_dir);
         addBondCommandFunc(start_atom_tag, end_atom_tag, create_bond);
     };
-    doCommandUsingSnapshots(cmd_func, desc, WhatChanged::MOLECULE);
+    doCommandUsingDeltas(cmd_func, desc, {start_atom_tag, end_atom_tag}, {});
 }
 
 void MolModel::addBond(
@@ -1094,7 +1746,7 @@ void MolModel::addBond(
             std::bind(make_new_query_bond, bond_query, bond_type);
         addBondCommandFunc(start_atom_tag, end_atom_tag, create_bond);
     };
-    doCommandUsingSnapshots(cmd_func, desc, WhatChanged::MOLECULE);
+    doCommandUsingDeltas(cmd_func, desc, {start_atom_tag, end_atom_tag}, {});
 }
 
 void MolModel::addVariableAttachmentBond(
@@ -1179,7 +1831,38 @@ void MolModel::remove(
         removeCommandFunc(atom_tags, bond_tags, s_groups, non_molecular_tags);
     };
 
-    doCommandUsingSnapshots(cmd_func, desc, to_be_changed);
+    // Removing attachment points renumbers the remaining ones, removing atoms
+    // or bonds can implicitly change S-groups, and secondary connections share
+    // a bond with another connection, so those removals still use snapshots
+    auto is_or_has_attachment_point = [this](const RDKit::Atom* atom) {
+        if (is_attachment_point(atom)) {
+            return true;
+        }
+        for (auto* neighbor : m_mol.atomNeighbors(atom)) {
+            if (is_attachment_point(neighbor)) {
+                return true;
+            }
+        }
+        return false;
+    };
+    if (!(to_be_changed & WhatChanged::MOLECULE) || !s_groups.empty() ||
+        !secondary_connections.empty() ||
+        !getSubstanceGroups(m_mol).empty() ||
+        std::ranges::any_of(expanded_atoms, is_or_has_attachment_point)) {
+        doCommandUsingSnapshots(cmd_func, desc, to_be_changed);
+        return;
+    }
+    std::unordered_set<BondTag> removed_bond_tags;
+    for (const auto& bond_tag_with_atoms : bond_tags) {
+        removed_bond_tags.insert(std::get<0>(bond_tag_with_atoms));
+    }
+    for (auto* cur_atom : expanded_atoms) {
+        for (auto* cur_bond : m_mol.atomBonds(cur_atom)) {
+            removed_bond_tags.insert(getTagForBond(cur_bond));
+        }
+    }
+    doCommandUsingDeltas(cmd_func, desc, getTagsForAtoms(expanded_atoms),
+                         removed_bond_tags, to_be_changed);
 }
 
 void MolModel::addMolAt(RDKit::RWMol mol, const RDGeom::Point3D& position,
@@ -1385,7 +2068,8 @@ void MolModel::setAtomCharge(const RDKit::Atom* const atom, int charge)
     auto cmd_func = [this, atom, charge]() {
         getMutableAtom(atom)->setFormalCharge(charge);
     };
-    doCommandUsingSnapshots(cmd_func, "Set atom charge", WhatChanged::MOLECULE);
+    doCommandUsingDeltas(cmd_func, "Set atom charge", {getTagForAtom(atom)},
+                         {});
 }
 
 void MolModel::setAtomMapping(
@@ -1402,7 +2086,8 @@ void MolModel::setAtomMapping(
         }
     };
 
-    doCommandUsingSnapshots(redo, "Set mapping number", WhatChanged::MOLECULE);
+    doCommandUsingDeltas(redo, "Set mapping number", getTagsForAtoms(atoms),
+                         {});
 }
 
 void MolModel::updateExplicitHs(ExplicitHActions action,
@@ -1480,7 +2165,7 @@ void MolModel::flipBond(const RDKit::Bond* const bond)
 {
     auto bond_tag = getTagForBond(bond);
     auto cmd_func = [this, bond_tag]() { flipBondCommandFunc(bond_tag); };
-    doCommandUsingSnapshots(cmd_func, "Flip bond", WhatChanged::MOLECULE);
+    doCommandUsingDeltas(cmd_func, "Flip bond", {}, {bond_tag});
 }
 
 static void update_post_compute2DCoords(RDKit::RWMol& mol)
@@ -1686,6 +2371,12 @@ void MolModel::transformCoordinatesWithFunction(
         non_molecular_objects = getNonMolecularObjects();
     }
 
+    if (m_transient_transform.has_value() && merge_id != MergeId::NO_MERGE) {
+        transformCoordinatesTransiently(desc, function, atoms,
+                                        non_molecular_objects);
+        return;
+    }
+
     // convert to vectors
     std::vector<const RDKit::Atom*> atom_vec(atoms.begin(), atoms.end());
     std::vector<const NonMolecularObject*> non_mol_vec(
@@ -1767,6 +2458,127 @@ void MolModel::transformCoordinatesWithFunction(
     }
 }
 
+void MolModel::transformCoordinatesTransiently(
+    const QString& desc, const std::function<void(RDGeom::Point3D&)>& function,
+    const std::unordered_set<const RDKit::Atom*>& atoms,
+    const std::unordered_set<const NonMolecularObject*>& non_molecular_objects)
+{
+    auto& transform = *m_transient_transform;
+    if (transform.description.isEmpty()) {
+        transform.description = desc;
+    }
+    if (atoms != transform.moved_atoms) {
+        transform.moved_atoms = atoms;
+        transform.moved_molecule_atoms.clear();
+        std::vector<int> frag_map;
+        RDKit::MolOps::getMolFrags(m_mol, frag_map);
+        std::unordered_set<int> moved_frags;
+        for (auto* atom : atoms) {
+            moved_frags.insert(frag_map[atom->getIdx()]);
+        }
+        for (auto* atom : m_mol.atoms()) {
+            if (moved_frags.count(frag_map[atom->getIdx()])) {
+                transform.moved_molecule_atoms.insert(atom);
+            }
+        }
+    }
+
+    auto& conf = m_mol.getConformer();
+    for (auto* atom : atoms) {
+        auto& coords = conf.getAtomPos(atom->getIdx());
+        transform.initial_atom_coords.try_emplace(getTagForAtom(atom), coords);
+        function(coords);
+    }
+    for (auto* non_mol_obj : non_molecular_objects) {
+        auto coords = non_mol_obj->getCoords();
+        transform.initial_non_mol_coords.try_emplace(non_mol_obj->getTag(),
+                                                     coords);
+        function(coords);
+        m_tag_to_non_molecular_object.at(non_mol_obj->getTag())
+            ->setCoords(coords);
+    }
+    if (transform.moved_molecule_atoms.size() != atoms.size()) {
+        // only part of a molecule was moved, which may change its
+        // stereochemistry
+        update_molecule_on_change(m_mol, atoms, {});
+    }
+    m_mol_snapshot = nullptr;
+
+    // signals are blocked outside of commands, and transient transforms
+    // don't issue any
+    bool signals_blocked = blockSignals(false);
+    emit transientCoordinatesChanged(transform.moved_molecule_atoms,
+                                     non_molecular_objects);
+    blockSignals(signals_blocked);
+}
+
+void MolModel::beginTransientTransform()
+{
+    finishTransientTransform();
+    m_transient_transform.emplace();
+}
+
+void MolModel::finishTransientTransform()
+{
+    if (!m_transient_transform.has_value()) {
+        return;
+    }
+    auto transform = std::move(*m_transient_transform);
+    m_transient_transform.reset();
+
+    std::vector<AtomTag> atom_tags;
+    std::vector<RDGeom::Point3D> atom_coords;
+    std::vector<RDGeom::Point3D> initial_atom_coords;
+    // objects are looked up by tag in case they were removed, e.g. by an undo
+    // in the middle of the transform
+    const auto& conf = m_mol.getConformer();
+    for (auto [atom_tag, initial_coords] : transform.initial_atom_coords) {
+        if (!m_mol.hasAtomBookmark(atom_tag)) {
+            continue;
+        }
+        auto* atom = m_mol.getUniqueAtomWithBookmark(atom_tag);
+        atom_tags.push_back(atom_tag);
+        atom_coords.push_back(conf.getAtomPos(atom->getIdx()));
+        initial_atom_coords.push_back(initial_coords);
+    }
+    std::vector<NonMolecularTag> non_mol_tags;
+    std::vector<RDGeom::Point3D> non_mol_coords;
+    std::vector<RDGeom::Point3D> initial_non_mol_coords;
+    for (auto [non_mol_tag, initial_coords] :
+         transform.initial_non_mol_coords) {
+        auto non_mol_obj = m_tag_to_non_molecular_object.find(non_mol_tag);
+        if (non_mol_obj == m_tag_to_non_molecular_object.end()) {
+            continue;
+        }
+        non_mol_tags.push_back(non_mol_tag);
+        non_mol_coords.push_back(non_mol_obj->second->getCoords());
+        initial_non_mol_coords.push_back(initial_coords);
+    }
+    if (atom_tags.empty() && non_mol_tags.empty()) {
+        // nothing was transformed
+        return;
+    }
+
+    // the objects are already at their final coordinates, but redoing the
+    // command updates the stereochemistry and emits coordinatesChanged
+    auto redo = [this, atom_tags, atom_coords, non_mol_tags,
+                 non_mol_coords]() {
+        this->setCoordinates(atom_tags, atom_coords, non_mol_tags,
+                             non_mol_coords);
+    };
+    auto undo = [this, atom_tags, initial_atom_coords, non_mol_tags,
+                 initial_non_mol_coords]() {
+        this->setCoordinates(atom_tags, initial_atom_coords, non_mol_tags,
+                             initial_non_mol_coords);
+    };
+    doCommand(redo, undo, transform.description);
+}
+
+bool MolModel::isInTransientTransform() const
+{
+    return m_transient_transform.has_value();
+}
+
 void MolModel::rotateByAngle(
     float angle, const RDGeom::Point3D& pivot_point,
     const std::unordered_set<const RDKit::Atom*>& atoms,
@@ -2240,7 +3052,7 @@ void MolModel::mutateAtoms(const std::unordered_set<const RDKit::Atom*>& atoms,
             }
         }
     };
-    doCommandUsingSnapshots(cmd_func, "Mutate atoms", WhatChanged::MOLECULE);
+    doCommandUsingDeltas(cmd_func, "Mutate atoms", getTagsForAtoms(atoms), {});
 }
 
 void MolModel::mutateRGroups(
@@ -2261,7 +3073,7 @@ void MolModel::mutateRGroups(
             mutateAtomCommandFunc(getTagForAtom(atom), create_atom);
         }
     };
-    doCommandUsingSnapshots(cmd_func, "Mutate atoms", WhatChanged::MOLECULE);
+    doCommandUsingDeltas(cmd_func, "Mutate atoms", getTagsForAtoms(atoms), {});
 }
 
 void MolModel::mutateMonomers(
@@ -2351,7 +3163,7 @@ void MolModel::mutateBonds(const std::unordered_set<const RDKit::Bond*>& bonds,
             flipBondCommandFunc(bond_tag);
         }
     };
-    doCommandUsingSnapshots(cmd_func, "Mutate bonds", WhatChanged::MOLECULE);
+    doCommandUsingDeltas(cmd_func, "Mutate bonds", {}, bond_tags_to_mutate);
 }
 
 void MolModel::setBondTopology(
@@ -2408,8 +3220,8 @@ void MolModel::adjustChargeOnAtoms(
                                                   increment_by);
         }
     };
-    doCommandUsingSnapshots(cmd_func, "Set atomic charge",
-                            WhatChanged::MOLECULE);
+    doCommandUsingDeltas(cmd_func, "Set atomic charge", getTagsForAtoms(atoms),
+                         {});
 }
 
 void MolModel::adjustRadicalElectronsOnAtoms(
@@ -2424,8 +3236,8 @@ void MolModel::adjustRadicalElectronsOnAtoms(
                 atom->getNumRadicalElectrons() + increment_by);
         }
     };
-    doCommandUsingSnapshots(cmd_func, "Set unpaired electrons",
-                            WhatChanged::MOLECULE);
+    doCommandUsingDeltas(cmd_func, "Set unpaired electrons",
+                         getTagsForAtoms(atoms), {});
 }
 
 void MolModel::toggleExplicitHsOnAtoms(
@@ -2505,6 +3317,16 @@ AtomTag MolModel::getTagForAtom(const RDKit::Atom* const atom,
     return AtomTag(atom->getProp<int>(TAG_PROPERTY));
 }
 
+std::unordered_set<AtomTag> MolModel::getTagsForAtoms(
+    const std::unordered_set<const RDKit::Atom*>& atoms) const
+{
+    std::unordered_set<AtomTag> atom_tags;
+    for (auto* atom : atoms) {
+        atom_tags.insert(getTagForAtom(atom));
+    }
+    return atom_tags;
+}
+
 void MolModel::setTagForBond(RDKit::Bond* const bond, const BondTag bond_tag)
 {
     m_mol.setBondBookmark(bond, bond_tag);
@@ -3114,10 +3936,12 @@ void MolModel::setCoordinates(
                                     "the same size");
     }
 
+    std::unordered_set<const RDKit::Atom*> moved_atoms;
     for (auto const& [cur_tag, cur_coords] :
          boost::combine(atom_tags, atom_coords)) {
         RDKit::Atom* atom = m_mol.getUniqueAtomWithBookmark(cur_tag);
         m_mol.getConformer().setAtomPos(atom->getIdx(), cur_coords);
+        moved_atoms.insert(atom);
     }
     for (auto const& [cur_non_mol_tag, cur_coords] :
          boost::combine(non_mol_tags, non_mol_coords)) {
@@ -3127,10 +3951,13 @@ void MolModel::setCoordinates(
 
     // update_molecule_on_change handles stereochemistry perception, CIP label
     // assignment, and S-group bracket updates. This ensures stereo labels
-    // update in real-time as atoms are moved (SKETCH-2590).
-    update_molecule_on_change(m_mol);
+    // update in real-time as atoms are moved (SKETCH-2590). Only the moved
+    // atoms' components can have changed CIP labels.
+    update_molecule_on_change(m_mol, moved_atoms, {});
+    m_mol_snapshot = nullptr;
 
-    emit coordinatesChanged();
+    m_deferred_signals.coordinates_changed = true;
+    emitDeferredSignals();
 }
 
 void MolModel::clearCommandFunc()
@@ -3184,7 +4011,8 @@ void MolModel::setSelectionCommandFunc(
             m_selected_non_molecular_tags.erase(cur_tag);
         }
     }
-    emit selectionChanged();
+    m_deferred_signals.selection_changed = true;
+    emitDeferredSignals();
 }
 
 static std::vector<unsigned int>
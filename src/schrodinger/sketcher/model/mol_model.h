@@ -15,6 +15,7 @@
 #include <rdkit/GraphMol/RWMol.h>
 #include <rdkit/GraphMol/QueryAtom.h>
 #include <rdkit/GraphMol/QueryBond.h>
+#include <QTimer>
 #include <QUndoStack>
 
 #include "schrodinger/rdkit_extensions/file_format.h"
@@ -105,7 +106,10 @@ struct HighlightingInfo {
  * A copy of a MolModel state
  */
 struct MolModelSnapshot {
-    RDKit::RWMol m_mol;
+    // nullptr if the snapshot was taken for a command that doesn't change the
+    // molecule. Otherwise the copy is shared with every other snapshot of the
+    // same molecule, so it must never be modified.
+    std::shared_ptr<const RDKit::RWMol> m_mol;
     std::vector<NonMolecularObject> m_pluses;
     std::optional<NonMolecularObject> m_arrow;
     std::unordered_set<AtomTag> m_selected_atom_tags;
@@ -115,7 +119,8 @@ struct MolModelSnapshot {
     std::vector<HighlightingInfo> m_highlighting_info;
 
     MolModelSnapshot(
-        const RDKit::RWMol& mol, const std::vector<NonMolecularObject>& pluses,
+        const std::shared_ptr<const RDKit::RWMol>& mol,
+        const std::vector<NonMolecularObject>& pluses,
         const std::optional<NonMolecularObject>& arrow,
         const std::unordered_set<AtomTag>& selected_atom_tags,
         const std::unordered_set<BondTag>& selected_bond_tags,
@@ -130,6 +135,54 @@ struct MolModelSnapshot {
     bool isSelectionIdentical(const MolModelSnapshot& other);
 };
 
+/**
+ * The atoms and bonds changed by a MolModel command, stored as their state
+ * before and after the command.  Unlike MolModelSnapshot, this doesn't copy the
+ * unchanged parts of the molecule.
+ */
+struct MolModelDelta {
+    struct AtomState {
+        AtomTag tag;
+        unsigned int index;
+        // a copy of the atom, which must never be modified
+        std::shared_ptr<RDKit::Atom> atom;
+        RDGeom::Point3D coords;
+    };
+    struct BondState {
+        BondTag tag;
+        unsigned int index;
+        // a copy of the bond, which must never be modified
+        std::shared_ptr<RDKit::Bond> bond;
+        AtomTag begin_atom_tag;
+        AtomTag end_atom_tag;
+    };
+    struct StereoGroupState {
+        RDKit::StereoGroupType type;
+        std::vector<AtomTag> atom_tags;
+        std::vector<BondTag> bond_tags;
+        unsigned int read_id;
+        unsigned int write_id;
+
+        bool operator==(const StereoGroupState& other) const = default;
+    };
+    struct State {
+        // both sorted by index
+        std::vector<AtomState> atoms;
+        std::vector<BondState> bonds;
+        // all stereo groups of the molecule, or std::nullopt if the command
+        // didn't change them
+        std::optional<std::vector<StereoGroupState>> stereo_groups;
+    };
+    State before;
+    State after;
+
+    /**
+     * @return the number of atoms, bonds, and stereo groups stored in this
+     * delta
+     */
+    size_t size() const;
+};
+
 /**
  * A model for making undoable changes to an RDKit Mol using a QUndoStack.
  * Note that all public methods in this class should fall into one of two
@@ -164,6 +217,59 @@ class SKETCHER_API MolModel : public AbstractUndoableModel
   public:
     MolModel(QUndoStack* const undo_stack = nullptr, QObject* parent = nullptr);
 
+    /**
+     * An RAII class that defers the modelChanged, coordinatesChanged,
+     * selectionChanged, reactionArrowAdded, and newMoleculeAdded signals until
+     * it's destroyed.  Deferred signals are merged, so each one is emitted at
+     * most once, and modelChanged is emitted with the union of all changes.
+     * Commands in an undo macro are coalesced the same way without needing
+     * this class, so it's only needed to group commands that aren't part of a
+     * macro.  Instances may be nested, in which case the signals are emitted
+     * once the outermost instance is destroyed.
+     */
+    class SignalCoalescer
+    {
+      public:
+        SignalCoalescer(MolModel* mol_model);
+        ~SignalCoalescer();
+
+        // make sure we don't inadvertently create a copy of this object
+        SignalCoalescer(const SignalCoalescer&) = delete;
+        SignalCoalescer& operator=(const SignalCoalescer&) = delete;
+
+      protected:
+        MolModel* m_mol_model;
+    };
+
+    /**
+     * Limit the memory used by the undo history.  The size of the history is
+     * measured as the total number of atoms and bonds in all molecule
+     * snapshots it holds.  Once a command that changes the molecule finds the
+     * history over this size, this model's oldest commands are discarded until
+     * it fits again.  Discarded commands stay on the undo stack, so that
+     * commands from other models remain undoable, but undoing or redoing them
+     * does nothing.  The new command itself is always undoable.
+     *
+     * Adding, removing, and mutating atoms and bonds only stores the changed
+     * atoms and bonds (see MolModelDelta), which count towards the history
+     * size instead.  Other edits, as well as any edit of a monomeric molecule,
+     * still store a snapshot of the whole molecule, so each of them adds the
+     * size of the molecule to the history.
+     *
+     * @param max_size The maximum history size, or 0 for no limit
+     */
+    void setMaxUndoHistorySize(const size_t max_size);
+
+    /**
+     * Assign the CIP labels of large molecules, which are deferred when the
+     * molecule changes since CIP labeling scales poorly with molecule size.
+     * modelChanged is emitted if any labels were deferred.  This is called
+     * automatically once the model has gone DEFERRED_CIP_LABELS_DELAY_MS
+     * without changes, so it only needs to be called directly when the labels
+     * are needed right away.
+     */
+    void assignDeferredCIPLabels();
+
     /******************************** GETTERS *******************************/
 
     /**
@@ -171,6 +277,23 @@ class SKETCHER_API MolModel : public AbstractUndoableModel
      */
     const RDKit::ROMol* getMol() const;
 
+    /**
+     * Find the atom tag for the specified atom.  The passed in value must not
+     * be nullptr.
+     * @param atom The atom to get the tag for
+     * @param allow_null If this is true, return -1 if the nullptr is passed in.
+     * Otherwise, raise an exception
+     */
+    AtomTag getTagForAtom(const RDKit::Atom* const atom,
+                          const bool allow_null = false) const;
+
+    /**
+     * @return the bond tag for the specified bond. If a bond represents
+     * multiple connections (which can only occur in monomeric models), this
+     * will return the tag for the primary connection.
+     */
+    BondTag getTagForBond(const RDKit::Bond* const bond) const;
+
     /**
      * @return the copy of the RDKit molecule with all internal MolModel
      * properties removed
@@ -659,6 +782,28 @@ class SKETCHER_API MolModel : public AbstractUndoableModel
                       const std::unordered_set<const NonMolecularObject*>&
                           non_molecular_objects = {});
 
+    /**
+     * Begin a transient transform, e.g. for the length of a mouse drag.  Until
+     * finishTransientTransform is called, rotateByAngle and translateByVector
+     * move atoms and non-molecular objects without issuing undo commands, and
+     * emit transientCoordinatesChanged instead of coordinatesChanged.
+     * Stereochemistry is only updated while moving part of a molecule, since
+     * moving entire molecules can't change it.
+     */
+    void beginTransientTransform();
+
+    /**
+     * Finish the current transient transform, if any, by issuing a single undo
+     * command that moves everything that was transformed from its initial
+     * coordinates to its current ones
+     */
+    void finishTransientTransform();
+
+    /**
+     * @return whether a transient transform is in progress
+     */
+    bool isInTransientTransform() const;
+
     /**
      * Combine pairs of atoms into single atoms with all bonds from both
      * original atoms.  This is typically used to merge overlapping atoms at the
@@ -1000,6 +1145,20 @@ class SKETCHER_API MolModel : public AbstractUndoableModel
      */
     void coordinatesChanged();
 
+    /**
+     * Signal emitted instead of coordinatesChanged when coordinates are changed
+     * during a transient transform (see beginTransientTransform)
+     *
+     * @param atoms the atoms that need their graphics updated, i.e. the moved
+     * atoms plus, when only part of a molecule was moved, the rest of that
+     * molecule
+     * @param non_molecular_objects the moved non-molecular objects
+     */
+    void transientCoordinatesChanged(
+        const std::unordered_set<const RDKit::Atom*>& atoms,
+        const std::unordered_set<const NonMolecularObject*>&
+            non_molecular_objects);
+
     /**
      * Signal emitted when selection is changed.  Note that atoms, bonds, and
      * non-molecular objects will automatically be deselected when they are
@@ -1038,6 +1197,61 @@ class SKETCHER_API MolModel : public AbstractUndoableModel
 
     std::vector<HighlightingInfo> m_highlighting_info;
 
+    // The copy of m_mol returned by getMolSnapshot, or nullptr if m_mol has
+    // changed since the copy was made
+    std::shared_ptr<const RDKit::RWMol> m_mol_snapshot;
+    // The total number of atoms and bonds in all molecule snapshots that are
+    // still alive.  Shared with the snapshots, which may outlive this model
+    // when the undo stack is destroyed after it.
+    std::shared_ptr<size_t> m_undo_history_size;
+    size_t m_max_undo_history_size;
+
+    // restarted on every change while the molecule has deferred CIP labels;
+    // see assignDeferredCIPLabels
+    QTimer m_deferred_CIP_labels_timer;
+
+    /**
+     * The state of a transient transform; see beginTransientTransform
+     */
+    struct TransientTransform {
+        QString description;
+        // the coordinates of every transformed object before the transform
+        std::unordered_map<AtomTag, RDGeom::Point3D> initial_atom_coords;
+        std::unordered_map<NonMolecularTag, RDGeom::Point3D>
+            initial_non_mol_coords;
+        // the atoms that were last moved, and all atoms in their molecules
+        std::unordered_set<const RDKit::Atom*> moved_atoms;
+        std::unordered_set<const RDKit::Atom*> moved_molecule_atoms;
+    };
+    std::optional<TransientTransform> m_transient_transform;
+
+    /**
+     * Signals that have been deferred while in an undo macro or while a
+     * SignalCoalescer exists
+     */
+    struct DeferredSignals {
+        WhatChangedType what_changed = WhatChanged::NOTHING;
+        bool coordinates_changed = false;
+        bool selection_changed = false;
+        bool reaction_arrow_added = false;
+        bool new_molecule_added = false;
+    };
+    DeferredSignals m_deferred_signals;
+    // the number of undo macros and SignalCoalescers that are currently
+    // deferring signals
+    int m_signal_deferral_depth = 0;
+
+    /**
+     * Emit all deferred signals, unless signals are still being deferred.
+     * Commands record the signals they need in m_deferred_signals and then
+     * call this method instead of emitting the signals directly.
+     */
+    void emitDeferredSignals();
+
+    // Overridden AbstractUndoableModel methods
+    void onUndoMacroStarted() override;
+    void onUndoMacroFinished() override;
+
     /**
      * create an empty conformer for m_mol so it's ready to be used by other
      * functions. This is called in the constructor and whenever the model is
@@ -1067,6 +1281,18 @@ class SKETCHER_API MolModel : public AbstractUndoableModel
         std::unordered_set<const NonMolecularObject*> non_molecular_objects =
             {});
 
+    /**
+     * Transform the given coordinates as part of the current transient
+     * transform.  See transformCoordinatesWithFunction for param
+     * documentation.
+     */
+    void transformCoordinatesTransiently(
+        const QString& desc,
+        const std::function<void(RDGeom::Point3D&)>& function,
+        const std::unordered_set<const RDKit::Atom*>& atoms,
+        const std::unordered_set<const NonMolecularObject*>&
+            non_molecular_objects);
+
     void addExplicitHs(const std::unordered_set<const RDKit::Atom*>& atoms);
     void removeExplicitHs(const std::unordered_set<const RDKit::Atom*>& atoms);
 
@@ -1082,14 +1308,10 @@ class SKETCHER_API MolModel : public AbstractUndoableModel
     void setTagForAtom(RDKit::Atom* const atom, const AtomTag atom_tag);
 
     /**
-     * Find the atom tag for the specified atom.  The passed in value must not
-     * be nullptr.
-     * @param atom The atom to get the tag for
-     * @param allow_null If this is true, return -1 if the nullptr is passed in.
-     * Otherwise, raise an exception
+     * @return the atom tags for the specified atoms
      */
-    AtomTag getTagForAtom(const RDKit::Atom* const atom,
-                          const bool allow_null = false) const;
+    std::unordered_set<AtomTag>
+    getTagsForAtoms(const std::unordered_set<const RDKit::Atom*>& atoms) const;
 
     /**
      * Set the bond tag for the specified bond. If a bond represents multiple
@@ -1098,13 +1320,6 @@ class SKETCHER_API MolModel : public AbstractUndoableModel
      */
     void setTagForBond(RDKit::Bond* const bond, const BondTag bond_tag);
 
-    /**
-     * @return the bond tag for the specified bond. If a bond represents
-     * multiple connections (which can only occur in monomeric models), this
-     * will return the tag for the primary connection.
-     */
-    BondTag getTagForBond(const RDKit::Bond* const bond) const;
-
     /**
      * Set the bond tag for the secondary connection of the specified bond.
      * Secondary connections are only found in monomeric models, and occur when
@@ -1288,7 +1503,8 @@ class SKETCHER_API MolModel : public AbstractUndoableModel
      * @param to_be_changed Whether do_func updates the RDKit molecule,
      * the non-molecular objects, or both.  If this value includes
      * WhatChanged::MOLECULE, then update_molecule_on_change() will be called
-     * automatically after do_func is executed.  If this value includes
+     * automatically after do_func is executed, with the atoms and bonds that
+     * do_func changed.  If this value includes
      * WhatChanged::NON_MOL_OBJS, then updateNonMolecularMetadata() will be
      * called automatically.
      */
@@ -1297,9 +1513,87 @@ class SKETCHER_API MolModel : public AbstractUndoableModel
                                  const WhatChangedType to_be_changed);
 
     /**
+     * Do a command that only adds, removes, or changes the given atoms and
+     * bonds.  Only the state of those atoms and bonds before and after the
+     * command is stored (see MolModelDelta), so the cost of this command
+     * doesn't depend on the size of the rest of the molecule.  Commands on a
+     * monomeric molecule fall back to doCommandUsingSnapshots.  Note that
+     * doing, undoing, or redoing this command will invalidate all RDKit Atom
+     * and Bond objects.
+     *
+     * @param do_func The function to call for the initial do.  This function
+     * should not emit any signals, and it must not change any existing atoms or
+     * bonds other than the given ones, except for their stereo groups.  Atoms
+     * and bonds that it adds are stored automatically.
+     * @param description A description for the undo command
+     * @param atom_tags The tags of all existing atoms that do_func changes or
+     * removes.  Tags that aren't in the molecule are ignored.
+     * @param bond_tags The tags of all existing bonds that do_func changes or
+     * removes, including the bonds of removed atoms.  Tags that aren't in the
+     * molecule are ignored.
+     * @param to_be_changed What do_func changes, which must include
+     * WhatChanged::MOLECULE.  The non-molecular objects and the selection are
+     * stored using snapshots.
+     */
+    void doCommandUsingDeltas(
+        const std::function<void()> do_func, const QString& description,
+        const std::unordered_set<AtomTag>& atom_tags,
+        const std::unordered_set<BondTag>& bond_tags,
+        const WhatChangedType to_be_changed = WhatChanged::MOLECULE);
+
+    /**
+     * Discard the oldest commands of this model if the undo history is larger
+     * than the maximum size.  This should be called right after a command that
+     * changes the molecule is pushed.
+     */
+    void discardOldestCommandsIfTooLarge();
+
+    /**
+     * @return copies of the given atoms and bonds, along with all atoms and
+     * bonds whose tags are at least first_new_atom_tag and first_new_bond_tag,
+     * respectively, i.e. the ones added by the current command.  Tags that
+     * aren't in the molecule are ignored.
+     */
+    MolModelDelta::State
+    getDeltaState(const std::unordered_set<AtomTag>& atom_tags,
+                  const std::unordered_set<BondTag>& bond_tags,
+                  const AtomTag first_new_atom_tag,
+                  const BondTag first_new_bond_tag) const;
+
+    /**
+     * @return the stereo groups of the molecule, with atoms and bonds stored as
+     * tags
+     */
+    std::vector<MolModelDelta::StereoGroupState> getStereoGroupStates() const;
+
+    /**
+     * Update the molecule from one state of a MolModelDelta to the other.  The
+     * molecule must currently be in the from state for all atoms and bonds in
+     * the delta.  Atoms and bonds end up at the same indices they had when the
+     * to state was recorded.
+     */
+    void applyDeltaState(const MolModelDelta::State& from,
+                         const MolModelDelta::State& to);
+
+    /**
+     * Call update_molecule_on_change for the atoms and bonds of the given
+     * states, as well as the atoms bound to those bonds.
+     */
+    void updateMoleculeForDeltaStates(const MolModelDelta::State& from,
+                                      const MolModelDelta::State& to);
+
+    /**
+     * @param what_changed What the command the snapshot is taken for changes.
+     * The molecule is only copied if this includes WhatChanged::MOLECULE.
      * @return a copy of the MolModel state
      */
-    MolModelSnapshot takeSnapshot() const;
+    MolModelSnapshot takeSnapshot(const WhatChangedType what_changed);
+
+    /**
+     * @return a copy of m_mol.  The copy is only made once for as long as m_mol
+     * doesn't change, and is shared by all snapshots taken in the meantime.
+     */
+    std::shared_ptr<const RDKit::RWMol> getMolSnapshot();
 
     /**
      * Update the current MolModel state to match the provided snapshot
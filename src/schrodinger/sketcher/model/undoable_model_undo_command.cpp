@@ -18,7 +18,7 @@ template <typename T>
 AbstractUndoableModelUndoCommand<T>::AbstractUndoableModelUndoCommand(
     AbstractUndoableModel* const model, const T& redo, const T& undo,
     const QString& description, QUndoCommand* parent) :
-    QUndoCommand(description, parent),
+    DiscardableUndoCommand(description, parent),
     m_model(model),
     m_redo(redo),
     m_undo(undo)
@@ -35,9 +35,25 @@ template <typename T> void AbstractUndoableModelUndoCommand<T>::undo()
     do_func(m_undo);
 }
 
+template <typename T> const AbstractUndoableModel*
+AbstractUndoableModelUndoCommand<T>::getModel() const
+{
+    return m_model;
+}
+
+template <typename T> void AbstractUndoableModelUndoCommand<T>::discard()
+{
+    m_redo = nullptr;
+    m_undo = nullptr;
+}
+
 template <typename T>
 void AbstractUndoableModelUndoCommand<T>::do_func(const T& func)
 {
+    if (!func) {
+        // the command has been discarded
+        return;
+    }
     bool signals_blocked = m_model->blockSignals(false);
     bool was_allowing_edits = m_model->m_allow_edits;
     m_model->m_allow_edits = true;
@@ -15,12 +15,33 @@ namespace sketcher
 
 class AbstractUndoableModel;
 
+/**
+ * An interface for all commands created by an AbstractUndoableModel, which
+ * allows the model to find its own commands on a shared undo stack
+ */
+class SKETCHER_API DiscardableUndoCommand : public QUndoCommand
+{
+  public:
+    using QUndoCommand::QUndoCommand;
+
+    /**
+     * @return the model that created this command
+     */
+    virtual const AbstractUndoableModel* getModel() const = 0;
+
+    /**
+     * Release the redo and undo functions, along with any data that they hold.
+     * Redoing or undoing the command does nothing afterwards.
+     */
+    virtual void discard() = 0;
+};
+
 /**
  * A base class for code shared by UndoableModelUndoCommand and
  * UndoableModelMergeableUndoCommand
  */
 template <typename T> class SKETCHER_API AbstractUndoableModelUndoCommand
-    : public QUndoCommand
+    : public DiscardableUndoCommand
 {
   public:
     /**
@@ -40,9 +61,14 @@ template <typename T> class SKETCHER_API AbstractUndoableModelUndoCommand
     void redo() override;
     void undo() override;
 
+    // overridden DiscardableUndoCommand methods
+    const AbstractUndoableModel* getModel() const override;
+    void discard() override;
+
   protected:
     /**
-     * Run the specified function.  While the function is being run, signals
+     * Run the specified function.  Nothing is run if the command has been
+     * discarded.  While the function is being run, signals
      * will be unblocked on the associated AbstractUndoableModel instance.
      * AbstractUndoableModel::m_allow_edits will also be updated so that
      * AbstractUndoableModel can catch commands that create commands (which
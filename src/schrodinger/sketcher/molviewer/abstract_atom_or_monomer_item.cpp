@@ -17,5 +17,10 @@ const RDKit::Atom* AbstractAtomOrMonomerItem::getAtom() const
     return m_atom;
 }
 
+void AbstractAtomOrMonomerItem::setAtom(const RDKit::Atom* atom_or_monomer)
+{
+    m_atom = atom_or_monomer;
+}
+
 } // namespace sketcher
 } // namespace schrodinger
@@ -28,19 +28,26 @@ class SKETCHER_API AbstractAtomOrMonomerItem : public AbstractGraphicsItem
      */
     const RDKit::Atom* getAtom() const;
 
+    /**
+     * Associate this item with a different RDKit atom, e.g. an identical atom
+     * in a copy of the molecule.  If the new atom should be drawn differently,
+     * updateCachedData must be called afterwards.
+     */
+    void setAtom(const RDKit::Atom* atom_or_monomer);
+
   protected:
     // Creating a shared_ptr to an RDKit Atom (or Bond) implicitly creates a
     // copy of the Atom, which means that the new Atom is no longer part of the
     // original molecule, which leads to problems.  Because of this, we store a
     // raw pointer instead.  The RDKit molecule takes care of the lifetime of
-    // the Atom, so the graphics item instance must be deleted as soon as its
-    // associated Atom is deleted.
+    // the Atom, so the graphics item instance must be deleted (or given a new
+    // Atom using setAtom) as soon as its associated Atom is deleted.
     //
     // Also note that m_atom should only be accessed from within
     // updateCachedData to ensure that we can properly notify the scene of any
     // changes *before* they happen.
 
-    const RDKit::Atom* const m_atom;
+    const RDKit::Atom* m_atom;
 };
 
 } // namespace sketcher
@@ -19,6 +19,11 @@ const RDKit::Bond* AbstractBondOrConnectorItem::getBond() const
     return m_bond;
 }
 
+void AbstractBondOrConnectorItem::setBond(const RDKit::Bond* bond)
+{
+    m_bond = bond;
+}
+
 QPointF AbstractBondOrConnectorItem::getMidpoint() const
 {
     return m_midpoint;
@@ -30,6 +30,13 @@ class SKETCHER_API AbstractBondOrConnectorItem : public AbstractGraphicsItem
      */
     const RDKit::Bond* getBond() const;
 
+    /**
+     * Associate this item with a different RDKit bond, e.g. an identical bond
+     * in a copy of the molecule.  If the new bond should be drawn differently,
+     * updateCachedData must be called afterwards.
+     */
+    void setBond(const RDKit::Bond* bond);
+
     /**
      * @return the mid point of the bond (in local coordinates)
      */
@@ -40,13 +47,13 @@ class SKETCHER_API AbstractBondOrConnectorItem : public AbstractGraphicsItem
     // copy of the Bond, which means that the new Bond is no longer part of the
     // original molecule, which leads to problems. Because of this, we store a
     // raw pointer instead. The RDKit molecule takes care of the lifetime of the
-    // Bond, so a BondItem instance must be deleted as soon as its associated
-    // Bond is deleted.
+    // Bond, so a BondItem instance must be deleted (or given a new Bond using
+    // setBond) as soon as its associated Bond is deleted.
     //
     // Also note that m_bond should only be accessed from within
     // updateCachedData to ensure that we can properly notify the scene of any
     // BondItem changes *before* they happen.
-    const RDKit::Bond* const m_bond;
+    const RDKit::Bond* m_bond;
 
     /**
      * The midpoint of the bond, which is used to determine whether the bond is
@@ -1,6 +1,8 @@
 #include "schrodinger/sketcher/molviewer/abstract_graphics_item.h"
 
+#include <QPainter>
 #include <QRectF>
+#include <QStyleOptionGraphicsItem>
 
 namespace schrodinger
 {
@@ -33,5 +35,27 @@ QPainterPath AbstractGraphicsItem::predictiveHighlightingPath() const
     return QPainterPath(m_predictive_highlighting_path);
 }
 
+void AbstractGraphicsItem::setLargeMoleculeMode(const bool large_molecule_mode)
+{
+    if (large_molecule_mode != m_large_molecule_mode) {
+        m_large_molecule_mode = large_molecule_mode;
+        update();
+    }
+}
+
+bool AbstractGraphicsItem::isSimplifiedAtLevelOfDetail(
+    const QPainter* painter) const
+{
+    auto level_of_detail = getLevelOfDetail(painter);
+    return m_large_molecule_mode &&
+           level_of_detail < LARGE_MOLECULE_SIMPLIFIED_LEVEL_OF_DETAIL;
+}
+
+qreal AbstractGraphicsItem::getLevelOfDetail(const QPainter* painter)
+{
+    return QStyleOptionGraphicsItem::levelOfDetailFromTransform(
+        painter->worldTransform());
+}
+
 } // namespace sketcher
 } // namespace schrodinger
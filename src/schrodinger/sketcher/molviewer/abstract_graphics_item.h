@@ -3,6 +3,8 @@
 #include <QGraphicsItem>
 #include <QPainterPath>
 
+class QPainter;
+
 #include "schrodinger/sketcher/definitions.h"
 #include "schrodinger/sketcher/molviewer/constants.h"
 
@@ -44,7 +46,27 @@ class SKETCHER_API AbstractGraphicsItem : public QGraphicsItem
      */
     QPainterPath predictiveHighlightingPath() const;
 
+    /**
+     * Set whether this item is part of a molecule that the scene displays in
+     * large-molecule mode, in which a simplified version of the molecule is
+     * painted when zoomed out.  See LARGE_MOLECULE_ATOM_THRESHOLD.
+     */
+    void setLargeMoleculeMode(const bool large_molecule_mode);
+
   protected:
+    /**
+     * @return whether this item is painted in its simplified form at the level
+     * of detail of the given painter.  In this case, AtomItem skips painting
+     * and BondItem only paints a line between the atom centers.
+     */
+    bool isSimplifiedAtLevelOfDetail(const QPainter* painter) const;
+
+    /**
+     * @return the level of detail (i.e. the on-screen scale) that the given
+     * painter paints at
+     */
+    static qreal getLevelOfDetail(const QPainter* painter);
+
     // Type integers for all AbstractGraphicsItem subclasses
     enum class ItemType {
         ATOM = static_cast<int>(GraphicsItemType::ABSTRACT_GRAPHICS_ITEM_BASE),
@@ -74,6 +96,9 @@ class SKETCHER_API AbstractGraphicsItem : public QGraphicsItem
     /// The path to be returned from predictiveHighlightingPath().  Subclasses
     /// are responsible for keeping this value up to date.
     QPainterPath m_predictive_highlighting_path;
+
+    /// Whether this item is displayed in large-molecule mode
+    bool m_large_molecule_mode = false;
 };
 
 } // namespace sketcher
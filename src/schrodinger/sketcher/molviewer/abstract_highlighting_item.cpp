@@ -4,6 +4,8 @@
 #include <vector>
 
 #include <QList>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
 
 namespace schrodinger
 {
@@ -14,18 +16,21 @@ AbstractHighlightingItem::AbstractHighlightingItem() : QGraphicsPathItem()
 {
     // nothing is highlighted yet, so there's no need to paint this
     setVisible(false);
-}
-
-void AbstractHighlightingItem::setHighlightingPath(const QPainterPath& path)
-{
-    // note that setPath is a no-op if path == the current path
-    setPath(path);
-    setVisible(!path.isEmpty());
+    // we need the exposed rect to skip paths that don't need to be repainted
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
 }
 
 void AbstractHighlightingItem::clearHighlightingPath()
 {
-    setHighlightingPath(QPainterPath());
+    if (m_item_highlighting.empty()) {
+        return;
+    }
+    prepareGeometryChange();
+    m_item_highlighting.clear();
+    m_paths_rect = QRectF();
+    m_merged_path = QPainterPath();
+    m_merged_path_is_valid = true;
+    setVisible(false);
 }
 
 void AbstractHighlightingItem::highlightItem(const QGraphicsItem* const item)
@@ -47,8 +52,53 @@ void AbstractHighlightingItem::highlightItems(
     const QList<const QGraphicsItem*>& items)
 {
     auto updated_items = updateItemsToHighlight(items);
-    QPainterPath path = buildHighlightingPathForItems(updated_items);
-    setHighlightingPath(path);
+    std::unordered_map<const QGraphicsItem*, ItemHighlighting>
+        item_highlighting;
+    item_highlighting.reserve(updated_items.size());
+    // the Scene rects that need to be repainted
+    std::vector<QRectF> changed_rects;
+    for (auto item : updated_items) {
+        auto* molviewer_item = dynamic_cast<const AbstractGraphicsItem*>(item);
+        if (molviewer_item == nullptr || item_highlighting.count(item)) {
+            continue;
+        }
+        // the path is implicitly shared with the item, so comparing it against
+        // the cached path is cheap when it hasn't changed
+        auto local_path = getPathForItem(molviewer_item);
+        auto transform = item->sceneTransform();
+        auto cached = m_item_highlighting.find(item);
+        if (cached != m_item_highlighting.end() &&
+            cached->second.local_path == local_path &&
+            cached->second.transform == transform) {
+            item_highlighting.insert(m_item_highlighting.extract(cached));
+            continue;
+        }
+        auto scene_path = transform.map(local_path);
+        auto rect = scene_path.boundingRect();
+        changed_rects.push_back(rect);
+        item_highlighting.emplace(
+            item, ItemHighlighting{local_path, transform, scene_path, rect});
+    }
+    // anything left over is no longer highlighted
+    for (const auto& [item, highlighting] : m_item_highlighting) {
+        changed_rects.push_back(highlighting.rect);
+    }
+    m_item_highlighting = std::move(item_highlighting);
+    if (changed_rects.empty()) {
+        return;
+    }
+
+    m_merged_path_is_valid = false;
+    auto paths_rect = getPathsRect();
+    if (paths_rect != m_paths_rect) {
+        prepareGeometryChange();
+        m_paths_rect = paths_rect;
+    }
+    auto margin = getOutlinePen().widthF() / 2;
+    for (const auto& rect : changed_rects) {
+        update(rect.adjusted(-margin, -margin, margin, margin));
+    }
+    setVisible(!m_item_highlighting.empty());
 }
 
 QList<const QGraphicsItem*> AbstractHighlightingItem::updateItemsToHighlight(
@@ -78,20 +128,93 @@ QPainterPath merge_paths(const std::vector<QPainterPath>& paths,
     return left | right;
 }
 
-QPainterPath AbstractHighlightingItem::buildHighlightingPathForItems(
-    const QList<const QGraphicsItem*>& items) const
+QRectF AbstractHighlightingItem::boundingRect() const
+{
+    if (m_paths_rect.isNull()) {
+        return QRectF();
+    }
+    auto margin = getOutlinePen().widthF() / 2;
+    return m_paths_rect.adjusted(-margin, -margin, margin, margin);
+}
+
+QPainterPath AbstractHighlightingItem::shape() const
+{
+    // the paths are only added, not merged, since the shape is only used for
+    // collision detection
+    QPainterPath shape;
+    shape.setFillRule(Qt::WindingFill);
+    for (const auto& [item, highlighting] : m_item_highlighting) {
+        shape.addPath(highlighting.scene_path);
+    }
+    return shape;
+}
+
+void AbstractHighlightingItem::paint(QPainter* painter,
+                                     const QStyleOptionGraphicsItem* option,
+                                     QWidget* widget)
 {
-    std::vector<QPainterPath> paths;
-
-    for (auto item : items) {
-        if (auto* molviewer_item =
-                dynamic_cast<const AbstractGraphicsItem*>(item)) {
-            auto local_path = getPathForItem(molviewer_item);
-            auto scene_path = molviewer_item->mapToScene(local_path);
-            paths.push_back(scene_path);
+    if (pen().color().alpha() < 255 || !brush().isOpaque()) {
+        // overlapping paths would be visible through a translucent brush, so
+        // we have to paint the merged path instead
+        painter->setPen(pen());
+        painter->setBrush(brush());
+        painter->drawPath(getMergedPath());
+        return;
+    }
+
+    auto outline_pen = getOutlinePen();
+    auto margin = outline_pen.widthF() / 2;
+    auto exposed_rect =
+        option->exposedRect.adjusted(-margin, -margin, margin, margin);
+    std::vector<const QPainterPath*> exposed_paths;
+    for (const auto& [item, highlighting] : m_item_highlighting) {
+        if (exposed_rect.intersects(highlighting.rect)) {
+            exposed_paths.push_back(&highlighting.scene_path);
         }
     }
-    return merge_paths(paths, 0, paths.size());
+    // paint all of the outlines before any of the fills so that the fills
+    // cover the outlines wherever paths overlap, which makes the result look
+    // the same as painting the merged path
+    painter->setPen(outline_pen);
+    painter->setBrush(Qt::NoBrush);
+    for (auto* path : exposed_paths) {
+        painter->drawPath(*path);
+    }
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(brush());
+    for (auto* path : exposed_paths) {
+        painter->drawPath(*path);
+    }
+}
+
+const QPainterPath& AbstractHighlightingItem::getMergedPath() const
+{
+    if (!m_merged_path_is_valid) {
+        std::vector<QPainterPath> paths;
+        paths.reserve(m_item_highlighting.size());
+        for (const auto& [item, highlighting] : m_item_highlighting) {
+            paths.push_back(highlighting.scene_path);
+        }
+        m_merged_path = merge_paths(paths, 0, paths.size());
+        m_merged_path_is_valid = true;
+    }
+    return m_merged_path;
+}
+
+QPen AbstractHighlightingItem::getOutlinePen() const
+{
+    auto outline_pen = pen();
+    outline_pen.setWidthF(outline_pen.widthF() * 2);
+    return outline_pen;
+}
+
+QRectF AbstractHighlightingItem::getPathsRect() const
+{
+    QRectF paths_rect;
+    for (const auto& [item, highlighting] : m_item_highlighting) {
+        paths_rect |= highlighting.rect;
+    }
+    return paths_rect;
 }
 
 } // namespace sketcher
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <unordered_map>
+
 #include <QGraphicsPathItem>
 #include <QPainterPath>
+#include <QPen>
+#include <QRectF>
+#include <QTransform>
 
 #include "schrodinger/sketcher/molviewer/abstract_graphics_item.h"
 
@@ -16,6 +21,11 @@ namespace sketcher
  * A Qt graphics item for drawing highlighting (either selection or predictive)
  * in a molviewer Scene.  Concrete subclasses must provide an implementation for
  * getPathForItem.
+ *
+ * The highlighting path of each item is cached and drawn separately instead of
+ * being merged into a single path, since merging paths is expensive for large
+ * selections.  When the highlighted items change, only the paths of the items
+ * that were added, removed, or modified are updated.
  */
 class AbstractHighlightingItem : public QGraphicsPathItem
 {
@@ -44,13 +54,26 @@ class AbstractHighlightingItem : public QGraphicsPathItem
      */
     void clearHighlightingPath();
 
+    // Overridden QGraphicsItem methods
+    QRectF boundingRect() const override;
+    QPainterPath shape() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option,
+               QWidget* widget = nullptr) override;
+
   protected:
     /**
-     * Update the path to be highlighted.  If the provided path is empty, then
-     * this graphics item will be hidden.  If the path is non-empty, then this
-     * graphics item will be shown.
+     * The cached highlighting for a single graphics item
      */
-    void setHighlightingPath(const QPainterPath& path);
+    struct ItemHighlighting {
+        /// the path returned from getPathForItem, in item coordinates
+        QPainterPath local_path;
+        /// the scene transform of the item when the path was cached
+        QTransform transform;
+        /// the highlighting path in Scene coordinates
+        QPainterPath scene_path;
+        /// the bounding rect of scene_path
+        QRectF rect;
+    };
 
     /**
      * Get the painter path to use for highlighting the specified graphics item.
@@ -68,10 +91,31 @@ class AbstractHighlightingItem : public QGraphicsPathItem
     updateItemsToHighlight(const QList<const QGraphicsItem*>& items) const;
 
     /**
-     * Create a painter path highlighting all specified graphics items.
+     * @return the union of all highlighting paths, which is only used to paint
+     * the highlighting when the pen or brush is translucent
+     */
+    const QPainterPath& getMergedPath() const;
+
+    /**
+     * @return the pen used to draw the outlines of the individual paths.  It's
+     * twice as wide as pen() since the inner half of each outline is covered
+     * by the highlighting's fill.
      */
-    QPainterPath buildHighlightingPathForItems(
-        const QList<const QGraphicsItem*>& items) const;
+    QPen getOutlinePen() const;
+
+    /**
+     * @return the union of the bounding rects of all cached highlighting paths
+     */
+    QRectF getPathsRect() const;
+
+    std::unordered_map<const QGraphicsItem*, ItemHighlighting>
+        m_item_highlighting;
+    // the value of getPathsRect() as of the last change, which doesn't include
+    // the outline
+    QRectF m_paths_rect;
+    // the union of all highlighting paths, which is calculated lazily
+    mutable QPainterPath m_merged_path;
+    mutable bool m_merged_path_is_valid = true;
 };
 
 } // namespace sketcher
@@ -99,6 +99,14 @@ class SKETCHER_API AtomDisplaySettings
 
     QColor m_valence_error_area_color = VALENCE_ERROR_AREA_COLOR;
 
+    /**
+     * When the main label font would be painted smaller than this many pixels,
+     * atom labels are painted as plain boxes instead of text, and valence
+     * error areas, attachment point squiggles, and query label lines are
+     * omitted.  Set to zero to always paint the full labels.
+     */
+    qreal m_min_label_pixel_size = DEFAULT_MIN_LABEL_PIXEL_SIZE;
+
     /**
      * The simplified stereo annotation to display, if any.  This is set by the
      * Scene when the display settings are changed and it is used by AtomItems
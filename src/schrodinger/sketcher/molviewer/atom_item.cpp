@@ -31,17 +31,17 @@ namespace sketcher
 {
 
 /**
- * @return a bounding rect of the given label for the given font metrics
+ * @return a bounding rect of the given label for the given font
  */
-QRectF make_text_rect(QFontMetricsF fm, QString label)
-
+static QRectF make_text_rect(const Fonts& fonts, const QFont& font,
+                             const QString& label)
 {
     // if the label is empty return an invalid QRectF
     if (label.isEmpty()) {
         return QRectF();
     }
 
-    auto rect = fm.tightBoundingRect(label);
+    auto rect = fonts.getTightBoundingRect(font, label);
     // add some margin around the text
     return rect.adjusted(-TEXT_RECT_MARGIN, -TEXT_RECT_MARGIN, TEXT_RECT_MARGIN,
                          TEXT_RECT_MARGIN);
@@ -143,7 +143,8 @@ void AtomItem::updateCachedData()
                            : m_settings.getAtomColor(m_atom->getAtomicNum()));
 
         m_main_label_rect =
-            make_text_rect(m_fonts.m_main_label_fm, m_main_label_text);
+            make_text_rect(m_fonts, m_fonts.m_main_label_font,
+                           m_main_label_text);
         m_main_label_rect.moveCenter(QPointF(0, 0));
         if (needs_additional_labels) {
             updateIsotopeLabel();
@@ -157,7 +158,8 @@ void AtomItem::updateCachedData()
     }
     if (!m_query_label_text.isEmpty()) {
         m_query_label_rect =
-            make_text_rect(m_fonts.m_query_label_fm, m_query_label_text);
+            make_text_rect(m_fonts, m_fonts.m_query_label_font,
+                           m_query_label_text);
         // find a position for the query label
         auto position =
             findPositionInEmptySpace(false) * QUERY_LABEL_DISTANCE_RATIO;
@@ -195,7 +197,8 @@ void AtomItem::updateCachedData()
             // width would make it look like SMARTS queries were placed further
             // away from the main label than other types of queries.
             qreal char_width =
-                m_fonts.m_query_label_fm.tightBoundingRect("A").width();
+                m_fonts.getTightBoundingRect(m_fonts.m_query_label_font, "A")
+                    .width();
             qreal translate_x_by =
                 (m_query_label_rect.width() - char_width) / 2;
             if (position.x() < 0) {
@@ -430,7 +433,8 @@ void AtomItem::updateChiralityLabel()
     // otherwise it will be considered as a rectangle to avoid
     auto new_position = findPositionInEmptySpace(true);
     m_chirality_label_rect =
-        make_text_rect(m_fonts.m_chirality_fm, m_chirality_label_text);
+        make_text_rect(m_fonts, m_fonts.m_chirality_font,
+                       m_chirality_label_text);
     // the center of the label is positioned r + k points away from the atom,
     // where r is radius of the circle around the label and k depends on the
     // bond length. This way the label remains at a fixed distance from the
@@ -450,13 +454,17 @@ void AtomItem::updateChiralityLabel()
 
 void AtomItem::clearLabels()
 {
-    for (auto string :
-         {m_main_label_text, m_charge_and_radical_label_text,
-          m_H_count_label_text, m_chirality_label_text, m_mapping_label_text}) {
-        string = QString();
-    }
-    for (auto rect : getLabelRects()) {
-        rect = QRectF();
+    for (auto* string :
+         {&m_main_label_text, &m_charge_and_radical_label_text,
+          &m_H_count_label_text, &m_chirality_label_text, &m_mapping_label_text,
+          &m_isotope_label_text, &m_query_label_text}) {
+        string->clear();
+    }
+    for (auto* rect :
+         {&m_main_label_rect, &m_mapping_label_rect, &m_isotope_label_rect,
+          &m_charge_and_radical_label_rect, &m_H_count_label_rect,
+          &m_H_label_rect, &m_chirality_label_rect, &m_query_label_rect}) {
+        *rect = QRectF();
     }
 }
 
@@ -477,7 +485,8 @@ void AtomItem::updateIsotopeLabel()
     if (isotope != 0) {
         m_isotope_label_text = QString::number(isotope);
         m_isotope_label_rect =
-            make_text_rect(m_fonts.m_subscript_fm, m_isotope_label_text);
+            make_text_rect(m_fonts, m_fonts.m_subscript_font,
+                           m_isotope_label_text);
     }
 }
 
@@ -488,7 +497,8 @@ void AtomItem::updateMappingLabel()
     if (mapping_n != 0) {
         m_mapping_label_text = QString("[%1]").arg(mapping_n);
         m_mapping_label_rect =
-            make_text_rect(m_fonts.m_mapping_fm, m_mapping_label_text);
+            make_text_rect(m_fonts, m_fonts.m_mapping_font,
+                           m_mapping_label_text);
     }
 }
 
@@ -569,8 +579,9 @@ void AtomItem::updateChargeAndRadicalLabel()
         charge_label;
     if (!text_label.isEmpty()) {
         m_charge_and_radical_label_text = text_label;
-        m_charge_and_radical_label_rect = make_text_rect(
-            m_fonts.m_subscript_fm, m_charge_and_radical_label_text);
+        m_charge_and_radical_label_rect =
+            make_text_rect(m_fonts, m_fonts.m_subscript_font,
+                           m_charge_and_radical_label_text);
     }
 }
 
@@ -580,16 +591,46 @@ void AtomItem::updateHsLabel()
     auto H_count = m_atom->getTotalNumHs(includeNeighbors);
 
     if (H_count > 0) {
-        m_H_label_rect = make_text_rect(m_fonts.m_main_label_fm, "H");
+        m_H_label_rect =
+            make_text_rect(m_fonts, m_fonts.m_main_label_font, "H");
     }
     if (H_count > 1) {
         m_H_count_label_text = QString::number(H_count);
         m_H_count_label_rect =
-            make_text_rect(m_fonts.m_subscript_fm, m_H_count_label_text);
+            make_text_rect(m_fonts, m_fonts.m_subscript_font,
+                           m_H_count_label_text);
     }
 }
 
 void AtomItem::positionLabels()
+{
+    auto H_direction = findHsDirection();
+    // the layout only depends on the label text and the direction of the Hs,
+    // so atoms with identical labels can share it
+    AtomLabelLayoutKey key{m_main_label_text,
+                           m_isotope_label_text,
+                           m_charge_and_radical_label_text,
+                           m_mapping_label_text,
+                           m_H_count_label_text,
+                           m_H_label_rect.isValid(),
+                           H_direction};
+    if (auto layout = m_fonts.getCachedAtomLabelLayout(key)) {
+        m_main_label_rect = layout->main_label_rect;
+        m_isotope_label_rect = layout->isotope_label_rect;
+        m_charge_and_radical_label_rect = layout->charge_and_radical_label_rect;
+        m_mapping_label_rect = layout->mapping_label_rect;
+        m_H_label_rect = layout->H_label_rect;
+        m_H_count_label_rect = layout->H_count_label_rect;
+        return;
+    }
+    positionLabelsInDirection(H_direction);
+    m_fonts.cacheAtomLabelLayout(
+        key, {m_main_label_rect, m_isotope_label_rect,
+              m_charge_and_radical_label_rect, m_mapping_label_rect,
+              m_H_label_rect, m_H_count_label_rect});
+}
+
+void AtomItem::positionLabelsInDirection(const HsDirection H_direction)
 {
     auto label_rect = m_main_label_rect;
     m_isotope_label_rect.translate(
@@ -610,7 +651,6 @@ void AtomItem::positionLabels()
     label_rect = label_rect.united(m_isotope_label_rect);
     label_rect = label_rect.united(m_mapping_label_rect);
 
-    auto H_direction = findHsDirection();
     // charge and radical text is next to the main label, on the right, unless
     // hydrogens are drawn to the right, in which case they come before charge
     // and radicals. (e.g. H3O+ but NH4+)
@@ -744,9 +784,25 @@ bool AtomItem::labelIsVisible() const
     return m_label_is_visible;
 }
 
+bool AtomItem::hasContentsToPaint() const
+{
+    return m_label_is_visible || m_valence_error_is_visible ||
+           !m_squiggle_path.isEmpty() || !m_query_label_text.isEmpty() ||
+           !m_chirality_label_text.isEmpty();
+}
+
 void AtomItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option,
                      QWidget* widget)
 {
+    if (isSimplifiedAtLevelOfDetail(painter)) {
+        // only the bonds are painted at this level of detail
+        return;
+    }
+    if (m_fonts.m_main_label_font.pixelSize() * getLevelOfDetail(painter) <
+        m_settings.m_min_label_pixel_size) {
+        paintSimplifiedLabels(painter);
+        return;
+    }
     if (m_valence_error_is_visible) {
         painter->save();
         painter->setPen(m_valence_error_pen);
@@ -819,6 +875,35 @@ void AtomItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option,
     }
 }
 
+void AtomItem::paintSimplifiedLabels(QPainter* painter)
+{
+    std::vector<QRectF> rects;
+    if (m_label_is_visible) {
+        rects = {m_main_label_rect,    m_H_label_rect,
+                 m_H_count_label_rect, m_charge_and_radical_label_rect,
+                 m_isotope_label_rect, m_mapping_label_rect};
+    }
+    if (!m_query_label_text.isEmpty()) {
+        rects.push_back(m_query_label_rect);
+    }
+    if (rects.empty()) {
+        return;
+    }
+    painter->save();
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(m_pen.color());
+    painter->setOpacity(SIMPLIFIED_LABEL_OPACITY);
+    for (const auto& rect : rects) {
+        if (rect.isValid()) {
+            // remove the margin that make_text_rect adds around the text
+            painter->drawRect(rect.adjusted(TEXT_RECT_MARGIN, TEXT_RECT_MARGIN,
+                                            -TEXT_RECT_MARGIN,
+                                            -TEXT_RECT_MARGIN));
+        }
+    }
+    painter->restore();
+}
+
 QPointF AtomItem::findPositionInEmptySpace(bool avoid_subrects) const
 {
     auto mol_positions = get_relative_positions_of_atom_neighbors(m_atom);
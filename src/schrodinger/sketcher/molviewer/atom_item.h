@@ -115,6 +115,12 @@ class SKETCHER_API AtomItem : public AbstractAtomOrMonomerItem
      */
     bool labelIsVisible() const;
 
+    /**
+     * @return whether paint() would paint anything for this atom.  This is
+     * false for most carbons, which are represented solely by their bonds.
+     */
+    bool hasContentsToPaint() const;
+
     QRectF getChiralityLabelRect() const;
     QString getChiralityLabelText() const;
 
@@ -254,10 +260,24 @@ class SKETCHER_API AtomItem : public AbstractAtomOrMonomerItem
 
     /**
      * position all the labels around the atom. Hs can be to the right, left,
-     * top or bottom depending on the binding pattern
+     * top or bottom depending on the binding pattern.  Layouts are cached in
+     * m_fonts, so atoms with identical labels only calculate them once.
      */
     void positionLabels();
 
+    /**
+     * paint each of the atom's text labels as a plain box.  This is used in
+     * place of the full labels when they would be painted too small to be
+     * legible.  See AtomDisplaySettings::m_min_label_pixel_size.
+     */
+    void paintSimplifiedLabels(QPainter* painter);
+
+    /**
+     * position all the labels around the atom with Hs drawn in the given
+     * direction, without using the layout cache
+     */
+    void positionLabelsInDirection(const HsDirection H_direction);
+
     /**
      * create and position labels (dots) for the unpaired electrons on this
      * atom (if any)
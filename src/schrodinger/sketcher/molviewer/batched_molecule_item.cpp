@@ -0,0 +1,246 @@
+#include "schrodinger/sketcher/molviewer/batched_molecule_item.h"
+
+#include <algorithm>
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QTransform>
+
+#include "schrodinger/sketcher/molviewer/atom_item.h"
+#include "schrodinger/sketcher/molviewer/bond_item.h"
+#include "schrodinger/sketcher/molviewer/molecule_tile_cache.h"
+
+namespace schrodinger
+{
+namespace sketcher
+{
+
+void BondPaintBatch::addLines(const QPen& pen, const std::vector<QLineF>& lines,
+                              const QPointF& offset)
+{
+    if (lines.empty()) {
+        return;
+    }
+    auto group = std::find_if(m_lines.begin(), m_lines.end(),
+                              [&pen](const auto& cur_group) {
+                                  return cur_group.first == pen;
+                              });
+    if (group == m_lines.end()) {
+        group = m_lines.emplace(m_lines.end(), pen, QVector<QLineF>());
+    }
+    for (const auto& line : lines) {
+        group->second.push_back(line.translated(offset));
+    }
+}
+
+void BondPaintBatch::addPolygons(const QPen& pen, const QBrush& brush,
+                                 const std::vector<QPolygonF>& polygons,
+                                 const QPointF& offset)
+{
+    if (polygons.empty()) {
+        return;
+    }
+    auto group = std::find_if(m_polygons.begin(), m_polygons.end(),
+                              [&pen, &brush](const auto& cur_group) {
+                                  return std::get<0>(cur_group) == pen &&
+                                         std::get<1>(cur_group) == brush;
+                              });
+    if (group == m_polygons.end()) {
+        group = m_polygons.emplace(m_polygons.end(), pen, brush,
+                                   std::vector<QPolygonF>());
+    }
+    for (const auto& polygon : polygons) {
+        std::get<2>(*group).push_back(polygon.translated(offset));
+    }
+}
+
+void BondPaintBatch::paint(QPainter* painter) const
+{
+    painter->save();
+    for (const auto& [pen, lines] : m_lines) {
+        painter->setPen(pen);
+        painter->drawLines(lines);
+    }
+    // polygons are painted individually, since combining them into a single
+    // path would make overlapping polygons cancel each other out
+    for (const auto& [pen, brush, polygons] : m_polygons) {
+        painter->setPen(pen);
+        painter->setBrush(brush);
+        for (const auto& polygon : polygons) {
+            painter->drawPolygon(polygon);
+        }
+    }
+    painter->restore();
+}
+
+BatchedMoleculeItem::BatchedMoleculeItem(
+    const std::unordered_map<const RDKit::Atom*, QGraphicsItem*>&
+        atom_to_atom_item,
+    const std::unordered_map<const RDKit::Bond*, QGraphicsItem*>&
+        bond_to_bond_item) :
+    QGraphicsItem(),
+    m_atom_to_atom_item(atom_to_atom_item),
+    m_bond_to_bond_item(bond_to_bond_item)
+{
+    // connectors are the lowest of the items painted here
+    setZValue(static_cast<qreal>(ZOrder::MONOMER_CONNECTOR));
+    // we need the exposed rect to skip items that don't need to be repainted
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+
+    auto paint_layer = [this](QPainter* painter) {
+        QStyleOptionGraphicsItem option;
+        option.exposedRect = m_bounding_rect;
+        paintMolecule(painter, &option, nullptr, m_bounding_rect);
+    };
+    m_tile_cache = std::make_unique<MoleculeTileCache>(paint_layer);
+    QObject::connect(m_tile_cache.get(), &MoleculeTileCache::tilesReady,
+                     m_tile_cache.get(), [this]() { update(); });
+}
+
+BatchedMoleculeItem::~BatchedMoleculeItem() = default;
+
+int BatchedMoleculeItem::type() const
+{
+    return Type;
+}
+
+/**
+ * @return the bounding rect of the given item in scene coordinates.  Atom and
+ * bond items are never transformed, so this is cheaper than sceneBoundingRect.
+ */
+static QRectF get_scene_rect(const QGraphicsItem* item)
+{
+    return item->boundingRect().translated(item->pos());
+}
+
+void BatchedMoleculeItem::updateCachedData(
+    const QList<QGraphicsItem*>& changed_items)
+{
+    prepareGeometryChange();
+    m_bounding_rect = QRectF();
+    std::unordered_map<const QGraphicsItem*, QRectF> item_rects;
+    auto add_item = [this, &item_rects](const QGraphicsItem* item) {
+        auto rect = get_scene_rect(item);
+        m_bounding_rect |= rect;
+        item_rects[item] = rect;
+        auto old_rect = m_item_rects.find(item);
+        if (old_rect == m_item_rects.end()) {
+            m_tile_cache->invalidate(rect);
+        } else {
+            if (old_rect->second != rect) {
+                m_tile_cache->invalidate(old_rect->second);
+                m_tile_cache->invalidate(rect);
+            }
+            m_item_rects.erase(old_rect);
+        }
+    };
+    for (auto [atom, item] : m_atom_to_atom_item) {
+        add_item(item);
+    }
+    for (auto [bond, item] : m_bond_to_bond_item) {
+        add_item(item);
+    }
+    // anything left over was removed from the scene
+    for (const auto& [item, rect] : m_item_rects) {
+        m_tile_cache->invalidate(rect);
+    }
+    for (auto* item : changed_items) {
+        if (auto rect = item_rects.find(item); rect != item_rects.end()) {
+            m_tile_cache->invalidate(rect->second);
+        }
+    }
+    m_item_rects = std::move(item_rects);
+}
+
+QRectF BatchedMoleculeItem::boundingRect() const
+{
+    return m_bounding_rect;
+}
+
+QPainterPath BatchedMoleculeItem::shape() const
+{
+    return QPainterPath();
+}
+
+void BatchedMoleculeItem::paint(QPainter* painter,
+                                const QStyleOptionGraphicsItem* option,
+                                QWidget* widget)
+{
+    // only use the tile cache when painting into a View, since images and
+    // SVGs exported from the Scene shouldn't contain rasterized tiles
+    if (widget == nullptr ||
+        painter->worldTransform().type() > QTransform::TxScale) {
+        paintMolecule(painter, option, widget, option->exposedRect);
+        return;
+    }
+    auto uncached_rects = m_tile_cache->paint(painter, option->exposedRect);
+    if (uncached_rects.isEmpty()) {
+        return;
+    }
+    QPainterPath uncached_path;
+    QRectF uncached_bounding_rect;
+    for (const auto& rect : uncached_rects) {
+        uncached_path.addRect(rect);
+        uncached_bounding_rect |= rect;
+    }
+    painter->save();
+    painter->setClipPath(uncached_path, Qt::IntersectClip);
+    paintMolecule(painter, option, widget,
+                  uncached_bounding_rect & option->exposedRect);
+    painter->restore();
+}
+
+void BatchedMoleculeItem::paintMolecule(QPainter* painter,
+                                        const QStyleOptionGraphicsItem* option,
+                                        QWidget* widget,
+                                        const QRectF& rect) const
+{
+    auto is_exposed = [&rect](const QGraphicsItem* item) {
+        return item->isVisible() && rect.intersects(get_scene_rect(item));
+    };
+    auto paint_item = [painter, option, widget](QGraphicsItem* item) {
+        painter->save();
+        painter->translate(item->pos());
+        item->paint(painter, option, widget);
+        painter->restore();
+    };
+
+    // items are painted in the same order as their Z values: connectors,
+    // bonds, monomers, then atoms
+    BondPaintBatch batch;
+    std::vector<BondItem*> unbatched_bond_items;
+    for (auto [bond, item] : m_bond_to_bond_item) {
+        if (!is_exposed(item)) {
+            continue;
+        }
+        auto* bond_item = qgraphicsitem_cast<BondItem*>(item);
+        if (bond_item == nullptr) {
+            paint_item(item);
+        } else if (!bond_item->addToBatch(batch, painter)) {
+            unbatched_bond_items.push_back(bond_item);
+        }
+    }
+    batch.paint(painter);
+    for (auto* bond_item : unbatched_bond_items) {
+        paint_item(bond_item);
+    }
+
+    std::vector<AtomItem*> atom_items;
+    for (auto [atom, item] : m_atom_to_atom_item) {
+        if (!is_exposed(item)) {
+            continue;
+        }
+        auto* atom_item = qgraphicsitem_cast<AtomItem*>(item);
+        if (atom_item == nullptr) {
+            paint_item(item);
+        } else if (atom_item->hasContentsToPaint()) {
+            atom_items.push_back(atom_item);
+        }
+    }
+    for (auto* atom_item : atom_items) {
+        paint_item(atom_item);
+    }
+}
+
+} // namespace sketcher
+} // namespace schrodinger
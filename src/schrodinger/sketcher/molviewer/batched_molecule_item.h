@@ -0,0 +1,155 @@
+#pragma once
+
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <QBrush>
+#include <QGraphicsItem>
+#include <QLineF>
+#include <QList>
+#include <QPainterPath>
+#include <QPen>
+#include <QPolygonF>
+#include <QRectF>
+#include <QVector>
+
+#include "schrodinger/sketcher/definitions.h"
+#include "schrodinger/sketcher/molviewer/constants.h"
+
+class QPainter;
+class QStyleOptionGraphicsItem;
+class QWidget;
+
+namespace RDKit
+{
+class Atom;
+class Bond;
+} // namespace RDKit
+
+namespace schrodinger
+{
+namespace sketcher
+{
+
+class MoleculeTileCache;
+
+/**
+ * Lines and polygons collected from many BondItems, grouped by the pen and
+ * brush that they're painted with so that each group can be painted with a
+ * single QPainter call.
+ */
+class SKETCHER_API BondPaintBatch
+{
+  public:
+    /**
+     * Add lines to be painted with the given pen
+     *
+     * @param offset the position of the bond item, since the lines are in its
+     * local coordinates
+     */
+    void addLines(const QPen& pen, const std::vector<QLineF>& lines,
+                  const QPointF& offset);
+
+    /**
+     * Add polygons to be painted with the given pen and brush
+     *
+     * @param offset the position of the bond item, since the polygons are in
+     * its local coordinates
+     */
+    void addPolygons(const QPen& pen, const QBrush& brush,
+                     const std::vector<QPolygonF>& polygons,
+                     const QPointF& offset);
+
+    /**
+     * Paint all lines and polygons that were added to this batch
+     */
+    void paint(QPainter* painter) const;
+
+  private:
+    // there are typically only a handful of distinct pens in a scene, so
+    // these are searched linearly
+    std::vector<std::pair<QPen, QVector<QLineF>>> m_lines;
+    std::vector<std::tuple<QPen, QBrush, std::vector<QPolygonF>>> m_polygons;
+};
+
+/**
+ * A Qt graphics item that paints all atom, bond, monomer and connector items in
+ * a Scene in a single pass, which avoids the per-item overhead of painting
+ * thousands of separate graphics items.  Bonds that consist of plain lines and
+ * polygons are collected into a BondPaintBatch, while bonds that need clipping
+ * (e.g. to make room for an annotation), atoms with labels, monomers and
+ * connectors are painted by their own items' paint methods.
+ *
+ * When painted in a View, the result is cached in a MoleculeTileCache, so
+ * panning and changes to hover and selection highlighting, which are painted by
+ * other items, don't need to repaint the molecule.
+ *
+ * While this item is in use, the Scene sets the ItemHasNoContents flag on the
+ * atom, bond, monomer and connector items so that Qt doesn't paint them itself.
+ * They remain in the scene for hit-testing and selection.
+ */
+class SKETCHER_API BatchedMoleculeItem : public QGraphicsItem
+{
+  public:
+    /**
+     * Note that this class does not take ownership of the maps, which must
+     * remain valid while this item is in use.  They are typically the Scene's
+     * maps of atoms and bonds to their graphics items.
+     */
+    BatchedMoleculeItem(
+        const std::unordered_map<const RDKit::Atom*, QGraphicsItem*>&
+            atom_to_atom_item,
+        const std::unordered_map<const RDKit::Bond*, QGraphicsItem*>&
+            bond_to_bond_item);
+
+    enum { Type = static_cast<int>(GraphicsItemType::BATCHED_MOLECULE_ITEM) };
+    int type() const override;
+
+    ~BatchedMoleculeItem();
+
+    /**
+     * Update the bounding rect and discard the affected cached tiles after
+     * items have been added, removed, moved, or updated.  Tiles are discarded
+     * wherever an item was added, removed or moved, and wherever one of the
+     * given items is.
+     *
+     * @param changed_items items whose contents may have changed without
+     * changing their bounding rect
+     */
+    void updateCachedData(const QList<QGraphicsItem*>& changed_items = {});
+
+    // Overridden QGraphicsItem methods
+    QRectF boundingRect() const override;
+    /**
+     * @return an empty path so that this item is never found by hit-tests,
+     * which are handled by the atom and bond items themselves
+     */
+    QPainterPath shape() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option,
+               QWidget* widget = nullptr) override;
+
+  protected:
+    /**
+     * Paint all items that intersect the given rect, which is in Scene
+     * coordinates
+     */
+    void paintMolecule(QPainter* painter,
+                       const QStyleOptionGraphicsItem* option, QWidget* widget,
+                       const QRectF& rect) const;
+
+    const std::unordered_map<const RDKit::Atom*, QGraphicsItem*>&
+        m_atom_to_atom_item;
+    const std::unordered_map<const RDKit::Bond*, QGraphicsItem*>&
+        m_bond_to_bond_item;
+    QRectF m_bounding_rect;
+    // the Scene rect of each item as of the last updateCachedData call, used
+    // to find the regions of the tile cache that need to be discarded
+    std::unordered_map<const QGraphicsItem*, QRectF> m_item_rects;
+    std::unique_ptr<MoleculeTileCache> m_tile_cache;
+};
+
+} // namespace sketcher
+} // namespace schrodinger
@@ -37,6 +37,11 @@ class SKETCHER_API BondDisplaySettings
     QColor m_color;
     /// Whether to display stereochemistry labels when present
     bool m_stereo_labels_shown = true;
+    /// When the lines of double and triple bonds would be painted closer
+    /// together than this many pixels, all bonds are painted as a single line
+    /// and bond annotations are omitted.  Set to zero to always paint every
+    /// line.
+    qreal m_min_bond_line_pixel_spacing = DEFAULT_MIN_BOND_LINE_PIXEL_SPACING;
 
     /**
      * Scale bond width by the specified value.  Note that double bond spacing
@@ -38,6 +38,7 @@
 #include "schrodinger/sketcher/rdkit/stereochemistry.h"
 #include "schrodinger/sketcher/rdkit/variable_attachment_bond_core.h"
 #include "schrodinger/sketcher/molviewer/atom_item.h"
+#include "schrodinger/sketcher/molviewer/batched_molecule_item.h"
 #include "schrodinger/sketcher/molviewer/coord_utils.h"
 #include "schrodinger/sketcher/molviewer/scene_utils.h"
 #include "schrodinger/sketcher/rdkit/atoms_and_bonds.h"
@@ -149,6 +150,7 @@ void BondItem::updateCachedData()
     QLineF bond_line = QLineF(QPointF(0, 0), bond_end);
     m_midpoint = bond_line.center();
     m_to_paint = calculateLinesToPaint(bond_line, bond_type);
+    m_trimmed_line = trimLineToBoundAtoms(bond_line);
     m_selection_highlighting_path =
         get_selection_highlighting_path_for_bond(m_bond);
     m_predictive_highlighting_path =
@@ -684,6 +686,17 @@ QString BondItem::getTooltip() const
 void BondItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option,
                      QWidget* widget)
 {
+    if (isSimplifiedAtLevelOfDetail(painter)) {
+        painter->save();
+        painter->setPen(m_solid_pen);
+        painter->drawLine(getLineBetweenAtomCenters());
+        painter->restore();
+        return;
+    }
+    if (isPaintedAsSingleLine(painter)) {
+        paintSimplifiedBond(painter);
+        return;
+    }
     if (!m_annotation_text.isEmpty() ||
         !m_start_item.getChiralityLabelText().isEmpty() ||
         !m_end_item.getChiralityLabelText().isEmpty()) {
@@ -858,11 +871,79 @@ void BondItem::paintBondLinesAndPolygons(QPainter* painter)
     }
 }
 
+void BondItem::paintSimplifiedBond(QPainter* painter)
+{
+    painter->save();
+    auto pen = m_solid_pen;
+    if (m_colors.size() == 2) {
+        // change colors at the bond's midpoint, as paintBondLinesAndPolygons
+        // does
+        pen.setColor(m_colors.front());
+        painter->setPen(pen);
+        painter->drawLine(QLineF(m_trimmed_line.p1(), m_midpoint));
+        pen.setColor(m_colors.back());
+        painter->setPen(pen);
+        painter->drawLine(QLineF(m_midpoint, m_trimmed_line.p2()));
+    } else {
+        if (!m_colors.empty()) {
+            pen.setColor(m_colors.front());
+        }
+        painter->setPen(pen);
+        painter->drawLine(m_trimmed_line);
+    }
+    painter->restore();
+}
+
 const RDKit::Bond* BondItem::getBond() const
 {
     return m_bond;
 }
 
+bool BondItem::isPaintedAsSingleLine(const QPainter* painter) const
+{
+    return m_settings.m_double_bond_spacing * getLevelOfDetail(painter) <
+           m_settings.m_min_bond_line_pixel_spacing;
+}
+
+QLineF BondItem::getLineBetweenAtomCenters() const
+{
+    // the bond item is positioned at the start atom
+    return QLineF(QPointF(0, 0), m_end_item.pos() - m_start_item.pos());
+}
+
+bool BondItem::addToBatch(BondPaintBatch& batch, const QPainter* painter) const
+{
+    if (isSimplifiedAtLevelOfDetail(painter)) {
+        batch.addLines(m_solid_pen, {getLineBetweenAtomCenters()}, pos());
+        return true;
+    }
+    if (m_colors.size() != 1) {
+        // two-colored bonds are clipped at their midpoint
+        return false;
+    }
+    auto pen = m_solid_pen;
+    pen.setColor(m_colors.front());
+    if (isPaintedAsSingleLine(painter)) {
+        batch.addLines(pen, {m_trimmed_line}, pos());
+        return true;
+    }
+    if (!m_annotation_text.isEmpty() ||
+        !m_start_item.getChiralityLabelText().isEmpty() ||
+        !m_end_item.getChiralityLabelText().isEmpty()) {
+        // the bond is partially transparent behind annotations
+        return false;
+    }
+    auto brush = m_solid_brush;
+    brush.setColor(m_colors.front());
+    for (const auto& cur_to_paint : m_to_paint) {
+        pen = cur_to_paint.pen;
+        pen.setColor(m_colors.front());
+        batch.addLines(pen, cur_to_paint.lines, pos());
+        batch.addPolygons(pen, brush, cur_to_paint.polygons, pos());
+    }
+    return true;
+}
+
 std::tuple<qreal, QPointF, QSizeF>
 BondItem::getStereoAnnotationParameters(const QString& label,
                                         const bool draw_text_above_bond) const
@@ -37,6 +37,7 @@ namespace sketcher
 {
 
 class AtomItem;
+class BondPaintBatch;
 
 /**
  * A collection of lines and polygons that should be painted using the specified
@@ -101,10 +102,25 @@ class SKETCHER_API BondItem : public AbstractBondOrConnectorItem
      */
     const RDKit::Bond* getBond() const;
 
+    /**
+     * Add the lines and polygons for this bond to the given batch instead of
+     * painting them directly.  This is only possible when the bond is painted
+     * in a single color and doesn't need any clipping.
+     *
+     * @param painter the painter that the batch will be painted with
+     * @return whether the bond was added to the batch (or doesn't need to be
+     * painted at all).  If false, the bond must be painted using paint().
+     */
+    bool addToBatch(BondPaintBatch& batch, const QPainter* painter) const;
+
   protected:
     const AtomItem& m_start_item;
     const AtomItem& m_end_item;
     std::vector<ToPaint> m_to_paint;
+    /// The bond line trimmed to the atom labels, which is painted in place of
+    /// m_to_paint when zoomed out far enough that the individual lines of the
+    /// bond can't be distinguished
+    QLineF m_trimmed_line;
     QPen m_solid_pen;
     QPen m_dashed_pen;
     QPen m_chirality_pen;
@@ -150,6 +166,28 @@ class SKETCHER_API BondItem : public AbstractBondOrConnectorItem
      */
     void paintBondLinesAndPolygons(QPainter* painter);
 
+    /**
+     * paint the bond as a single line, without any annotation.  This is used
+     * in place of paintBondLinesAndPolygons when the lines of multiple bonds
+     * would be painted too close together to be distinguished.  See
+     * BondDisplaySettings::m_min_bond_line_pixel_spacing.
+     */
+    void paintSimplifiedBond(QPainter* painter);
+
+    /**
+     * @return whether the bond is painted as a single line, via
+     * paintSimplifiedBond, at the level of detail of the given painter
+     */
+    bool isPaintedAsSingleLine(const QPainter* painter) const;
+
+    /**
+     * @return the line between the centers of the bound atoms in local
+     * coordinates.  In large-molecule mode, this is all that's painted for the
+     * bond when zoomed out, since atom labels aren't painted at that level of
+     * detail.
+     */
+    QLineF getLineBetweenAtomCenters() const;
+
     /**
      * Calculate the lines and polygons needed to paint this bond.  Note that
      * this method does *not* do any actual painting.  (The output of this
@@ -400,7 +400,48 @@ const QColor DARK_CURSOR_COLOR = LIGHT_BACKGROUND_COLOR;
 // The maximum number of atoms that can be imported at once. Attempting to
 // import a molecule or reaction with too many atoms will result in an error
 // dialog informing the user of the problem.
-const unsigned int MAX_NUM_ATOMS_FOR_IMPORT = 200;
+const unsigned int MAX_NUM_ATOMS_FOR_IMPORT = 25000;
+
+// Molecules with more atoms than this are displayed in large-molecule mode:
+// when zoomed out, bonds are drawn as plain lines in a single batch and atom
+// labels are hidden.  CIP labels of connected components with more atoms than
+// this are only calculated once the sketcher is idle.
+const unsigned int LARGE_MOLECULE_ATOM_THRESHOLD = 500;
+
+// How long, in milliseconds, the MolModel must go without changes before it
+// calculates the deferred CIP labels of large molecules
+const int DEFERRED_CIP_LABELS_DELAY_MS = 250;
+
+// In large-molecule mode, the level of detail (i.e. the on-screen scale) below
+// which the molecule is drawn in simplified form
+const qreal LARGE_MOLECULE_SIMPLIFIED_LEVEL_OF_DETAIL = 0.35;
+
+// The default on-screen size, in pixels, below which the main label font is
+// too small to be legible, so atom labels are drawn as plain boxes instead
+const qreal DEFAULT_MIN_LABEL_PIXEL_SIZE = 4.0;
+
+// The default on-screen distance, in pixels, below which the lines of double
+// and triple bonds blur together, so bonds are drawn as a single line instead
+const qreal DEFAULT_MIN_BOND_LINE_PIXEL_SPACING = 1.5;
+
+// The opacity of the boxes drawn in place of atom labels that are too small
+// to be legible.  Text only covers part of its bounding box, so solid boxes
+// would look much heavier than the labels they replace.
+const qreal SIMPLIFIED_LABEL_OPACITY = 0.5;
+
+// The side length, in device-independent pixels, of the tiles that the
+// batched molecule layer is cached in while it's displayed in a View
+const int MOLECULE_TILE_SIZE = 256;
+
+// The maximum number of molecule tiles kept in memory.  Once this is exceeded,
+// tiles that aren't currently visible are discarded.
+const unsigned int MAX_CACHED_MOLECULE_TILES = 128;
+
+// How long, in milliseconds, the View must be idle before uncached molecule
+// tiles are rasterized in the background.  Until then, they are painted
+// directly, which avoids rasterizing tiles that are immediately invalidated
+// during drags and zooms.
+const int MOLECULE_TILE_RASTERIZATION_DELAY_MS = 100;
 
 // maximum allowed values for spin boxes in the Edit Aom Properties dialog
 const unsigned int MAX_STEREO_GROUP_ID = 99;
@@ -449,6 +490,7 @@ enum class GraphicsItemType {
     // with ABSTRACT_GRAPHICS_ITEM_BASE, so we skip a bunch of numbers before
     // the next non-AbstractGraphicsItem subclass
     UNBOUND_MONOMERIC_ATTACHMENT_POINT_ITEM = QGraphicsItem::UserType + 2000,
+    BATCHED_MOLECULE_ITEM,
 };
 
 // Bit flags for specifying subsets of Scene items based on the type of model
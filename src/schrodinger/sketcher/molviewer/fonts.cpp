@@ -1,5 +1,7 @@
 #include "schrodinger/sketcher/molviewer/fonts.h"
 
+#include <QHashFunctions>
+
 #include "schrodinger/sketcher/image_constants.h"
 #include "schrodinger/sketcher/molviewer/constants.h"
 #include "schrodinger/sketcher/molviewer/monomer_constants.h"
@@ -9,6 +11,11 @@ namespace schrodinger
 namespace sketcher
 {
 
+// The maximum number of entries in each cache.  Caches are cleared once they
+// reach this size, which only happens for structures with an unusually large
+// variety of labels.
+constexpr std::size_t MAX_CACHE_SIZE = 4096;
+
 Fonts::Fonts() :
     m_main_label_font(QFont(FONT_LIST)),
     m_subscript_font(QFont(FONT_LIST)),
@@ -108,6 +115,61 @@ void Fonts::updateFontMetrics()
         QFontMetricsF(m_other_nucleic_acid_base_font);
     m_monomeric_attachment_point_label_fm =
         QFontMetricsF(m_monomeric_attachment_point_label_font);
+
+    // cached text rects are keyed by font, so they would still be valid, but
+    // they're unlikely to be needed again.  Cached label layouts depend on the
+    // font sizes, so they're no longer valid.
+    m_text_rect_cache.clear();
+    m_atom_label_layout_cache.clear();
+}
+
+QRectF Fonts::getTightBoundingRect(const QFont& font,
+                                   const QString& text) const
+{
+    auto key = std::make_pair(font, text);
+    if (auto it = m_text_rect_cache.find(key); it != m_text_rect_cache.end()) {
+        return it->second;
+    }
+    if (m_text_rect_cache.size() >= MAX_CACHE_SIZE) {
+        m_text_rect_cache.clear();
+    }
+    auto rect = QFontMetricsF(font).tightBoundingRect(text);
+    m_text_rect_cache.emplace(std::move(key), rect);
+    return rect;
+}
+
+std::optional<AtomLabelLayout>
+Fonts::getCachedAtomLabelLayout(const AtomLabelLayoutKey& key) const
+{
+    if (auto it = m_atom_label_layout_cache.find(key);
+        it != m_atom_label_layout_cache.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+void Fonts::cacheAtomLabelLayout(const AtomLabelLayoutKey& key,
+                                 const AtomLabelLayout& layout) const
+{
+    if (m_atom_label_layout_cache.size() >= MAX_CACHE_SIZE) {
+        m_atom_label_layout_cache.clear();
+    }
+    m_atom_label_layout_cache.insert_or_assign(key, layout);
+}
+
+std::size_t Fonts::TextRectKeyHash::operator()(
+    const std::pair<QFont, QString>& key) const
+{
+    return qHashMulti(0, key.first, key.second);
+}
+
+std::size_t Fonts::AtomLabelLayoutKeyHash::operator()(
+    const AtomLabelLayoutKey& key) const
+{
+    return qHashMulti(0, key.main_label_text, key.isotope_label_text,
+                      key.charge_and_radical_label_text, key.mapping_label_text,
+                      key.H_count_label_text, key.has_H_label,
+                      static_cast<int>(key.H_direction));
 }
 
 } // namespace sketcher
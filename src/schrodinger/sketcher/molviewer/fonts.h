@@ -1,7 +1,14 @@
 #pragma once
 
+#include <cstddef>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
 #include <QFont>
 #include <QFontMetricsF>
+#include <QRectF>
+#include <QString>
 #include <QtGlobal>
 
 #include "schrodinger/sketcher/definitions.h"
@@ -11,6 +18,36 @@ namespace schrodinger
 namespace sketcher
 {
 
+enum class HsDirection;
+
+/**
+ * Everything that the layout of an atom's text labels depends on, other than
+ * the fonts themselves
+ */
+struct AtomLabelLayoutKey {
+    QString main_label_text;
+    QString isotope_label_text;
+    QString charge_and_radical_label_text;
+    QString mapping_label_text;
+    QString H_count_label_text;
+    bool has_H_label;
+    HsDirection H_direction;
+
+    bool operator==(const AtomLabelLayoutKey& other) const = default;
+};
+
+/**
+ * The positions of an atom's text labels, relative to the atom
+ */
+struct AtomLabelLayout {
+    QRectF main_label_rect;
+    QRectF isotope_label_rect;
+    QRectF charge_and_radical_label_rect;
+    QRectF mapping_label_rect;
+    QRectF H_label_rect;
+    QRectF H_count_label_rect;
+};
+
 /**
  * An object used for storing all fonts (and associated QFontMetrics) used in a
  * Scene. Also includes the size for radical dots pen.
@@ -42,6 +79,29 @@ class SKETCHER_API Fonts
      */
     void updateFontMetrics();
 
+    /**
+     * @return the tight bounding rect of the given text when painted with the
+     * given font.  Results are cached, since measuring text is one of the most
+     * expensive parts of creating atom labels and the same few strings are
+     * measured over and over again.
+     */
+    QRectF getTightBoundingRect(const QFont& font, const QString& text) const;
+
+    /**
+     * @return the label layout previously stored for the given key using
+     * cacheAtomLabelLayout, if any
+     */
+    std::optional<AtomLabelLayout>
+    getCachedAtomLabelLayout(const AtomLabelLayoutKey& key) const;
+
+    /**
+     * Store the label layout calculated for the given key so that atoms with
+     * identical labels can reuse it.  The layout is discarded when the font
+     * metrics are updated.
+     */
+    void cacheAtomLabelLayout(const AtomLabelLayoutKey& key,
+                              const AtomLabelLayout& layout) const;
+
     QFont m_main_label_font;
     QFont m_subscript_font;
     QFont m_charge_font;
@@ -73,6 +133,23 @@ class SKETCHER_API Fonts
     QFontMetricsF m_monomeric_attachment_point_label_fm;
 
     qreal m_radical_dot_size;
+
+  private:
+    struct TextRectKeyHash {
+        std::size_t operator()(const std::pair<QFont, QString>& key) const;
+    };
+    struct AtomLabelLayoutKeyHash {
+        std::size_t operator()(const AtomLabelLayoutKey& key) const;
+    };
+
+    // Note that these caches are not thread safe, which is fine since, like
+    // the fonts themselves, a Fonts object is only used from a single thread
+    mutable std::unordered_map<std::pair<QFont, QString>, QRectF,
+                               TextRectKeyHash>
+        m_text_rect_cache;
+    mutable std::unordered_map<AtomLabelLayoutKey, AtomLabelLayout,
+                               AtomLabelLayoutKeyHash>
+        m_atom_label_layout_cache;
 };
 
 } // namespace sketcher
@@ -0,0 +1,262 @@
+#include "schrodinger/sketcher/molviewer/molecule_tile_cache.h"
+
+#include <cmath>
+
+#include <QPaintDevice>
+#include <QPicture>
+#include <QTransform>
+
+#include "schrodinger/sketcher/molviewer/constants.h"
+
+namespace schrodinger
+{
+namespace sketcher
+{
+
+static std::uint64_t get_tile_key(const int col, const int row)
+{
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(col))
+            << 32) |
+           static_cast<std::uint32_t>(row);
+}
+
+static std::pair<int, int> get_tile_col_and_row(const std::uint64_t key)
+{
+    return {static_cast<int>(static_cast<std::uint32_t>(key >> 32)),
+            static_cast<int>(static_cast<std::uint32_t>(key))};
+}
+
+/**
+ * Play back the given recording of the layer into the given tiles
+ *
+ * @param should_stop a function that's called before each tile is rasterized.
+ * If it returns true, rasterization stops and the tiles rasterized so far are
+ * returned.
+ */
+static std::vector<std::pair<std::uint64_t, QImage>>
+rasterize_tiles(QPicture& picture,
+                const std::vector<std::pair<int, int>>& tiles,
+                const qreal device_pixel_ratio,
+                const QPainter::RenderHints render_hints,
+                const std::function<bool()>& should_stop)
+{
+    std::vector<std::pair<std::uint64_t, QImage>> images;
+    for (auto [col, row] : tiles) {
+        if (should_stop()) {
+            break;
+        }
+        QImage image(QSize(MOLECULE_TILE_SIZE, MOLECULE_TILE_SIZE) *
+                         device_pixel_ratio,
+                     QImage::Format_ARGB32_Premultiplied);
+        image.setDevicePixelRatio(device_pixel_ratio);
+        image.fill(Qt::transparent);
+        {
+            QPainter painter(&image);
+            painter.setRenderHints(render_hints);
+            painter.translate(-col * MOLECULE_TILE_SIZE,
+                              -row * MOLECULE_TILE_SIZE);
+            picture.play(&painter);
+        }
+        images.emplace_back(get_tile_key(col, row), std::move(image));
+    }
+    return images;
+}
+
+MoleculeTileCache::MoleculeTileCache(
+    std::function<void(QPainter*)> paint_layer, QObject* parent) :
+    QObject(parent),
+    m_paint_layer(std::move(paint_layer))
+{
+    m_rasterization_timer.setSingleShot(true);
+    m_rasterization_timer.setInterval(MOLECULE_TILE_RASTERIZATION_DELAY_MS);
+    connect(&m_rasterization_timer, &QTimer::timeout, this,
+            &MoleculeTileCache::rasterizePendingTiles);
+}
+
+MoleculeTileCache::~MoleculeTileCache()
+{
+    m_rasterization_timer.stop();
+    stopWorker();
+}
+
+void MoleculeTileCache::invalidate(const QRectF& scene_rect)
+{
+    if (m_tiles.empty() && !m_worker.joinable()) {
+        return;
+    }
+    ++m_generation;
+    auto [min_col, min_row, max_col, max_row] = getTileRange(scene_rect);
+    for (int col = min_col; col <= max_col; ++col) {
+        for (int row = min_row; row <= max_row; ++row) {
+            m_tiles.erase(get_tile_key(col, row));
+        }
+    }
+}
+
+void MoleculeTileCache::invalidateAll()
+{
+    ++m_generation;
+    m_tiles.clear();
+}
+
+QList<QRectF> MoleculeTileCache::paint(QPainter* painter,
+                                       const QRectF& scene_rect)
+{
+    auto transform = painter->worldTransform();
+    auto scale = transform.m11();
+    auto device_pixel_ratio = painter->device()->devicePixelRatioF();
+    auto render_hints = painter->renderHints();
+    if (scale != m_scale || device_pixel_ratio != m_device_pixel_ratio ||
+        render_hints != m_render_hints) {
+        invalidateAll();
+        m_scale = scale;
+        m_device_pixel_ratio = device_pixel_ratio;
+        m_render_hints = render_hints;
+    }
+
+    // tiles are aligned to the Scene origin rather than to the viewport, so
+    // that they can be reused as the View pans
+    auto [min_col, min_row, max_col, max_row] = getTileRange(scene_rect);
+    qreal tile_scene_size = MOLECULE_TILE_SIZE / m_scale;
+    QList<QRectF> uncached_rects;
+    m_pending_tiles.clear();
+    painter->save();
+    painter->setWorldTransform(
+        QTransform::fromTranslate(transform.dx(), transform.dy()));
+    for (int col = min_col; col <= max_col; ++col) {
+        for (int row = min_row; row <= max_row; ++row) {
+            auto tile = m_tiles.find(get_tile_key(col, row));
+            if (tile != m_tiles.end()) {
+                painter->drawImage(QPointF(col * MOLECULE_TILE_SIZE,
+                                           row * MOLECULE_TILE_SIZE),
+                                   tile->second);
+            } else {
+                m_pending_tiles.emplace_back(col, row);
+                uncached_rects.append(
+                    QRectF(col * tile_scene_size, row * tile_scene_size,
+                           tile_scene_size, tile_scene_size));
+            }
+        }
+    }
+    painter->restore();
+    trimCache(min_col, min_row, max_col, max_row);
+    if (!m_pending_tiles.empty()) {
+        // restart the timer so that we wait until the View is idle
+        m_rasterization_timer.start();
+    }
+    return uncached_rects;
+}
+
+size_t MoleculeTileCache::getNumCachedTiles() const
+{
+    return m_tiles.size();
+}
+
+void MoleculeTileCache::rasterizePendingTiles()
+{
+    if (m_pending_tiles.empty()) {
+        return;
+    }
+    stopWorker();
+
+    // record the layer on this thread, since graphics items can't be painted
+    // from any other thread.  The scale is recorded as well so that the items
+    // pick the appropriate level of detail.
+    QPicture picture;
+    {
+        QPainter picture_painter(&picture);
+        picture_painter.setRenderHints(m_render_hints);
+        picture_painter.setWorldTransform(
+            QTransform::fromScale(m_scale, m_scale));
+        m_paint_layer(&picture_painter);
+    } // destroy the painter to finish recording
+
+    auto tiles = std::move(m_pending_tiles);
+    m_pending_tiles.clear();
+    unsigned int generation = m_generation;
+#ifdef __EMSCRIPTEN__
+    // the WebAssembly build isn't linked with thread support, so the tiles are
+    // rasterized here instead.  This still only happens once the View is idle.
+    auto images = rasterize_tiles(picture, tiles, m_device_pixel_ratio,
+                                  m_render_hints, []() { return false; });
+    onTilesRasterized(generation, images);
+#else
+    m_worker = std::thread([this, picture, tiles, generation,
+                            device_pixel_ratio = m_device_pixel_ratio,
+                            render_hints = m_render_hints]() mutable {
+        auto images = rasterize_tiles(
+            picture, tiles, device_pixel_ratio, render_hints,
+            [this, generation]() {
+                return m_cancel_worker || m_generation != generation;
+            });
+        if (m_cancel_worker || m_generation != generation) {
+            return;
+        }
+        QMetaObject::invokeMethod(
+            this,
+            [this, generation, images = std::move(images)]() {
+                onTilesRasterized(generation, images);
+            },
+            Qt::QueuedConnection);
+    });
+#endif // __EMSCRIPTEN__
+}
+
+void MoleculeTileCache::onTilesRasterized(
+    const unsigned int generation,
+    const std::vector<std::pair<std::uint64_t, QImage>>& tiles)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    for (const auto& [key, image] : tiles) {
+        m_tiles[key] = image;
+    }
+    emit tilesReady();
+}
+
+void MoleculeTileCache::stopWorker()
+{
+    if (m_worker.joinable()) {
+        m_cancel_worker = true;
+        m_worker.join();
+        m_cancel_worker = false;
+    }
+}
+
+void MoleculeTileCache::trimCache(const int min_col, const int min_row,
+                                  const int max_col, const int max_row)
+{
+    if (m_tiles.size() <= MAX_CACHED_MOLECULE_TILES) {
+        return;
+    }
+    for (auto tile = m_tiles.begin(); tile != m_tiles.end();) {
+        auto [col, row] = get_tile_col_and_row(tile->first);
+        if (col < min_col || col > max_col || row < min_row || row > max_row) {
+            tile = m_tiles.erase(tile);
+        } else {
+            ++tile;
+        }
+    }
+}
+
+std::tuple<int, int, int, int>
+MoleculeTileCache::getTileRange(const QRectF& scene_rect) const
+{
+    if (m_scale <= 0 || !scene_rect.isValid()) {
+        // an empty range
+        return {0, 0, -1, -1};
+    }
+    auto to_tile_index = [this](qreal scene_coord) {
+        return static_cast<int>(
+            std::floor(scene_coord * m_scale / MOLECULE_TILE_SIZE));
+    };
+    return {to_tile_index(scene_rect.left()), to_tile_index(scene_rect.top()),
+            to_tile_index(scene_rect.right()),
+            to_tile_index(scene_rect.bottom())};
+}
+
+} // namespace sketcher
+} // namespace schrodinger
+
+#include "schrodinger/sketcher/molviewer/molecule_tile_cache.moc"
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <QImage>
+#include <QList>
+#include <QObject>
+#include <QPainter>
+#include <QRectF>
+#include <QTimer>
+#include <QtGlobal>
+
+#include "schrodinger/sketcher/definitions.h"
+
+namespace schrodinger
+{
+namespace sketcher
+{
+
+/**
+ * A cache of rasterized tiles for a Scene layer that is expensive to paint,
+ * i.e. the atoms and bonds painted by BatchedMoleculeItem.  Tiles are square
+ * in device coordinates and are only kept for a single zoom level, so panning
+ * the View only needs to draw cached images.
+ *
+ * Tiles that aren't cached are left for the caller to paint directly.  Once
+ * the View has been idle for MOLECULE_TILE_RASTERIZATION_DELAY_MS, the layer is
+ * recorded into a QPicture on the GUI thread, and the picture is played back
+ * into the missing tiles on a background thread.  tilesReady is emitted once
+ * they can be drawn.  The WebAssembly build has no thread support, so there the
+ * picture is played back on the GUI thread instead.
+ */
+class SKETCHER_API MoleculeTileCache : public QObject
+{
+    Q_OBJECT
+  public:
+    /**
+     * @param paint_layer a function that paints the whole layer, in Scene
+     * coordinates, using the given painter.  It's only called on the GUI
+     * thread.
+     */
+    MoleculeTileCache(std::function<void(QPainter*)> paint_layer,
+                      QObject* parent = nullptr);
+    ~MoleculeTileCache();
+
+    /**
+     * Discard all tiles that overlap the given rect, which is in Scene
+     * coordinates
+     */
+    void invalidate(const QRectF& scene_rect);
+
+    /**
+     * Discard all tiles
+     */
+    void invalidateAll();
+
+    /**
+     * Draw all cached tiles that overlap the given rect, and schedule the
+     * rasterization of the tiles that aren't cached.  The painter's world
+     * transform must only scale and translate.  If its scale, device pixel
+     * ratio, or render hints differ from the cached tiles, all tiles are
+     * discarded.
+     *
+     * @param painter the painter to draw with
+     * @param scene_rect the area to draw, in Scene coordinates
+     * @return the areas of scene_rect that aren't cached, in Scene coordinates,
+     * which the caller must paint itself
+     */
+    QList<QRectF> paint(QPainter* painter, const QRectF& scene_rect);
+
+    /**
+     * @return the number of tiles currently cached
+     */
+    size_t getNumCachedTiles() const;
+
+  signals:
+    /**
+     * Emitted on the GUI thread once newly rasterized tiles are ready to be
+     * drawn
+     */
+    void tilesReady();
+
+  protected:
+    /**
+     * Record the layer and start rasterizing the tiles that were missing from
+     * the last paint call on a background thread, or rasterize them right away
+     * in the WebAssembly build
+     */
+    void rasterizePendingTiles();
+
+    /**
+     * Add the given tiles to the cache, unless they were rasterized before
+     * the cache was last invalidated
+     */
+    void onTilesRasterized(
+        const unsigned int generation,
+        const std::vector<std::pair<std::uint64_t, QImage>>& tiles);
+
+    /**
+     * Cancel the rasterization that's in progress, if any, and wait for the
+     * background thread to finish
+     */
+    void stopWorker();
+
+    /**
+     * Discard tiles outside of the given range if the cache is full
+     */
+    void trimCache(const int min_col, const int min_row, const int max_col,
+                   const int max_row);
+
+    /**
+     * @return the range of tile columns and rows that overlap the given rect
+     * at the cached scale, as min column, min row, max column and max row
+     */
+    std::tuple<int, int, int, int> getTileRange(const QRectF& scene_rect) const;
+
+    std::function<void(QPainter*)> m_paint_layer;
+    qreal m_scale = 0;
+    qreal m_device_pixel_ratio = 1;
+    QPainter::RenderHints m_render_hints;
+    std::unordered_map<std::uint64_t, QImage> m_tiles;
+    // the column and row of each tile that was missing from the last paint
+    std::vector<std::pair<int, int>> m_pending_tiles;
+    QTimer m_rasterization_timer;
+    std::thread m_worker;
+    std::atomic<bool> m_cancel_worker = false;
+    // incremented whenever tiles are discarded, so that tiles rasterized from
+    // an outdated recording of the layer can be recognized and dropped
+    std::atomic<unsigned int> m_generation = 0;
+};
+
+} // namespace sketcher
+} // namespace schrodinger
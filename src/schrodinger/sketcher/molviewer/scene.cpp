@@ -1,6 +1,8 @@
 #include "schrodinger/sketcher/molviewer/scene.h"
 
+#include <algorithm>
 #include <functional>
+#include <optional>
 #include <unordered_set>
 
 #include <rdkit/GraphMol/ROMol.h>
@@ -26,9 +28,11 @@
 #include "schrodinger/sketcher/model/non_molecular_object.h"
 #include "schrodinger/sketcher/model/sketcher_model.h"
 #include "schrodinger/sketcher/molviewer/abstract_atom_or_monomer_item.h"
+#include "schrodinger/sketcher/molviewer/abstract_bond_or_connector_item.h"
 #include "schrodinger/sketcher/molviewer/abstract_graphics_item.h"
 #include "schrodinger/sketcher/molviewer/abstract_monomer_item.h"
 #include "schrodinger/sketcher/molviewer/atom_item.h"
+#include "schrodinger/sketcher/molviewer/batched_molecule_item.h"
 #include "schrodinger/sketcher/molviewer/bond_item.h"
 #include "schrodinger/sketcher/molviewer/sgroup_item.h"
 #include "schrodinger/sketcher/molviewer/constants.h"
@@ -36,8 +40,10 @@
 #include "schrodinger/sketcher/molviewer/non_molecular_item.h"
 #include "schrodinger/sketcher/molviewer/scene_utils.h"
 #include "schrodinger/sketcher/rdkit/atoms_and_bonds.h"
+#include "schrodinger/sketcher/rdkit/monomeric.h"
 #include "schrodinger/sketcher/rdkit/rgroup.h"
 #include "schrodinger/sketcher/rdkit/periodic_table.h"
+#include "schrodinger/sketcher/rdkit/variable_attachment_bond_core.h"
 #include "schrodinger/sketcher/tool/arrow_plus_scene_tool.h"
 #include "schrodinger/sketcher/tool/atom_mapping_scene_tool.h"
 #include "schrodinger/sketcher/tool/attachment_point_scene_tool.h"
@@ -95,6 +101,8 @@ Scene::Scene(MolModel* mol_model, SketcherModel* sketcher_model,
 
     connect(m_mol_model, &MolModel::coordinatesChanged, this,
             &Scene::moveInteractiveItems);
+    connect(m_mol_model, &MolModel::transientCoordinatesChanged, this,
+            &Scene::moveTransientlyChangedItems);
 
     connect(m_mol_model, &MolModel::selectionChanged, this,
             &Scene::onMolModelSelectionChanged);
@@ -131,9 +139,11 @@ Scene::~Scene()
 
 void Scene::moveInteractiveItems()
 {
+    auto atom_items = getInteractiveItems(InteractiveItemFlag::ATOM_OR_MONOMER);
+    auto bond_items =
+        getInteractiveItems(InteractiveItemFlag::BOND_OR_CONNECTOR);
     update_conf_for_mol_graphics_items(
-        getInteractiveItems(InteractiveItemFlag::ATOM_OR_MONOMER),
-        getInteractiveItems(InteractiveItemFlag::BOND_OR_CONNECTOR),
+        atom_items, bond_items,
         getInteractiveItems(InteractiveItemFlag::S_GROUP),
         *m_mol_model->getMol());
     for (auto* non_mol_obj : m_mol_model->getNonMolecularObjects()) {
@@ -142,6 +152,105 @@ void Scene::moveInteractiveItems()
         non_mol_item->setPos(to_scene_xy(non_mol_obj->getCoords()));
         non_mol_item->updateCachedData();
     }
+    updateBatchedPainting(atom_items + bond_items);
+    const auto* mol = m_mol_model->getMol();
+    std::vector<const RDKit::Atom*> atoms;
+    for (const auto* atom : mol->atoms()) {
+        atoms.push_back(atom);
+    }
+    std::vector<const RDKit::Bond*> bonds;
+    for (const auto* bond : mol->bonds()) {
+        bonds.push_back(bond);
+    }
+    m_spatial_index.move(atoms, bonds);
+    updateSelectionHighlighting();
+    updateHaloHighlighting();
+    m_scene_tool->onStructureUpdated();
+}
+
+void Scene::moveTransientlyChangedItems(
+    const std::unordered_set<const RDKit::Atom*>& atoms,
+    const std::unordered_set<const NonMolecularObject*>& non_molecular_objects)
+{
+    const auto* mol = m_mol_model->getMol();
+    // atom labels are placed away from neighboring atoms, so the neighbors of
+    // moved atoms need updating too
+    std::vector<bool> atoms_to_update(mol->getNumAtoms(), false);
+    for (const auto* atom : atoms) {
+        atoms_to_update[atom->getIdx()] = true;
+        for (const auto* neighbor : mol->atomNeighbors(atom)) {
+            atoms_to_update[neighbor->getIdx()] = true;
+        }
+    }
+    // bonds are drawn relative to their atoms' labels and neighbors, and ring
+    // bonds are drawn relative to the center of their ring
+    std::vector<bool> bonds_to_update(mol->getNumBonds(), false);
+    for (const auto* bond : mol->bonds()) {
+        bonds_to_update[bond->getIdx()] =
+            atoms_to_update[bond->getBeginAtomIdx()] ||
+            atoms_to_update[bond->getEndAtomIdx()];
+    }
+    const auto* ring_info = mol->getRingInfo();
+    if (ring_info->isInitialized()) {
+        const auto& atom_rings = ring_info->atomRings();
+        const auto& bond_rings = ring_info->bondRings();
+        for (size_t i = 0; i < atom_rings.size(); ++i) {
+            bool ring_moved = std::any_of(
+                atom_rings[i].begin(), atom_rings[i].end(),
+                [&](int atom_idx) { return atoms_to_update[atom_idx]; });
+            if (ring_moved) {
+                for (auto bond_idx : bond_rings[i]) {
+                    bonds_to_update[bond_idx] = true;
+                }
+            }
+        }
+    }
+
+    QList<QGraphicsItem*> atom_items;
+    std::vector<const RDKit::Atom*> moved_atoms;
+    for (const auto* atom : mol->atoms()) {
+        if (atoms_to_update[atom->getIdx()]) {
+            atom_items.append(m_atom_to_atom_item.at(atom));
+            moved_atoms.push_back(atom);
+        }
+    }
+    QList<QGraphicsItem*> bond_items;
+    std::vector<const RDKit::Bond*> moved_bonds;
+    for (const auto* bond : mol->bonds()) {
+        if (!bonds_to_update[bond->getIdx()]) {
+            continue;
+        }
+        moved_bonds.push_back(bond);
+        for (const auto* bond_to_item :
+             {&m_bond_to_bond_item, &m_bond_to_secondary_connection_item}) {
+            if (auto item = bond_to_item->find(bond);
+                item != bond_to_item->end()) {
+                bond_items.append(item->second);
+            }
+        }
+    }
+    QList<QGraphicsItem*> s_group_items;
+    for (auto [s_group, s_group_item] : m_s_group_to_s_group_item) {
+        const auto& s_group_atoms = s_group->getAtoms();
+        if (std::any_of(s_group_atoms.begin(), s_group_atoms.end(),
+                        [&](auto atom_idx) {
+                            return atoms_to_update[atom_idx];
+                        })) {
+            s_group_items.append(s_group_item);
+        }
+    }
+    update_conf_for_mol_graphics_items(atom_items, bond_items, s_group_items,
+                                       *mol);
+    for (auto* non_mol_obj : non_molecular_objects) {
+        auto* non_mol_item =
+            m_non_molecular_to_non_molecular_item.at(non_mol_obj);
+        non_mol_item->setPos(to_scene_xy(non_mol_obj->getCoords()));
+        non_mol_item->updateCachedData();
+    }
+    updateBatchedPainting(atom_items + bond_items);
+    // neighboring atoms' labels may have been repositioned, so their entries
+    // are updated along with those of the moved atoms
+    m_spatial_index.move(moved_atoms, moved_bonds);
     updateSelectionHighlighting();
     updateHaloHighlighting();
     m_scene_tool->onStructureUpdated();
@@ -153,26 +262,7 @@ void Scene::updateItems(const WhatChangedType what_changed)
 
     if (what_changed & WhatChanged::MOLECULE) {
         updateMonomerLabelSizeOnModel();
-        clearInteractiveItems(InteractiveItemFlag::MOLECULAR_OR_MONOMERIC);
-        const auto* mol = m_mol_model->getMol();
-        std::vector<QGraphicsItem*> all_items;
-        auto atom_display_settings_ptr =
-            m_sketcher_model->getAtomDisplaySettingsPtr();
-        auto bond_display_settings_ptr =
-            m_sketcher_model->getBondDisplaySettingsPtr();
-
-        std::tie(all_items, m_atom_to_atom_item, m_bond_to_bond_item,
-                 m_bond_to_secondary_connection_item,
-                 m_s_group_to_s_group_item) =
-            create_graphics_items_for_mol(
-                mol, m_fonts, *atom_display_settings_ptr,
-                *bond_display_settings_ptr,
-                m_sketcher_model->hasDarkColorScheme());
-
-        for (auto* item : all_items) {
-            addItem(item);
-            m_interactive_items.insert(item);
-        }
+        updateMolecularItems();
         clearHovered();
     }
     if (what_changed & WhatChanged::NON_MOL_OBJS) {
@@ -196,6 +286,246 @@ void Scene::updateItems(const WhatChangedType what_changed)
     m_scene_tool->onStructureUpdated();
 }
 
+void Scene::updateMolecularItems()
+{
+    const auto* mol = m_mol_model->getMol();
+    const auto& atom_display_settings =
+        *m_sketcher_model->getAtomDisplaySettingsPtr();
+    const auto& bond_display_settings =
+        *m_sketcher_model->getBondDisplaySettingsPtr();
+    bool is_dark_mode = m_sketcher_model->hasDarkColorScheme();
+
+    // figure out which atoms need their items updated: any atom that was added
+    // or changed, and its neighbors, since atom labels are placed away from
+    // neighboring atoms
+    auto num_atoms = mol->getNumAtoms();
+    auto num_bonds = mol->getNumBonds();
+    std::vector<AtomTag> atom_tags(num_atoms);
+    std::vector<std::string> atom_keys(num_atoms);
+    std::vector<bool> atoms_to_update(num_atoms, false);
+    auto mark_atom_and_neighbors_to_update = [&](const RDKit::Atom* atom) {
+        atoms_to_update[atom->getIdx()] = true;
+        for (const auto* neighbor : mol->atomNeighbors(atom)) {
+            atoms_to_update[neighbor->getIdx()] = true;
+        }
+    };
+    for (const auto* atom : mol->atoms()) {
+        auto idx = atom->getIdx();
+        atom_tags[idx] = m_mol_model->getTagForAtom(atom);
+        atom_keys[idx] = get_atom_item_key(atom);
+        auto record = m_atom_tag_to_item_record.find(atom_tags[idx]);
+        if (record == m_atom_tag_to_item_record.end() ||
+            record->second.key != atom_keys[idx]) {
+            mark_atom_and_neighbors_to_update(atom);
+        }
+    }
+    std::vector<BondTag> bond_tags(num_bonds);
+    std::vector<std::string> bond_keys(num_bonds);
+    for (const auto* bond : mol->bonds()) {
+        auto idx = bond->getIdx();
+        bond_tags[idx] = m_mol_model->getTagForBond(bond);
+        bond_keys[idx] = get_bond_item_key(bond);
+        auto record = m_bond_tag_to_item_record.find(bond_tags[idx]);
+        if (record == m_bond_tag_to_item_record.end() ||
+            record->second.key != bond_keys[idx] ||
+            record->second.begin_atom_tag !=
+                atom_tags[bond->getBeginAtomIdx()] ||
+            record->second.end_atom_tag != atom_tags[bond->getEndAtomIdx()]) {
+            mark_atom_and_neighbors_to_update(bond->getBeginAtom());
+            mark_atom_and_neighbors_to_update(bond->getEndAtom());
+        }
+    }
+    // Deleted atoms and bonds don't need to be handled separately, since they
+    // change the number of bonds, and therefore the keys, of their neighbors.
+
+    // bonds are drawn relative to their atoms' labels and neighbors, and ring
+    // bonds are drawn relative to the center of their ring
+    std::vector<bool> bonds_to_update(num_bonds, false);
+    for (const auto* bond : mol->bonds()) {
+        bonds_to_update[bond->getIdx()] =
+            atoms_to_update[bond->getBeginAtomIdx()] ||
+            atoms_to_update[bond->getEndAtomIdx()];
+    }
+    const auto* ring_info = mol->getRingInfo();
+    if (ring_info->isInitialized()) {
+        const auto& atom_rings = ring_info->atomRings();
+        const auto& bond_rings = ring_info->bondRings();
+        for (size_t i = 0; i < atom_rings.size(); ++i) {
+            bool ring_changed = std::any_of(
+                atom_rings[i].begin(), atom_rings[i].end(),
+                [&](int atom_idx) { return atoms_to_update[atom_idx]; });
+            if (ring_changed) {
+                for (auto bond_idx : bond_rings[i]) {
+                    bonds_to_update[bond_idx] = true;
+                }
+            }
+        }
+    }
+
+    auto add_interactive_item = [this](QGraphicsItem* item) {
+        if (item != nullptr) {
+            addItem(item);
+            m_interactive_items.insert(item);
+        }
+    };
+    auto delete_interactive_item = [this](QGraphicsItem* item) {
+        if (item != nullptr) {
+            removeItem(item);
+            m_interactive_items.erase(item);
+            delete item;
+        }
+    };
+
+    // S-group items refer to the S-groups themselves, which don't survive
+    // changes to the molecule, and there are few of them, so we recreate them
+    clearInteractiveItems(InteractiveItemFlag::S_GROUP);
+    m_s_group_to_s_group_item =
+        create_graphics_items_for_s_groups(mol, m_fonts);
+    for (auto [s_group, s_group_item] : m_s_group_to_s_group_item) {
+        add_interactive_item(s_group_item);
+    }
+
+    // Reuse the existing item for each atom when possible.  AtomItems can be
+    // updated in place, but monomer items are recreated when their monomer
+    // changes, since that may require a different type of item.
+    std::unordered_map<AtomTag, AtomItemRecord> atom_tag_to_item_record;
+    std::unordered_set<AtomTag> recreated_atom_tags;
+    m_atom_to_atom_item.clear();
+    for (const auto* atom : mol->atoms()) {
+        auto idx = atom->getIdx();
+        auto atom_tag = atom_tags[idx];
+        QGraphicsItem* item = nullptr;
+        auto record = m_atom_tag_to_item_record.find(atom_tag);
+        if (record != m_atom_tag_to_item_record.end()) {
+            bool is_atom_item =
+                qgraphicsitem_cast<AtomItem*>(record->second.item) != nullptr;
+            bool can_reuse = is_atom_monomeric(atom)
+                                 ? !is_atom_item &&
+                                       record->second.key == atom_keys[idx]
+                                 : is_atom_item;
+            if (can_reuse) {
+                item = record->second.item;
+                m_atom_tag_to_item_record.erase(record);
+            }
+        }
+        if (item == nullptr) {
+            item = create_graphics_item_for_atom(atom, m_fonts,
+                                                 atom_display_settings,
+                                                 is_dark_mode);
+            add_interactive_item(item);
+            recreated_atom_tags.insert(atom_tag);
+        } else {
+            auto* atom_item = static_cast<AbstractAtomOrMonomerItem*>(item);
+            atom_item->setAtom(atom);
+            if (atoms_to_update[idx]) {
+                item->setPos(
+                    to_scene_xy(mol->getConformer().getAtomPos(idx)));
+                item->setVisible(
+                    !is_dummy_atom_for_variable_attachment_bond(atom));
+                atom_item->updateCachedData();
+            }
+        }
+        m_atom_to_atom_item[atom] = item;
+        atom_tag_to_item_record[atom_tag] = {item, std::move(atom_keys[idx])};
+    }
+
+    // Reuse the existing items for each bond unless the bond now connects
+    // different atoms, or the items for its atoms were recreated
+    std::unordered_map<BondTag, BondItemRecord> bond_tag_to_item_record;
+    m_bond_to_bond_item.clear();
+    m_bond_to_secondary_connection_item.clear();
+    for (const auto* bond : mol->bonds()) {
+        auto idx = bond->getIdx();
+        auto bond_tag = bond_tags[idx];
+        auto begin_atom_tag = atom_tags[bond->getBeginAtomIdx()];
+        auto end_atom_tag = atom_tags[bond->getEndAtomIdx()];
+        std::optional<BondItemRecord> reused_record;
+        auto record = m_bond_tag_to_item_record.find(bond_tag);
+        if (record != m_bond_tag_to_item_record.end() &&
+            record->second.begin_atom_tag == begin_atom_tag &&
+            record->second.end_atom_tag == end_atom_tag &&
+            !recreated_atom_tags.count(begin_atom_tag) &&
+            !recreated_atom_tags.count(end_atom_tag) &&
+            (record->second.secondary_connection_item != nullptr) ==
+                contains_two_monomer_linkages(bond)) {
+            reused_record = std::move(record->second);
+            m_bond_tag_to_item_record.erase(record);
+        }
+
+        QGraphicsItem* item = nullptr;
+        QGraphicsItem* secondary_connection_item = nullptr;
+        if (reused_record.has_value()) {
+            item = reused_record->item;
+            secondary_connection_item =
+                reused_record->secondary_connection_item;
+            for (auto* bond_item : {item, secondary_connection_item}) {
+                if (bond_item == nullptr) {
+                    continue;
+                }
+                auto* bond_or_connector_item =
+                    static_cast<AbstractBondOrConnectorItem*>(bond_item);
+                bond_or_connector_item->setBond(bond);
+                if (bonds_to_update[idx]) {
+                    bond_or_connector_item->updateCachedData();
+                }
+            }
+        } else {
+            std::tie(item, secondary_connection_item) =
+                create_graphics_items_for_bond(
+                    bond, m_atom_to_atom_item.at(bond->getBeginAtom()),
+                    m_atom_to_atom_item.at(bond->getEndAtom()), m_fonts,
+                    bond_display_settings, is_dark_mode);
+            add_interactive_item(item);
+            add_interactive_item(secondary_connection_item);
+        }
+        if (item != nullptr) {
+            m_bond_to_bond_item[bond] = item;
+        }
+        if (secondary_connection_item != nullptr) {
+            m_bond_to_secondary_connection_item[bond] =
+                secondary_connection_item;
+        }
+        bond_tag_to_item_record[bond_tag] = {
+            item, secondary_connection_item, begin_atom_tag, end_atom_tag,
+            std::move(bond_keys[idx])};
+    }
+
+    // delete the items that weren't reused.  Bond items refer to their atom
+    // items, so they must be deleted first.
+    for (auto& [bond_tag, record] : m_bond_tag_to_item_record) {
+        delete_interactive_item(record.item);
+        delete_interactive_item(record.secondary_connection_item);
+    }
+    for (auto& [atom_tag, record] : m_atom_tag_to_item_record) {
+        delete_interactive_item(record.item);
+    }
+    m_atom_tag_to_item_record = std::move(atom_tag_to_item_record);
+    m_bond_tag_to_item_record = std::move(bond_tag_to_item_record);
+
+    m_large_molecule_mode = num_atoms > LARGE_MOLECULE_ATOM_THRESHOLD;
+    for (auto [atom, item] : m_atom_to_atom_item) {
+        static_cast<AbstractGraphicsItem*>(item)->setLargeMoleculeMode(
+            m_large_molecule_mode);
+    }
+    for (auto [bond, item] : m_bond_to_bond_item) {
+        static_cast<AbstractGraphicsItem*>(item)->setLargeMoleculeMode(
+            m_large_molecule_mode);
+    }
+    QList<QGraphicsItem*> updated_items;
+    for (auto [atom, item] : m_atom_to_atom_item) {
+        if (atoms_to_update[atom->getIdx()]) {
+            updated_items.append(item);
+        }
+    }
+    for (auto [bond, item] : m_bond_to_bond_item) {
+        if (bonds_to_update[bond->getIdx()]) {
+            updated_items.append(item);
+        }
+    }
+    updateBatchedPainting(updated_items);
+    updateSpatialIndex();
+}
+
 void Scene::updateItemSelection()
 {
     clearSelection();
@@ -264,6 +594,10 @@ QRectF Scene::getSceneItemsBoundingRect() const
 
 void Scene::clearInteractiveItems(const InteractiveItemFlagType types)
 {
+    if (types & InteractiveItemFlag::MOLECULAR_OR_MONOMERIC) {
+        // the spatial index refers to the items that are about to be deleted
+        m_spatial_index.clear();
+    }
     // remove all interactive items and reset the rdkit molecule; this will
     // preserve items include selection paths, highlighting items, and
     // potentially the watermark managed by the SketcherWidget
@@ -274,10 +608,12 @@ void Scene::clearInteractiveItems(const InteractiveItemFlagType types)
     }
     if (types & InteractiveItemFlag::ATOM_OR_MONOMER) {
         m_atom_to_atom_item.clear();
+        m_atom_tag_to_item_record.clear();
     }
     if (types & InteractiveItemFlag::BOND_OR_CONNECTOR) {
         m_bond_to_bond_item.clear();
         m_bond_to_secondary_connection_item.clear();
+        m_bond_tag_to_item_record.clear();
     }
     if (types & InteractiveItemFlag::S_GROUP) {
         m_s_group_to_s_group_item.clear();
@@ -331,7 +667,9 @@ void Scene::onDisplaySettingsChanged()
 
     // refresh the scene's items in case something changed: e.g. when valence
     // errors are hidden on a C the label disappears and all bonds need to be
-    // updated
+    // updated.  The item keys don't cover the display settings, so we recreate
+    // every item.
+    clearInteractiveItems(InteractiveItemFlag::MOLECULAR_OR_MONOMERIC);
     updateItems(WhatChanged::MOLECULE);
 }
 
@@ -347,10 +685,9 @@ void Scene::updateSceneToolAfterSelection()
 
 void Scene::updateHaloHighlighting()
 {
-    for (auto* item : m_halo_highlighting_item->childItems()) {
-        m_halo_highlighting_item->removeFromGroup(item);
-        delete item;
-    }
+    // reuse the existing items where possible so that their cached
+    // highlighting paths don't need to be recalculated
+    size_t num_items_used = 0;
     for (auto [atoms, bonds, color] : m_mol_model->getHaloHighlighting()) {
         // we want two separate items, with different Z values for atoms and
         // bonds, so we can always have atoms drawn on top of bonds of the
@@ -367,13 +704,27 @@ void Scene::updateHaloHighlighting()
         }
         for (auto [items, Z] : {std::make_pair(atom_items, atom_Z),
                                 std::make_pair(bond_items, bond_Z)}) {
-            auto* item = new HaloHighlightingItem(Z);
+            HaloHighlightingItem* item = nullptr;
+            if (num_items_used < m_halo_highlighting_items.size()) {
+                item = m_halo_highlighting_items[num_items_used];
+                item->setZValue(Z);
+            } else {
+                item = new HaloHighlightingItem(Z);
+                m_halo_highlighting_item->addToGroup(item);
+                m_halo_highlighting_items.push_back(item);
+            }
+            ++num_items_used;
             item->setPen(color);
             item->setBrush(color);
             item->highlightItems(items);
-            m_halo_highlighting_item->addToGroup(item);
         }
     };
+    while (m_halo_highlighting_items.size() > num_items_used) {
+        auto* item = m_halo_highlighting_items.back();
+        m_halo_highlighting_items.pop_back();
+        m_halo_highlighting_item->removeFromGroup(item);
+        delete item;
+    }
 }
 
 void Scene::mousePressEvent(QGraphicsSceneMouseEvent* event)
@@ -540,9 +891,25 @@ AbstractGraphicsItem*
 Scene::getTopInteractiveItemAt(const QPointF& pos,
                                const InteractiveItemFlagType types) const
 {
-    for (auto* item : items(pos)) {
-        if (m_interactive_items.count(item) &&
-            item_matches_type_flag(item, types)) {
+    auto is_match = [&pos, types](QGraphicsItem* item) {
+        return item->isVisible() && item_matches_type_flag(item, types) &&
+               item->contains(item->mapFromScene(pos));
+    };
+    // non-molecular objects and S-groups are stacked above all atoms and
+    // bonds, and there are few of them, so we check them directly instead of
+    // indexing them
+    for (auto [non_mol_obj, item] : m_non_molecular_to_non_molecular_item) {
+        if (is_match(item)) {
+            return item;
+        }
+    }
+    for (auto [s_group, item] : m_s_group_to_s_group_item) {
+        if (is_match(item)) {
+            return item;
+        }
+    }
+    for (auto* item : m_spatial_index.getItemsAt(pos)) {
+        if (item_matches_type_flag(item, types)) {
             // all interactive items are AbstractGraphicsItem subclasses, so
             // we can safely use static_cast here
             return static_cast<AbstractGraphicsItem*>(item);
@@ -552,24 +919,31 @@ Scene::getTopInteractiveItemAt(const QPointF& pos,
 }
 
 QList<QGraphicsItem*>
-Scene::getCollidingItemsUsingBondMidpoints(QGraphicsItem* item) const
+Scene::getInteractiveItemsInPolygon(const QPolygonF& polygon) const
 {
-    auto items = collidingItems(item);
-    auto polygon = item->shape().toFillPolygon();
-
-    // Exclude all bonds whose center point is outside the polygon
-    auto is_not_bond_with_center_outside_polygon = [&polygon](auto item) {
-        auto bond = dynamic_cast<AbstractBondOrConnectorItem*>(item);
-        if (bond == nullptr) {
-            return true;
+    auto items = m_spatial_index.getItemsInPolygon(polygon);
+    // there are relatively few S-groups and non-molecular objects, so we test
+    // them against the polygon directly
+    auto polygon_rect = polygon.boundingRect();
+    QPainterPath path;
+    path.addPolygon(polygon);
+    path.closeSubpath();
+    auto add_if_colliding = [&items, &polygon_rect,
+                             &path](QGraphicsItem* item) {
+        if (item->isVisible() &&
+            item->sceneBoundingRect().intersects(polygon_rect) &&
+            item->collidesWithPath(item->mapFromScene(path))) {
+            items.append(item);
         }
-        return polygon.containsPoint(bond->mapToScene(bond->getMidpoint()),
-                                     Qt::WindingFill);
     };
-    QList<QGraphicsItem*> filtered_items;
-    std::copy_if(items.begin(), items.end(), std::back_inserter(filtered_items),
-                 is_not_bond_with_center_outside_polygon);
-    return filtered_items;
+    for (auto [s_group, s_group_item] : m_s_group_to_s_group_item) {
+        add_if_colliding(s_group_item);
+    }
+    for (auto [non_mol_obj, non_mol_item] :
+         m_non_molecular_to_non_molecular_item) {
+        add_if_colliding(non_mol_item);
+    }
+    return items;
 }
 
 QList<const QGraphicsItem*> Scene::ensureCompleteAttachmentPoints(
@@ -901,7 +1275,7 @@ void Scene::dragLeaveEvent(QGraphicsSceneDragDropEvent* event)
 
 QRectF Scene::getSelectionRect() const
 {
-    return m_selection_highlighting_item->shape().boundingRect();
+    return m_selection_highlighting_item->boundingRect();
 }
 
 void Scene::updateMonomerLabelSizeOnModel()
@@ -945,6 +1319,63 @@ Scene::getGraphicsItemForAtom(const RDKit::Atom* atom) const
     return m_atom_to_atom_item.at(atom);
 }
 
+bool Scene::isLargeMoleculeMode() const
+{
+    return m_large_molecule_mode;
+}
+
+void Scene::setBatchedPaintingEnabled(const bool enabled)
+{
+    if (enabled != m_batched_painting_enabled) {
+        m_batched_painting_enabled = enabled;
+        updateBatchedPainting();
+    }
+}
+
+bool Scene::isBatchedPainting() const
+{
+    return m_batched_painting_enabled || m_large_molecule_mode;
+}
+
+const SceneSpatialIndex& Scene::getSpatialIndex() const
+{
+    return m_spatial_index;
+}
+
+void Scene::updateSpatialIndex()
+{
+    m_spatial_index.update(*m_mol_model->getMol(), m_atom_to_atom_item,
+                           m_bond_to_bond_item,
+                           m_bond_to_secondary_connection_item);
+}
+
+void Scene::updateBatchedPainting(const QList<QGraphicsItem*>& changed_items)
+{
+    bool batched = isBatchedPainting();
+    if (!batched && (m_batched_molecule_item == nullptr ||
+                     !m_batched_molecule_item->isVisible())) {
+        return;
+    }
+    if (m_batched_molecule_item == nullptr) {
+        // the item is only created once it's needed, since most scenes never
+        // use it
+        m_batched_molecule_item =
+            new BatchedMoleculeItem(m_atom_to_atom_item, m_bond_to_bond_item);
+        addItem(m_batched_molecule_item);
+    }
+    // the items remain in the scene for hit-testing, but Qt won't paint them
+    for (auto [atom, item] : m_atom_to_atom_item) {
+        item->setFlag(QGraphicsItem::ItemHasNoContents, batched);
+    }
+    for (auto [bond, item] : m_bond_to_bond_item) {
+        item->setFlag(QGraphicsItem::ItemHasNoContents, batched);
+    }
+    m_batched_molecule_item->setVisible(batched);
+    if (batched) {
+        m_batched_molecule_item->updateCachedData(changed_items);
+    }
+}
+
 } // namespace sketcher
 } // namespace schrodinger
 
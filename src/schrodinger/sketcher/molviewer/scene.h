@@ -3,7 +3,9 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <variant>
+#include <vector>
 
 #include <QGraphicsScene>
 #include <QPolygonF>
@@ -16,6 +18,7 @@
 #include "schrodinger/sketcher/molviewer/constants.h"
 #include "schrodinger/sketcher/molviewer/fonts.h"
 #include "schrodinger/sketcher/molviewer/predictive_highlighting_item.h"
+#include "schrodinger/sketcher/molviewer/scene_spatial_index.h"
 #include "schrodinger/sketcher/molviewer/selection_highlighting_item.h"
 #include "schrodinger/sketcher/molviewer/selection_items.h"
 #include "schrodinger/sketcher/tool/abstract_scene_tool.h"
@@ -39,7 +42,9 @@ namespace sketcher
 
 class AbstractGraphicsItem;
 class AtomItem;
+class BatchedMoleculeItem;
 class BondItem;
+class HaloHighlightingItem;
 class MolModel;
 class NonMolecularItem;
 class RotationItem;
@@ -140,13 +145,17 @@ class SKETCHER_API Scene : public QGraphicsScene
     getTopInteractiveItemAt(const QPointF& pos,
                             const InteractiveItemFlagType types) const;
 
-    //*
-    /* @return a list of all graphics items in the scene that collied with the
-     * given item, excluding bond items whose center doesn't fall within the
-     * bounds of the item
+    /**
+     * @return all interactive items that should be selected by a lasso or
+     * marquee selection of the given polygon, which is in Scene coordinates.
+     * Atoms and monomers are included if their position falls within the
+     * polygon, and bonds and connectors are included if their midpoint does.
+     * These tests use the molecule's coordinates, so this is cheap enough to
+     * call on every mouse move.  S-groups and non-molecular objects are
+     * included if their shape intersects the polygon.
      */
     QList<QGraphicsItem*>
-    getCollidingItemsUsingBondMidpoints(QGraphicsItem* item) const;
+    getInteractiveItemsInPolygon(const QPolygonF& polygon) const;
 
     /**
      * Make sure that the returned list includes graphics items for both an
@@ -194,6 +203,31 @@ class SKETCHER_API Scene : public QGraphicsScene
      */
     const QGraphicsItem* getGraphicsItemForAtom(const RDKit::Atom* atom) const;
 
+    /**
+     * @return whether the molecule is large enough to be displayed in
+     * large-molecule mode.  See LARGE_MOLECULE_ATOM_THRESHOLD.
+     */
+    bool isLargeMoleculeMode() const;
+
+    /**
+     * Set whether atoms and bonds are always painted in a single pass by a
+     * BatchedMoleculeItem instead of being painted individually.  Batched
+     * painting is always used in large-molecule mode.
+     */
+    void setBatchedPaintingEnabled(const bool enabled);
+
+    /**
+     * @return whether atoms and bonds are currently painted in a single pass
+     * by a BatchedMoleculeItem
+     */
+    bool isBatchedPainting() const;
+
+    /**
+     * @return a spatial index of the atoms and bonds in the scene, which is
+     * kept up to date as the molecule and its coordinates change
+     */
+    const SceneSpatialIndex& getSpatialIndex() const;
+
   signals:
     /**
      * Request that the widget import the given text in the given format
@@ -267,6 +301,17 @@ class SKETCHER_API Scene : public QGraphicsScene
      */
     void moveInteractiveItems();
 
+    /**
+     * update the positions of the items for the given atoms and non-molecular
+     * objects, as well as any items whose geometry depends on those atoms.
+     * Used during transient transforms (see MolModel::beginTransientTransform)
+     * so that the cost of a drag scales with the number of moved atoms.
+     */
+    void moveTransientlyChangedItems(
+        const std::unordered_set<const RDKit::Atom*>& atoms,
+        const std::unordered_set<const NonMolecularObject*>&
+            non_molecular_objects);
+
     /**
      * functions to select atoms, bonds and non molecular items in the scene
      * according to the selection info stored in m_mol_model.
@@ -288,6 +333,14 @@ class SKETCHER_API Scene : public QGraphicsScene
      */
     void updateMonomerLabelSizeOnModel();
 
+    /**
+     * Update the atom, bond, and S-group graphics items to match the MolModel.
+     * Items are only created or deleted for atoms and bonds that were added or
+     * removed, and existing items are only updated if their atom or bond, or a
+     * neighboring one, changed.  S-group items are always recreated.
+     */
+    void updateMolecularItems();
+
     /**
      * Update the path drawn to show selection highlighting.
      */
@@ -355,6 +408,11 @@ class SKETCHER_API Scene : public QGraphicsScene
     // highlight atoms and bonds with a single color, so we might need multiple
     // child items
     QGraphicsItemGroup* m_halo_highlighting_item = nullptr;
+    // the children of m_halo_highlighting_item in creation order, so that each
+    // halo highlight reuses the same item (and its cached paths) on every
+    // update
+    std::vector<HaloHighlightingItem*> m_halo_highlighting_items;
+    BatchedMoleculeItem* m_batched_molecule_item = nullptr;
     QGraphicsTextItem* m_simplified_stereo_label = nullptr;
     QPointF m_mouse_down_screen_pos;
 
@@ -375,6 +433,29 @@ class SKETCHER_API Scene : public QGraphicsScene
         m_bond_to_secondary_connection_item;
     std::unordered_map<const RDKit::SubstanceGroup*, SGroupItem*>
         m_s_group_to_s_group_item;
+    SceneSpatialIndex m_spatial_index;
+
+    /**
+     * The graphics items for each atom and bond tag, along with the key (see
+     * get_atom_item_key and get_bond_item_key) of the atom or bond each item
+     * was last drawn from.  These let updateMolecularItems find the items that
+     * need updating, even though undo and redo replace every RDKit object.
+     */
+    struct AtomItemRecord {
+        QGraphicsItem* item;
+        std::string key;
+    };
+    struct BondItemRecord {
+        // nullptr for bonds between a monomer and an atom
+        QGraphicsItem* item;
+        // nullptr unless the bond represents two monomer connections
+        QGraphicsItem* secondary_connection_item;
+        AtomTag begin_atom_tag;
+        AtomTag end_atom_tag;
+        std::string key;
+    };
+    std::unordered_map<AtomTag, AtomItemRecord> m_atom_tag_to_item_record;
+    std::unordered_map<BondTag, BondItemRecord> m_bond_tag_to_item_record;
     std::unordered_map<const NonMolecularObject*, NonMolecularItem*>
         m_non_molecular_to_non_molecular_item;
     std::shared_ptr<AbstractSceneTool> m_scene_tool;
@@ -399,6 +480,24 @@ class SKETCHER_API Scene : public QGraphicsScene
      */
     std::vector<const RDKit::Atom*> m_context_menu_atoms;
     bool m_currently_dragging_atom;
+    bool m_large_molecule_mode = false;
+    bool m_batched_painting_enabled = false;
+
+    /**
+     * Switch between batched and individual painting of atoms and bonds as
+     * needed, and update the BatchedMoleculeItem's geometry after the atom and
+     * bond items have changed
+     *
+     * @param changed_items the atom and bond items that were updated, which
+     * need to be repainted even if their bounding rects didn't change
+     */
+    void updateBatchedPainting(const QList<QGraphicsItem*>& changed_items = {});
+
+    /**
+     * Rebuild the spatial index after atom or bond items have been added or
+     * removed.  Moved items are updated with SceneSpatialIndex::move instead.
+     */
+    void updateSpatialIndex();
 
     /**
      * Check if we are currently displaying a simplified stereo annotation
@@ -0,0 +1,321 @@
+#include "schrodinger/sketcher/molviewer/scene_spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include <QGraphicsItem>
+#include <rdkit/GraphMol/ROMol.h>
+
+#include "schrodinger/sketcher/molviewer/constants.h"
+#include "schrodinger/sketcher/molviewer/coord_utils.h"
+
+namespace schrodinger
+{
+namespace sketcher
+{
+
+// each grid cell is one bond long, which is also about the size of an atom
+// label
+static const qreal GRID_CELL_SIZE = BOND_LENGTH * VIEW_SCALE;
+
+static RDGeom::Point3D to_grid_point(const QPointF& pos)
+{
+    return RDGeom::Point3D(pos.x(), pos.y(), 0);
+}
+
+/**
+ * @return the bounding rect of the given item in Scene coordinates.  Atom and
+ * bond items are never transformed, so this is cheaper than sceneBoundingRect.
+ */
+static QRectF get_scene_rect(const QGraphicsItem* item)
+{
+    return item->boundingRect().translated(item->pos());
+}
+
+static void insert_into_grid(rdkit_extensions::SpatialGrid& grid,
+                             const unsigned int id, const QRectF& rect)
+{
+    grid.insert(id, to_grid_point(rect.topLeft()),
+                to_grid_point(rect.bottomRight()));
+}
+
+static void remove_from_grid(rdkit_extensions::SpatialGrid& grid,
+                             const unsigned int id, const QRectF& rect)
+{
+    grid.remove(id, to_grid_point(rect.topLeft()),
+                to_grid_point(rect.bottomRight()));
+}
+
+/**
+ * @return the rect to register an atom entry over, which covers both its item
+ * and its position
+ */
+static QRectF get_atom_rect(const QGraphicsItem* item, const QPointF& pos)
+{
+    return get_scene_rect(item) | QRectF(pos, pos);
+}
+
+/**
+ * @return the rect to register a bond entry over, which covers both its item
+ * and its segment
+ */
+static QRectF get_bond_rect(const QGraphicsItem* item, const QLineF& line)
+{
+    return get_scene_rect(item) | QRectF(line.p1(), line.p2()).normalized();
+}
+
+/**
+ * @return the distance from the given point to the closest point of the given
+ * line segment
+ */
+static qreal get_distance_to_segment(const QPointF& pos, const QLineF& line)
+{
+    auto delta = line.p2() - line.p1();
+    auto length_squared = QPointF::dotProduct(delta, delta);
+    qreal fraction = 0;
+    if (length_squared > 0) {
+        fraction = std::clamp(
+            QPointF::dotProduct(pos - line.p1(), delta) / length_squared, 0.0,
+            1.0);
+    }
+    return QLineF(pos, line.pointAt(fraction)).length();
+}
+
+SceneSpatialIndex::SceneSpatialIndex() :
+    m_atom_grid(GRID_CELL_SIZE),
+    m_bond_grid(GRID_CELL_SIZE)
+{
+}
+
+void SceneSpatialIndex::clear()
+{
+    m_atoms.clear();
+    m_bonds.clear();
+    m_atom_ids.clear();
+    m_bond_ids.clear();
+    m_atom_grid = rdkit_extensions::SpatialGrid(GRID_CELL_SIZE);
+    m_bond_grid = rdkit_extensions::SpatialGrid(GRID_CELL_SIZE);
+}
+
+void SceneSpatialIndex::update(
+    const RDKit::ROMol& mol,
+    const std::unordered_map<const RDKit::Atom*, QGraphicsItem*>&
+        atom_to_atom_item,
+    const std::unordered_map<const RDKit::Bond*, QGraphicsItem*>&
+        bond_to_bond_item,
+    const std::unordered_map<const RDKit::Bond*, QGraphicsItem*>&
+        bond_to_secondary_connection_item)
+{
+    clear();
+    if (!mol.getNumConformers()) {
+        return;
+    }
+    const auto& conf = mol.getConformer();
+    std::vector<QPointF> atom_positions(mol.getNumAtoms());
+    for (const auto* atom : mol.atoms()) {
+        auto idx = atom->getIdx();
+        atom_positions[idx] = to_scene_xy(conf.getAtomPos(idx));
+        auto item = atom_to_atom_item.find(atom);
+        if (item == atom_to_atom_item.end()) {
+            continue;
+        }
+        const auto& pos = atom_positions[idx];
+        auto rect = get_atom_rect(item->second, pos);
+        auto id = static_cast<unsigned int>(m_atoms.size());
+        insert_into_grid(m_atom_grid, id, rect);
+        m_atom_ids.emplace(atom, id);
+        m_atoms.push_back({atom, item->second, pos, rect});
+    }
+    for (const auto* bond : mol.bonds()) {
+        QLineF line(atom_positions[bond->getBeginAtomIdx()],
+                    atom_positions[bond->getEndAtomIdx()]);
+        for (const auto* bond_to_item :
+             {&bond_to_bond_item, &bond_to_secondary_connection_item}) {
+            auto item = bond_to_item->find(bond);
+            if (item == bond_to_item->end()) {
+                continue;
+            }
+            auto rect = get_bond_rect(item->second, line);
+            auto id = static_cast<unsigned int>(m_bonds.size());
+            insert_into_grid(m_bond_grid, id, rect);
+            m_bond_ids.emplace(bond, id);
+            m_bonds.push_back({bond, item->second, line, rect});
+        }
+    }
+}
+
+void SceneSpatialIndex::move(const std::vector<const RDKit::Atom*>& atoms,
+                             const std::vector<const RDKit::Bond*>& bonds)
+{
+    for (const auto* atom : atoms) {
+        auto id = m_atom_ids.find(atom);
+        if (id == m_atom_ids.end()) {
+            continue;
+        }
+        auto& entry = m_atoms[id->second];
+        const auto& conf = atom->getOwningMol().getConformer();
+        entry.pos = to_scene_xy(conf.getAtomPos(atom->getIdx()));
+        remove_from_grid(m_atom_grid, id->second, entry.rect);
+        entry.rect = get_atom_rect(entry.item, entry.pos);
+        insert_into_grid(m_atom_grid, id->second, entry.rect);
+    }
+    for (const auto* bond : bonds) {
+        auto first_id = m_bond_ids.find(bond);
+        if (first_id == m_bond_ids.end()) {
+            continue;
+        }
+        const auto& conf = bond->getOwningMol().getConformer();
+        QLineF line(to_scene_xy(conf.getAtomPos(bond->getBeginAtomIdx())),
+                    to_scene_xy(conf.getAtomPos(bond->getEndAtomIdx())));
+        for (auto id = first_id->second;
+             id < m_bonds.size() && m_bonds[id].bond == bond; ++id) {
+            auto& entry = m_bonds[id];
+            entry.line = line;
+            remove_from_grid(m_bond_grid, id, entry.rect);
+            entry.rect = get_bond_rect(entry.item, entry.line);
+            insert_into_grid(m_bond_grid, id, entry.rect);
+        }
+    }
+}
+
+std::vector<unsigned int>
+SceneSpatialIndex::getCandidates(const rdkit_extensions::SpatialGrid& grid,
+                                 const QRectF& rect)
+{
+    std::vector<unsigned int> ids;
+    grid.any_of(to_grid_point(rect.topLeft()),
+                to_grid_point(rect.bottomRight()), [&ids](auto id) {
+                    ids.push_back(id);
+                    return false;
+                });
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+QList<QGraphicsItem*> SceneSpatialIndex::getItemsAt(const QPointF& pos) const
+{
+    std::vector<std::pair<QGraphicsItem*, qreal>> hits;
+    auto add_if_hit = [&pos, &hits](QGraphicsItem* item, qreal distance) {
+        if (item->isVisible() && get_scene_rect(item).contains(pos) &&
+            item->contains(item->mapFromScene(pos))) {
+            hits.emplace_back(item, distance);
+        }
+    };
+    QRectF query_rect(pos, pos);
+    for (auto id : getCandidates(m_atom_grid, query_rect)) {
+        const auto& entry = m_atoms[id];
+        add_if_hit(entry.item, QLineF(pos, entry.pos).length());
+    }
+    for (auto id : getCandidates(m_bond_grid, query_rect)) {
+        const auto& entry = m_bonds[id];
+        add_if_hit(entry.item, get_distance_to_segment(pos, entry.line));
+    }
+    std::stable_sort(hits.begin(), hits.end(),
+                     [](const auto& hit1, const auto& hit2) {
+                         auto z1 = hit1.first->zValue();
+                         auto z2 = hit2.first->zValue();
+                         return z1 > z2 ||
+                                (z1 == z2 && hit1.second < hit2.second);
+                     });
+    QList<QGraphicsItem*> items;
+    for (const auto& [item, distance] : hits) {
+        items.append(item);
+    }
+    return items;
+}
+
+const RDKit::Atom* SceneSpatialIndex::getNearestAtom(const QPointF& pos,
+                                                     const qreal radius) const
+{
+    const RDKit::Atom* nearest_atom = nullptr;
+    qreal nearest_distance = std::numeric_limits<qreal>::max();
+    QRectF query_rect(pos - QPointF(radius, radius),
+                      pos + QPointF(radius, radius));
+    for (auto id : getCandidates(m_atom_grid, query_rect)) {
+        const auto& entry = m_atoms[id];
+        auto distance = QLineF(pos, entry.pos).length();
+        if (distance <= radius && distance < nearest_distance) {
+            nearest_atom = entry.atom;
+            nearest_distance = distance;
+        }
+    }
+    return nearest_atom;
+}
+
+const RDKit::Bond* SceneSpatialIndex::getNearestBond(const QPointF& pos,
+                                                     const qreal radius) const
+{
+    const RDKit::Bond* nearest_bond = nullptr;
+    qreal nearest_distance = std::numeric_limits<qreal>::max();
+    QRectF query_rect(pos - QPointF(radius, radius),
+                      pos + QPointF(radius, radius));
+    for (auto id : getCandidates(m_bond_grid, query_rect)) {
+        const auto& entry = m_bonds[id];
+        auto distance = get_distance_to_segment(pos, entry.line);
+        if (distance <= radius && distance < nearest_distance) {
+            nearest_bond = entry.bond;
+            nearest_distance = distance;
+        }
+    }
+    return nearest_bond;
+}
+
+std::vector<const RDKit::Atom*>
+SceneSpatialIndex::getAtomsInPolygon(const QPolygonF& polygon) const
+{
+    std::vector<const RDKit::Atom*> atoms;
+    for (auto id : getCandidates(m_atom_grid, polygon.boundingRect())) {
+        const auto& entry = m_atoms[id];
+        if (polygon.containsPoint(entry.pos, Qt::WindingFill)) {
+            atoms.push_back(entry.atom);
+        }
+    }
+    return atoms;
+}
+
+std::vector<const RDKit::Bond*>
+SceneSpatialIndex::getBondsInPolygon(const QPolygonF& polygon) const
+{
+    std::vector<const RDKit::Bond*> bonds;
+    for (auto id : getCandidates(m_bond_grid, polygon.boundingRect())) {
+        const auto& entry = m_bonds[id];
+        // bonds with two connector items are indexed twice
+        if ((bonds.empty() || bonds.back() != entry.bond) &&
+            polygon.containsPoint(entry.line.center(), Qt::WindingFill)) {
+            bonds.push_back(entry.bond);
+        }
+    }
+    return bonds;
+}
+
+QList<QGraphicsItem*>
+SceneSpatialIndex::getItemsInPolygon(const QPolygonF& polygon) const
+{
+    QList<QGraphicsItem*> items;
+    auto polygon_rect = polygon.boundingRect();
+    // check the bounding rect first since containsPoint is linear in the
+    // number of polygon points, which can be large for a lasso
+    auto contains = [&polygon, &polygon_rect](const QPointF& point) {
+        return polygon_rect.contains(point) &&
+               polygon.containsPoint(point, Qt::WindingFill);
+    };
+    for (auto id : getCandidates(m_atom_grid, polygon_rect)) {
+        const auto& entry = m_atoms[id];
+        if (entry.item->isVisible() && contains(entry.pos)) {
+            items.append(entry.item);
+        }
+    }
+    for (auto id : getCandidates(m_bond_grid, polygon_rect)) {
+        const auto& entry = m_bonds[id];
+        if (entry.item->isVisible() && contains(entry.line.center())) {
+            items.append(entry.item);
+        }
+    }
+    return items;
+}
+
+} // namespace sketcher
+} // namespace schrodinger
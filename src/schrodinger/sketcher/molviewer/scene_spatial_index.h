@@ -0,0 +1,164 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include <QLineF>
+#include <QList>
+#include <QPointF>
+#include <QPolygonF>
+#include <QRectF>
+#include <QtGlobal>
+
+#include "schrodinger/rdkit_extensions/helm/spatial_grid.h"
+#include "schrodinger/sketcher/definitions.h"
+
+class QGraphicsItem;
+
+namespace RDKit
+{
+class Atom;
+class Bond;
+class ROMol;
+} // namespace RDKit
+
+namespace schrodinger
+{
+namespace sketcher
+{
+
+/**
+ * A spatial index of the atoms and bonds shown in a Scene, which answers
+ * hit-testing, proximity, and lasso or rectangle queries without walking the Qt
+ * scene graph.  Atom positions and bond segments are taken straight from the
+ * molecule's conformer.  Each entry is also registered over the bounding rect
+ * of its graphics item, so that atom labels and the full width of bonds can be
+ * hit-tested.
+ *
+ * The index doesn't track changes itself.  It must be updated whenever the
+ * molecule or its coordinates change, and it must not be queried after any of
+ * the graphics items it refers to are deleted.
+ */
+class SKETCHER_API SceneSpatialIndex
+{
+  public:
+    SceneSpatialIndex();
+
+    /**
+     * Remove all atoms and bonds from the index
+     */
+    void clear();
+
+    /**
+     * Rebuild the index from the given molecule and graphics items.  Atoms and
+     * bonds without a graphics item are skipped.
+     *
+     * @param mol the molecule to index
+     * @param atom_to_atom_item a map of atom to the atom or monomer item
+     * representing it
+     * @param bond_to_bond_item a map of bond to the bond or connector item
+     * representing it
+     * @param bond_to_secondary_connection_item a map of bond to the second
+     * connector item for monomer bonds with two linkages
+     */
+    void
+    update(const RDKit::ROMol& mol,
+           const std::unordered_map<const RDKit::Atom*, QGraphicsItem*>&
+               atom_to_atom_item,
+           const std::unordered_map<const RDKit::Bond*, QGraphicsItem*>&
+               bond_to_bond_item,
+           const std::unordered_map<const RDKit::Bond*, QGraphicsItem*>&
+               bond_to_secondary_connection_item);
+
+    /**
+     * Update the index entries of the given atoms and bonds, which must
+     * already be in the index, from their current coordinates and graphics
+     * items.  This is much cheaper than a full update when only a few atoms
+     * have moved, such as while dragging.
+     *
+     * @param atoms the atoms to update
+     * @param bonds the bonds to update
+     */
+    void move(const std::vector<const RDKit::Atom*>& atoms,
+              const std::vector<const RDKit::Bond*>& bonds);
+
+    /**
+     * @return all visible atom, monomer, bond, and connector items whose shape
+     * contains the given position, topmost first.  Items with the same Z value
+     * are ordered by the distance from their atom or bond to the position.
+     */
+    QList<QGraphicsItem*> getItemsAt(const QPointF& pos) const;
+
+    /**
+     * @return the atom closest to the given position, or nullptr if there are
+     * no atoms within the given radius
+     */
+    const RDKit::Atom* getNearestAtom(const QPointF& pos,
+                                      const qreal radius) const;
+
+    /**
+     * @return the bond whose segment is closest to the given position, or
+     * nullptr if there are no bonds within the given radius
+     */
+    const RDKit::Bond* getNearestBond(const QPointF& pos,
+                                      const qreal radius) const;
+
+    /**
+     * @return all atoms whose position falls within the given polygon, which
+     * is in Scene coordinates
+     */
+    std::vector<const RDKit::Atom*>
+    getAtomsInPolygon(const QPolygonF& polygon) const;
+
+    /**
+     * @return all bonds whose midpoint falls within the given polygon, which is
+     * in Scene coordinates
+     */
+    std::vector<const RDKit::Bond*>
+    getBondsInPolygon(const QPolygonF& polygon) const;
+
+    /**
+     * @return all visible atom and monomer items whose atom position falls
+     * within the given polygon, followed by all visible bond and connector
+     * items whose midpoint falls within the polygon.  The polygon is in Scene
+     * coordinates.
+     */
+    QList<QGraphicsItem*> getItemsInPolygon(const QPolygonF& polygon) const;
+
+  protected:
+    struct AtomEntry {
+        const RDKit::Atom* atom;
+        QGraphicsItem* item;
+        QPointF pos;
+        // the rect that the entry is registered over in the grid
+        QRectF rect;
+    };
+
+    struct BondEntry {
+        const RDKit::Bond* bond;
+        QGraphicsItem* item;
+        QLineF line;
+        // the rect that the entry is registered over in the grid
+        QRectF rect;
+    };
+
+    /**
+     * @return the ids of all entries in the given grid that may overlap the
+     * given rect, with duplicates removed
+     */
+    static std::vector<unsigned int>
+    getCandidates(const rdkit_extensions::SpatialGrid& grid,
+                  const QRectF& rect);
+
+    std::vector<AtomEntry> m_atoms;
+    std::vector<BondEntry> m_bonds;
+    std::unordered_map<const RDKit::Atom*, unsigned int> m_atom_ids;
+    // the id of the first entry of each bond.  Bonds with two connector items
+    // have two consecutive entries.
+    std::unordered_map<const RDKit::Bond*, unsigned int> m_bond_ids;
+    rdkit_extensions::SpatialGrid m_atom_grid;
+    rdkit_extensions::SpatialGrid m_bond_grid;
+};
+
+} // namespace sketcher
+} // namespace schrodinger
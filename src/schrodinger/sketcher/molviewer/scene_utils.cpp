@@ -1,5 +1,9 @@
 #include "schrodinger/sketcher/molviewer/scene_utils.h"
 
+#include <array>
+#include <iterator>
+#include <string>
+
 #include <QBitmap>
 #include <QColor>
 #include <QFile>
@@ -17,10 +21,12 @@
 #include <QSvgRenderer>
 #include <QTransform>
 
+#include <fmt/format.h>
 #include <rdkit/GraphMol/ROMol.h>
 #include <rdkit/GraphMol/MonomerInfo.h>
 
 #include "schrodinger/rdkit_extensions/helm.h"
+#include "schrodinger/rdkit_extensions/helm/monomer_coordgen.h"
 #include "schrodinger/sketcher/rdkit/sgroup.h"
 #include "schrodinger/sketcher/rdkit/variable_attachment_bond_core.h"
 #include "schrodinger/sketcher/molviewer/abstract_atom_or_monomer_item.h"
@@ -43,6 +49,7 @@
 #include "schrodinger/sketcher/molviewer/coord_utils.h"
 #include "schrodinger/sketcher/rdkit/rgroup.h"
 #include "schrodinger/sketcher/rdkit/monomeric.h"
+#include "schrodinger/sketcher/rdkit/queries.h"
 
 namespace schrodinger
 {
@@ -76,6 +83,75 @@ AbstractMonomerItem* get_monomer_graphics_item(const RDKit::Atom* atom,
     }
 }
 
+QGraphicsItem*
+create_graphics_item_for_atom(const RDKit::Atom* atom, const Fonts& fonts,
+                              const AtomDisplaySettings& atom_display_settings,
+                              const bool is_dark_mode)
+{
+    QGraphicsItem* atom_item =
+        is_atom_monomeric(atom)
+            ? static_cast<QGraphicsItem*>(
+                  get_monomer_graphics_item(atom, fonts, is_dark_mode))
+            : new AtomItem(atom, fonts, atom_display_settings);
+    const auto& conformer = atom->getOwningMol().getConformer();
+    atom_item->setPos(to_scene_xy(conformer.getAtomPos(atom->getIdx())));
+    if (is_dummy_atom_for_variable_attachment_bond(atom)) {
+        // hide the dummy atoms for variable attachment bonds
+        atom_item->setVisible(false);
+    }
+    return atom_item;
+}
+
+std::pair<QGraphicsItem*, QGraphicsItem*> create_graphics_items_for_bond(
+    const RDKit::Bond* bond, const QGraphicsItem* from_graphics_item,
+    const QGraphicsItem* to_graphics_item, const Fonts& fonts,
+    const BondDisplaySettings& bond_display_settings, const bool is_dark_mode)
+{
+    const auto* from_atom_item =
+        qgraphicsitem_cast<const AtomItem*>(from_graphics_item);
+    const auto* to_atom_item =
+        qgraphicsitem_cast<const AtomItem*>(to_graphics_item);
+    const auto* from_monomer_item =
+        dynamic_cast<const AbstractMonomerItem*>(from_graphics_item);
+    const auto* to_monomer_item =
+        dynamic_cast<const AbstractMonomerItem*>(to_graphics_item);
+    if (from_atom_item != nullptr && to_atom_item != nullptr) {
+        return {new BondItem(bond, *from_atom_item, *to_atom_item, fonts,
+                             bond_display_settings),
+                nullptr};
+    } else if (from_monomer_item != nullptr && to_monomer_item != nullptr) {
+        auto connector_item = new MonomerConnectorItem(
+            bond, *from_monomer_item, *to_monomer_item,
+            /* is_secondary_connection = */ false, is_dark_mode);
+        MonomerConnectorItem* secondary_connector_item = nullptr;
+        if (contains_two_monomer_linkages(bond)) {
+            secondary_connector_item = new MonomerConnectorItem(
+                bond, *from_monomer_item, *to_monomer_item,
+                /* is_secondary_connection = */ true, is_dark_mode);
+        }
+        return {connector_item, secondary_connector_item};
+    }
+    // we skip bonds that go between a monomer and an atomistic atom
+    return {nullptr, nullptr};
+}
+
+std::unordered_map<const RDKit::SubstanceGroup*, SGroupItem*>
+create_graphics_items_for_s_groups(const RDKit::ROMol* mol, const Fonts& fonts)
+{
+    std::unordered_map<const RDKit::SubstanceGroup*, SGroupItem*>
+        s_group_to_s_group_items;
+    for (auto& sgroup : getSubstanceGroups(*mol)) {
+        if (rdkit_extensions::is_polymer_annotation_s_group(sgroup) ||
+            rdkit_extensions::is_supplementary_information_s_group(sgroup)) {
+            // this isn't an actual S-group; it's just additional data about a
+            // monomeric model
+            continue;
+        }
+        s_group_to_s_group_items[&sgroup] = new SGroupItem(sgroup, fonts);
+    }
+    return s_group_to_s_group_items;
+}
+
 std::tuple<std::vector<QGraphicsItem*>,
            std::unordered_map<const RDKit::Atom*, QGraphicsItem*>,
            std::unordered_map<const RDKit::Bond*, QGraphicsItem*>,
@@ -94,34 +170,21 @@ create_graphics_items_for_mol(const RDKit::ROMol* mol, const Fonts& fonts,
         // a ConformerException.
         return {{}, {}, {}, {}, {}};
     }
-    RDKit::Conformer conformer = mol->getConformer();
 
     std::vector<QGraphicsItem*> all_items;
     std::unordered_map<const RDKit::Atom*, QGraphicsItem*> atom_to_atom_item;
     std::unordered_map<const RDKit::Bond*, QGraphicsItem*> bond_to_bond_item;
     std::unordered_map<const RDKit::Bond*, QGraphicsItem*>
         bond_to_secondary_connection_item;
-    std::unordered_map<const RDKit::SubstanceGroup*, SGroupItem*>
-        s_group_to_s_group_items;
 
     // create atom items
-    for (std::size_t i = 0; i < num_atoms; ++i) {
-        const auto* atom = mol->getAtomWithIdx(i);
+    for (const auto* atom : mol->atoms()) {
         if (!draw_attachment_points && is_attachment_point(atom)) {
             continue;
         }
-        const auto pos = conformer.getAtomPos(i);
-        QGraphicsItem* atom_item =
-            is_atom_monomeric(atom)
-                ? static_cast<QGraphicsItem*>(
-                      get_monomer_graphics_item(atom, fonts, is_dark_mode))
-                : new AtomItem(atom, fonts, atom_display_settings);
-        atom_item->setPos(to_scene_xy(pos));
+        auto* atom_item = create_graphics_item_for_atom(
+            atom, fonts, atom_display_settings, is_dark_mode);
         atom_to_atom_item[atom] = atom_item;
-        if (is_dummy_atom_for_variable_attachment_bond(atom)) {
-            // hide the dummy atoms for variable attachment bonds
-            atom_item->setVisible(false);
-        }
         all_items.push_back(atom_item);
     }
 
@@ -130,58 +193,132 @@ create_graphics_items_for_mol(const RDKit::ROMol* mol, const Fonts& fonts,
         if (!draw_attachment_points && is_attachment_point_bond(bond)) {
             continue;
         }
-        const auto* from_atom = bond->getBeginAtom();
-        const auto* to_atom = bond->getEndAtom();
-        const auto* from_graphics_item = atom_to_atom_item[from_atom];
-        const auto* to_graphics_item = atom_to_atom_item[to_atom];
-        const auto* from_atom_item =
-            qgraphicsitem_cast<const AtomItem*>(from_graphics_item);
-        const auto* to_atom_item =
-            qgraphicsitem_cast<const AtomItem*>(to_graphics_item);
-        const auto* from_monomer_item =
-            dynamic_cast<const AbstractMonomerItem*>(from_graphics_item);
-        const auto* to_monomer_item =
-            dynamic_cast<const AbstractMonomerItem*>(to_graphics_item);
-        if (from_atom_item != nullptr && to_atom_item != nullptr) {
-            auto bond_item = new BondItem(bond, *from_atom_item, *to_atom_item,
-                                          fonts, bond_display_settings);
+        auto [bond_item, secondary_connection_item] =
+            create_graphics_items_for_bond(
+                bond, atom_to_atom_item[bond->getBeginAtom()],
+                atom_to_atom_item[bond->getEndAtom()], fonts,
+                bond_display_settings, is_dark_mode);
+        if (bond_item != nullptr) {
             bond_to_bond_item[bond] = bond_item;
             all_items.push_back(bond_item);
-        } else if (from_monomer_item != nullptr && to_monomer_item != nullptr) {
-            auto connector_item = new MonomerConnectorItem(
-                bond, *from_monomer_item, *to_monomer_item,
-                /* is_secondary_connection = */ false, is_dark_mode);
-            bond_to_bond_item[bond] = connector_item;
-            all_items.push_back(connector_item);
-            if (contains_two_monomer_linkages(bond)) {
-                auto secondary_connector_item = new MonomerConnectorItem(
-                    bond, *from_monomer_item, *to_monomer_item,
-                    /* is_secondary_connection = */ true, is_dark_mode);
-                bond_to_secondary_connection_item[bond] =
-                    secondary_connector_item;
-                all_items.push_back(secondary_connector_item);
-            }
         }
-        // we skip bonds that go between a monomer and an atomistic atom
+        if (secondary_connection_item != nullptr) {
+            bond_to_secondary_connection_item[bond] = secondary_connection_item;
+            all_items.push_back(secondary_connection_item);
+        }
     }
 
     // create substance group items
-    for (auto& sgroup : getSubstanceGroups(*mol)) {
-        if (rdkit_extensions::is_polymer_annotation_s_group(sgroup) ||
-            rdkit_extensions::is_supplementary_information_s_group(sgroup)) {
-            // this isn't an actual S-group; it's just additional data about a
-            // monomeric model
-            continue;
-        }
-        SGroupItem* sgroup_item = new SGroupItem(sgroup, fonts);
-        s_group_to_s_group_items[&sgroup] = sgroup_item;
-        all_items.push_back(sgroup_item);
+    auto s_group_to_s_group_items =
+        create_graphics_items_for_s_groups(mol, fonts);
+    for (auto [s_group, s_group_item] : s_group_to_s_group_items) {
+        all_items.push_back(s_group_item);
     }
 
     return {all_items, atom_to_atom_item, bond_to_bond_item,
             bond_to_secondary_connection_item, s_group_to_s_group_items};
 }
 
+/**
+ * Append the names and values of all of the given properties to key.  Only the
+ * name is appended for properties that aren't numbers or strings, so any such
+ * property that affects how an item is drawn must be handled separately.
+ */
+static void append_prop_values(const RDKit::Dict& props, std::string& key)
+{
+    auto out = std::back_inserter(key);
+    for (const auto& prop : props.getData()) {
+        const auto& value = prop.val;
+        switch (value.getTag()) {
+            case RDKit::RDTypeTag::IntTag:
+                fmt::format_to(out, "{}={};", prop.key,
+                               RDKit::rdvalue_cast<int>(value));
+                break;
+            case RDKit::RDTypeTag::UnsignedIntTag:
+                fmt::format_to(out, "{}={};", prop.key,
+                               RDKit::rdvalue_cast<unsigned int>(value));
+                break;
+            case RDKit::RDTypeTag::BoolTag:
+                fmt::format_to(out, "{}={};", prop.key,
+                               RDKit::rdvalue_cast<bool>(value));
+                break;
+            case RDKit::RDTypeTag::DoubleTag:
+                fmt::format_to(out, "{}={};", prop.key,
+                               RDKit::rdvalue_cast<double>(value));
+                break;
+            case RDKit::RDTypeTag::FloatTag:
+                fmt::format_to(out, "{}={};", prop.key,
+                               RDKit::rdvalue_cast<float>(value));
+                break;
+            case RDKit::RDTypeTag::StringTag:
+                fmt::format_to(out, "{}={};", prop.key,
+                               RDKit::rdvalue_cast<std::string>(value));
+                break;
+            default:
+                fmt::format_to(out, "{};", prop.key);
+        }
+    }
+}
+
+/**
+ * Append the user color of the given atom or bond, if any, to key
+ */
+template <typename T>
+static void append_user_color(const T* atom_or_bond, std::string& key)
+{
+    QColor color;
+    if (atom_or_bond->getPropIfPresent(USER_COLOR, color)) {
+        key += color.name(QColor::HexArgb).toStdString();
+    }
+}
+
+std::string get_atom_item_key(const RDKit::Atom* atom)
+{
+    const auto& pos =
+        atom->getOwningMol().getConformer().getAtomPos(atom->getIdx());
+    int num_hs = atom->needsUpdatePropertyCache()
+                     ? -1
+                     : static_cast<int>(atom->getTotalNumHs());
+    auto key = fmt::format(
+        "{},{}|{},{},{},{},{},{},{},{},{}|", pos.x, pos.y, atom->getAtomicNum(),
+        atom->getIsotope(), atom->getFormalCharge(),
+        atom->getNumRadicalElectrons(), num_hs, atom->getNumExplicitHs(),
+        static_cast<int>(atom->getChiralTag()), atom->getIsAromatic(),
+        atom->getDegree());
+    if (atom->hasQuery()) {
+        key += get_atom_smarts(atom);
+    }
+    append_prop_values(atom->getDict(), key);
+    append_user_color(atom, key);
+    std::array<double, 3> monomer_size;
+    if (atom->getPropIfPresent(rdkit_extensions::MONOMER_ITEM_SIZE,
+                               monomer_size)) {
+        key += fmt::format("{},{},{}", monomer_size[0], monomer_size[1],
+                           monomer_size[2]);
+    }
+    return key;
+}
+
+std::string get_bond_item_key(const RDKit::Bond* bond)
+{
+    const auto* ring_info = bond->getOwningMol().getRingInfo();
+    auto key = fmt::format(
+        "{},{},{},{},{}|", static_cast<int>(bond->getBondType()),
+        static_cast<int>(bond->getBondDir()),
+        static_cast<int>(bond->getStereo()), bond->getIsAromatic(),
+        ring_info->isInitialized() ? ring_info->numBondRings(bond->getIdx())
+                                   : 0);
+    for (auto stereo_atom_idx : bond->getStereoAtoms()) {
+        key += fmt::format("{},", stereo_atom_idx);
+    }
+    if (bond->hasQuery()) {
+        key += bond->getQuery()->getDescription();
+    }
+    append_prop_values(bond->getDict(), key);
+    append_user_color(bond, key);
+    return key;
+}
+
 void update_conf_for_mol_graphics_items(
     const QList<QGraphicsItem*>& atom_items,
     const QList<QGraphicsItem*>& bond_items,
@@ -394,12 +531,24 @@ static QPainterPath get_highlighting_path_for_atom(const RDKit::Atom* atom,
 
 QPainterPath get_selection_highlighting_path_for_atom(const RDKit::Atom* atom)
 {
+    if (!is_attachment_point(atom)) {
+        // every other atom uses the same circle, and QPainterPath is implicitly
+        // shared, so there's no need to build a new path for each atom
+        static const QPainterPath circle_path = get_highlighting_path_for_atom(
+            atom, ATOM_SELECTION_HIGHLIGHTING_RADIUS);
+        return circle_path;
+    }
     return get_highlighting_path_for_atom(atom,
                                           ATOM_SELECTION_HIGHLIGHTING_RADIUS);
 }
 
 QPainterPath get_predictive_highlighting_path_for_atom(const RDKit::Atom* atom)
 {
+    if (!is_attachment_point(atom)) {
+        static const QPainterPath circle_path = get_highlighting_path_for_atom(
+            atom, ATOM_PREDICTIVE_HIGHLIGHTING_RADIUS);
+        return circle_path;
+    }
     return get_highlighting_path_for_atom(atom,
                                           ATOM_PREDICTIVE_HIGHLIGHTING_RADIUS);
 }
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <string>
 #include <tuple>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include <QtGlobal>
@@ -84,6 +86,57 @@ create_graphics_items_for_mol(
     const BondDisplaySettings& bond_display_settings = BondDisplaySettings(),
     const bool is_dark_mode = false, const bool draw_attachment_points = true);
 
+/**
+ * Create the graphics item for the given atom or monomer, positioned according
+ * to the atom's conformer
+ * @return The newly created graphics item. Destruction of this graphics item is
+ * the responsibility of the calling scope.
+ */
+SKETCHER_API QGraphicsItem* create_graphics_item_for_atom(
+    const RDKit::Atom* atom, const Fonts& fonts,
+    const AtomDisplaySettings& atom_display_settings,
+    const bool is_dark_mode = false);
+
+/**
+ * Create the graphics items for the given bond or monomer connection
+ * @param from_graphics_item The graphics item for the bond's begin atom
+ * @param to_graphics_item The graphics item for the bond's end atom
+ * @return The bond item and, for monomeric bonds that represent two
+ * connections, the item for the secondary connection (otherwise nullptr).
+ * Both are nullptr for bonds between a monomer and an atom, which aren't drawn.
+ * Destruction of these items is the responsibility of the calling scope.
+ */
+SKETCHER_API std::pair<QGraphicsItem*, QGraphicsItem*>
+create_graphics_items_for_bond(const RDKit::Bond* bond,
+                               const QGraphicsItem* from_graphics_item,
+                               const QGraphicsItem* to_graphics_item,
+                               const Fonts& fonts,
+                               const BondDisplaySettings& bond_display_settings,
+                               const bool is_dark_mode = false);
+
+/**
+ * Create the graphics items for all S-groups of the given molecule, other than
+ * the ones that only store monomeric model data
+ * @return A map of S-group -> the graphics item used to represent that S-group
+ */
+SKETCHER_API std::unordered_map<const RDKit::SubstanceGroup*, SGroupItem*>
+create_graphics_items_for_s_groups(const RDKit::ROMol* mol, const Fonts& fonts);
+
+/**
+ * @return a string describing everything about the given atom that its graphics
+ * item is drawn from: its position, element, charge, hydrogens, number of bonds,
+ * query and properties.  If the key is unchanged, then the item only needs
+ * updating if one of the atom's neighbors changed.
+ */
+SKETCHER_API std::string get_atom_item_key(const RDKit::Atom* atom);
+
+/**
+ * @return a string describing everything about the given bond that its graphics
+ * item is drawn from, other than its atoms: its type, stereo, ring membership,
+ * query and properties
+ */
+SKETCHER_API std::string get_bond_item_key(const RDKit::Bond* bond);
+
 /**
  * Update all graphics items to represent an updated conformer
  * @param atom_items All atom items to update
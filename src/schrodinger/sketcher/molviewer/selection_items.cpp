@@ -12,11 +12,23 @@ RectSelectionItem::RectSelectionItem(QGraphicsItem* parent) :
 {
 }
 
+QPolygonF RectSelectionItem::getSelectionPolygon() const
+{
+    return mapToScene(rect());
+}
+
 EllipseSelectionItem::EllipseSelectionItem(QGraphicsItem* parent) :
     SelectionGraphicsItem<QGraphicsEllipseItem>(parent)
 {
 }
 
+QPolygonF EllipseSelectionItem::getSelectionPolygon() const
+{
+    QPainterPath path;
+    path.addEllipse(rect());
+    return mapToScene(path.toFillPolygon());
+}
+
 LassoSelectionItem::LassoSelectionItem(QGraphicsItem* parent) :
     SelectionGraphicsItem<QGraphicsPathItem>(parent)
 {
@@ -37,5 +49,10 @@ void LassoSelectionItem::clearPath()
     setPath(path);
 }
 
+QPolygonF LassoSelectionItem::getSelectionPolygon() const
+{
+    return mapToScene(m_lasso_polygon);
+}
+
 } // namespace sketcher
 } // namespace schrodinger
@@ -31,6 +31,11 @@ class RectSelectionItem : public SelectionGraphicsItem<QGraphicsRectItem>
 {
   public:
     RectSelectionItem(QGraphicsItem* parent = nullptr);
+
+    /**
+     * @return the selected area in Scene coordinates
+     */
+    QPolygonF getSelectionPolygon() const;
 };
 
 /**
@@ -42,6 +47,11 @@ class EllipseSelectionItem : public SelectionGraphicsItem<QGraphicsEllipseItem>
 {
   public:
     EllipseSelectionItem(QGraphicsItem* parent = nullptr);
+
+    /**
+     * @return the selected area in Scene coordinates
+     */
+    QPolygonF getSelectionPolygon() const;
 };
 
 /**
@@ -66,6 +76,12 @@ class LassoSelectionItem : public SelectionGraphicsItem<QGraphicsPathItem>
      */
     void clearPath();
 
+    /**
+     * @return the selected area in Scene coordinates, i.e. the lasso path
+     * closed between its last and first points
+     */
+    QPolygonF getSelectionPolygon() const;
+
   protected:
     QPolygonF m_lasso_polygon;
 };
@@ -143,7 +143,7 @@ void SGroupItem::updateCachedData()
     auto [field_data_coords, field_data_coords_are_relative] =
         getFieldDataDisplayInfo();
     m_field_data_text_rect =
-        m_fonts.m_sgroup_fm.tightBoundingRect(m_field_data_text);
+        m_fonts.getTightBoundingRect(m_fonts.m_sgroup_font, m_field_data_text);
     // for now we ignore the relative flag and always place the field data text
     // relative to the first atom in the sgroup
     Q_UNUSED(field_data_coords_are_relative);
@@ -153,9 +153,10 @@ void SGroupItem::updateCachedData()
     auto [positions, displacement] = getPositionsForLabels();
     auto brackets_half_height = positions.length() * 0.5;
     auto translation_offset = (positions.p1() + positions.p2()) * 0.5;
-    m_untransformed_label_rect = m_fonts.m_sgroup_fm.tightBoundingRect(m_label);
+    m_untransformed_label_rect =
+        m_fonts.getTightBoundingRect(m_fonts.m_sgroup_font, m_label);
     m_untransformed_repeat_rect =
-        m_fonts.m_sgroup_fm.tightBoundingRect(m_repeat);
+        m_fonts.getTightBoundingRect(m_fonts.m_sgroup_font, m_repeat);
     qreal label_x_offset = LABEL_DISTANCE_FROM_BRACKETS * VIEW_SCALE;
     qreal label_y_offset = brackets_half_height;
     QPointF label_rect_untransformed_offset(label_x_offset, label_y_offset);
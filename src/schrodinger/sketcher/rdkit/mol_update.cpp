@@ -14,14 +14,23 @@
 #include "schrodinger/rdkit_extensions/stereochemistry.h"
 #include "schrodinger/rdkit_extensions/constants.h"
 #include "schrodinger/sketcher/rdkit/atom_properties.h"
+#include "schrodinger/sketcher/molviewer/constants.h"
 
+#include <boost/dynamic_bitset.hpp>
 #include <boost/format.hpp>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace schrodinger
 {
 namespace sketcher
 {
 
+// set on mols that have large components whose CIP labels haven't been
+// assigned yet
+const std::string DEFERRED_CIP_LABELS_PROPERTY = "_SKETCHER_DEFERRED_CIP";
+
 /**
  * Sketcher-specific assignment of enhanced stereo to all chiral centers. This
  * preserves any assigned enhanced stereo group and their numbering, while
@@ -171,9 +180,17 @@ assign_stereochemistry_with_bond_directions_and_coordinates(RDKit::RWMol& mol)
  * Sketcher-specific assignment of CIP labels, which bypasses the assignment
  * after a certain number of cycles or certain exceptions are hit. For this
  * function to work properly, the input mol must have had stereo assigned.
+ *
+ * CIP labels only depend on the connected component an atom or bond is in, so
+ * labels are only assigned to the given atoms and to the bonds that start at
+ * them.  Callers must pass whole connected components.
  */
-static void assign_CIP_labels(RDKit::RWMol& mol)
+static void assign_CIP_labels(RDKit::ROMol& mol,
+                              const boost::dynamic_bitset<>& atoms)
 {
+    if (atoms.none()) {
+        return;
+    }
     // The CIPLabeler cannot handle non-integer bond orders (e.g. query bonds
     // with UNSPECIFIED type). CIP labels are also undefined for query
     // structures, so skip assignment entirely when any query bond is present.
@@ -183,11 +200,16 @@ static void assign_CIP_labels(RDKit::RWMol& mol)
         }
     }
 
+    boost::dynamic_bitset<> bonds(mol.getNumBonds());
+    for (auto bond : mol.bonds()) {
+        bonds[bond->getIdx()] = atoms[bond->getBeginAtomIdx()];
+    }
+
     try {
         // Set in SHARED-11140
         unsigned max_cycles = 2000000;
 
-        RDKit::CIPLabeler::assignCIPLabels(mol, max_cycles);
+        RDKit::CIPLabeler::assignCIPLabels(mol, atoms, bonds, max_cycles);
     } catch (const RDKit::CIPLabeler::MaxIterationsExceeded&) {
         // CIP label calculation "timed out". Some labels will be omitted.
     } catch (const RDKit::CIPLabeler::TooManyNodesException&) {
@@ -197,6 +219,29 @@ static void assign_CIP_labels(RDKit::RWMol& mol)
     }
 }
 
+/**
+ * @return whether each connected component has more than
+ * LARGE_MOLECULE_ATOM_THRESHOLD atoms, which means that its CIP labels are
+ * deferred
+ * @param component_of_atom the index of the connected component of each atom,
+ * as returned by RDKit::MolOps::getMolFrags
+ * @param num_components the number of connected components
+ */
+static std::vector<bool>
+get_large_components(const std::vector<int>& component_of_atom,
+                     const size_t num_components)
+{
+    std::vector<unsigned int> component_sizes(num_components, 0);
+    for (auto component : component_of_atom) {
+        ++component_sizes[component];
+    }
+    std::vector<bool> is_large(num_components);
+    for (size_t i = 0; i < num_components; ++i) {
+        is_large[i] = component_sizes[i] > LARGE_MOLECULE_ATOM_THRESHOLD;
+    }
+    return is_large;
+}
+
 // If we can't resolve an atoms CIP code (e.g. due to timing out),
 // the {cip} placeholder in the label won't be updated to the actual
 // code, and the placeholder will be displayed. To prevent this from
@@ -206,7 +251,7 @@ static void assign_CIP_labels(RDKit::RWMol& mol)
 // which we show the CIP code in the label (AND/OR groups just show the
 // type of the group, which we always know, and for ungrouped atoms we
 // only add a label if the CIP code is known).
-static void clear_abs_labels_with_unresolved_cip(RDKit::RWMol& mol)
+static void clear_abs_labels_with_unresolved_cip(RDKit::ROMol& mol)
 {
     for (const auto& sg : mol.getStereoGroups()) {
         // We only care about the ABS group
@@ -220,6 +265,41 @@ static void clear_abs_labels_with_unresolved_cip(RDKit::RWMol& mol)
     }
 }
 
+/**
+ * Replace the stereo annotations (i.e. the atom and bond notes that display
+ * CIP labels and enhanced stereo groups) using the current CIP labels
+ */
+static void update_stereo_annotations(RDKit::ROMol& mol)
+{
+    /**
+     * note that the ABSOLUTE_STEREO_PREFIX might be stripped away by the
+     * rendering code depending on rendering preferences. Note that the molModel
+     * remains unaware of these rendering preferences (which are part of
+     * sketcherModel) because we want everything in the molModel to be savable
+     * as an undoable snapshot. The rendering preferences might get exposed to
+     * the GUI in the future and we don't want them to be undoable.
+     */
+    std::string abs_label =
+        rdkit_extensions::ABSOLUTE_STEREO_PREFIX + "({cip})";
+    std::string or_label = rdkit_extensions::OR_STEREO_PREFIX + "{id}";
+    std::string and_label = rdkit_extensions::AND_STEREO_PREFIX + "{id}";
+
+    // addStereoAnnotations will not clear existing annotations,
+    // just override the ones on atoms/bonds that require labels.
+    // So we need to clear them ourselves first to get dir of
+    // outdated labels.
+    for (auto atom : mol.atoms()) {
+        atom->clearProp(RDKit::common_properties::atomNote);
+    }
+    for (auto bond : mol.bonds()) {
+        bond->clearProp(RDKit::common_properties::bondNote);
+    }
+
+    RDKit::Chirality::addStereoAnnotations(mol, abs_label, or_label, and_label);
+
+    clear_abs_labels_with_unresolved_cip(mol);
+}
+
 /**
  * Called once when a mol is first brought into the sketcher
  */
@@ -247,10 +327,41 @@ void prepare_mol(RDKit::ROMol& mol)
 }
 
 /**
- * Called every time the mol is changed in the sketcher
+ * Update the mol after a change that only affected the given connected
+ * components.  Valences and CIP labels are only recalculated within the
+ * changed components.  Conjugation, hybridization, ring perception and stereo
+ * perception still cover the whole mol, since RDKit only provides them for
+ * whole molecules.
+ *
+ * @param component_of_atom the index of the connected component of each atom,
+ * as returned by RDKit::MolOps::getMolFrags
+ * @param changed_components whether each component was changed
  */
-void update_molecule_on_change(RDKit::RWMol& mol)
+static void
+update_changed_components(RDKit::RWMol& mol,
+                          const std::vector<int>& component_of_atom,
+                          const std::vector<bool>& changed_components)
 {
+    // Stereo perception clears all CIP labels, so keep the labels from the
+    // unchanged components to restore afterwards
+    std::vector<std::pair<RDKit::Atom*, std::string>> kept_atom_labels;
+    std::vector<std::pair<RDKit::Bond*, std::string>> kept_bond_labels;
+    std::string label;
+    for (auto atom : mol.atoms()) {
+        if (!changed_components[component_of_atom[atom->getIdx()]] &&
+            atom->getPropIfPresent(RDKit::common_properties::_CIPCode,
+                                   label)) {
+            kept_atom_labels.emplace_back(atom, label);
+        }
+    }
+    for (auto bond : mol.bonds()) {
+        if (!changed_components[component_of_atom[bond->getBeginAtomIdx()]] &&
+            bond->getPropIfPresent(RDKit::common_properties::_CIPCode,
+                                   label)) {
+            kept_bond_labels.emplace_back(bond, label);
+        }
+    }
+
     // save the simplified stereo annotation as a mol property
     RDKit::Chirality::simplifyEnhancedStereo(
         mol, /*removeAffectedStereoGroups = */ false);
@@ -264,7 +375,11 @@ void update_molecule_on_change(RDKit::RWMol& mol)
     // want that. See SKETCH-2190 or test_smarts_no_radicals in test_mol_model
     // for more info.
     bool no_strict = false;
-    mol.updatePropertyCache(no_strict);
+    for (auto atom : mol.atoms()) {
+        if (changed_components[component_of_atom[atom->getIdx()]]) {
+            atom->updatePropertyCache(no_strict);
+        }
+    }
     // update hybridization states so that coordinate calculations produce the
     // correct geometry
     RDKit::MolOps::setConjugation(mol);
@@ -274,8 +389,29 @@ void update_molecule_on_change(RDKit::RWMol& mol)
 
     assign_stereochemistry_with_bond_directions_and_coordinates(mol);
 
-    // Generate R/S/E/Z labels
-    assign_CIP_labels(mol);
+    // Generate R/S/E/Z labels.  CIP labeling scales poorly with molecule size,
+    // so labels in large components are deferred until
+    // assign_deferred_CIP_labels is called.
+    auto is_large_component =
+        get_large_components(component_of_atom, changed_components.size());
+    boost::dynamic_bitset<> atoms_to_label(mol.getNumAtoms());
+    for (auto atom : mol.atoms()) {
+        auto component = component_of_atom[atom->getIdx()];
+        if (!changed_components[component]) {
+            continue;
+        } else if (is_large_component[component]) {
+            mol.setProp(DEFERRED_CIP_LABELS_PROPERTY, true);
+        } else {
+            atoms_to_label.set(atom->getIdx());
+        }
+    }
+    assign_CIP_labels(mol, atoms_to_label);
+    for (auto& [atom, kept_label] : kept_atom_labels) {
+        atom->setProp(RDKit::common_properties::_CIPCode, kept_label);
+    }
+    for (auto& [bond, kept_label] : kept_bond_labels) {
+        bond->setProp(RDKit::common_properties::_CIPCode, kept_label);
+    }
 
     // Add the newly found chiral atoms to StereoGroups
     add_enhanced_stereo_to_chiral_atoms(mol);
@@ -285,33 +421,58 @@ void update_molecule_on_change(RDKit::RWMol& mol)
     // cleanupStereoGroups(), because that one only preserves input ids
     RDKit::forwardStereoGroupIds(mol);
 
-    /**
-     * note that the ABSOLUTE_STEREO_PREFIX might be stripped away by the
-     * rendering code depending on rendering preferences. Note that the molModel
-     * remains unaware of these rendering preferences (which are part of
-     * sketcherModel) because we want everything in the molModel to be savable
-     * as an undoable snapshot. The rendering preferences might get exposed to
-     * the GUI in the future and we don't want them to be undoable.
-     */
-    std::string abs_label =
-        rdkit_extensions::ABSOLUTE_STEREO_PREFIX + "({cip})";
-    std::string or_label = rdkit_extensions::OR_STEREO_PREFIX + "{id}";
-    std::string and_label = rdkit_extensions::AND_STEREO_PREFIX + "{id}";
+    update_stereo_annotations(mol);
+}
 
-    // addStereoAnnotations will not clear existing annotations,
-    // just override the ones on atoms/bonds that require labels.
-    // So we need to clear them ourselves first to get dir of
-    // outdated labels.
-    for (auto atom : mol.atoms()) {
-        atom->clearProp(RDKit::common_properties::atomNote);
+/**
+ * Called every time the mol is changed in the sketcher
+ */
+void update_molecule_on_change(RDKit::RWMol& mol)
+{
+    std::vector<int> component_of_atom;
+    auto num_components = RDKit::MolOps::getMolFrags(mol, component_of_atom);
+    update_changed_components(mol, component_of_atom,
+                              std::vector<bool>(num_components, true));
+}
+
+void update_molecule_on_change(
+    RDKit::RWMol& mol, const std::unordered_set<const RDKit::Atom*>& atoms,
+    const std::unordered_set<const RDKit::Bond*>& bonds)
+{
+    std::vector<int> component_of_atom;
+    auto num_components = RDKit::MolOps::getMolFrags(mol, component_of_atom);
+    std::vector<bool> changed_components(num_components, false);
+    for (auto atom : atoms) {
+        changed_components[component_of_atom[atom->getIdx()]] = true;
     }
-    for (auto bond : mol.bonds()) {
-        bond->clearProp(RDKit::common_properties::bondNote);
+    for (auto bond : bonds) {
+        changed_components[component_of_atom[bond->getBeginAtomIdx()]] = true;
     }
+    update_changed_components(mol, component_of_atom, changed_components);
+}
 
-    RDKit::Chirality::addStereoAnnotations(mol, abs_label, or_label, and_label);
+bool has_deferred_CIP_labels(const RDKit::ROMol& mol)
+{
+    return mol.hasProp(DEFERRED_CIP_LABELS_PROPERTY);
+}
 
-    clear_abs_labels_with_unresolved_cip(mol);
+void assign_deferred_CIP_labels(RDKit::ROMol& mol)
+{
+    if (!has_deferred_CIP_labels(mol)) {
+        return;
+    }
+    mol.clearProp(DEFERRED_CIP_LABELS_PROPERTY);
+    std::vector<int> component_of_atom;
+    auto num_components = RDKit::MolOps::getMolFrags(mol, component_of_atom);
+    auto is_large_component =
+        get_large_components(component_of_atom, num_components);
+    boost::dynamic_bitset<> atoms_to_label(mol.getNumAtoms());
+    for (auto atom : mol.atoms()) {
+        atoms_to_label[atom->getIdx()] =
+            is_large_component[component_of_atom[atom->getIdx()]];
+    }
+    assign_CIP_labels(mol, atoms_to_label);
+    update_stereo_annotations(mol);
 }
 
 } // namespace sketcher
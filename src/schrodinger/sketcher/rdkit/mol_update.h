@@ -1,9 +1,13 @@
 #pragma once
 
+#include <unordered_set>
+
 #include "schrodinger/sketcher/definitions.h"
 
 namespace RDKit
 {
+class Atom;
+class Bond;
 class ROMol;
 class RWMol;
 } // namespace RDKit
@@ -26,9 +30,46 @@ SKETCHER_API void prepare_mol(RDKit::ROMol& mol);
  * chemistry. This includes any add/update/delete operations on atoms, bonds,
  * and sgroups.
  *
+ * CIP labels are not assigned in connected components with more than
+ * LARGE_MOLECULE_ATOM_THRESHOLD atoms, since CIP labeling scales poorly with
+ * molecule size.  They are instead deferred until assign_deferred_CIP_labels is
+ * called.
+ *
  * @param mol The molecule to update
  */
 SKETCHER_API void update_molecule_on_change(RDKit::RWMol& mol);
 
+/**
+ * Update an RDKit molecule after a change that only affected the given atoms
+ * and bonds, e.g. moving some of the atoms.  This is equivalent to the
+ * overload above, but valences and CIP labels are only recalculated in the
+ * connected components that contain the given atoms and bonds.  Note that
+ * conjugation, hybridization, ring perception and stereo perception are still
+ * redone for the whole molecule, so only the valence and CIP labeling costs of
+ * a local edit are limited to the changed components.
+ *
+ * @param mol The molecule to update
+ * @param atoms The changed atoms, which must belong to mol
+ * @param bonds The changed bonds, which must belong to mol
+ */
+SKETCHER_API void
+update_molecule_on_change(RDKit::RWMol& mol,
+                          const std::unordered_set<const RDKit::Atom*>& atoms,
+                          const std::unordered_set<const RDKit::Bond*>& bonds);
+
+/**
+ * @return whether update_molecule_on_change deferred the CIP labels of any
+ * large connected components of the given molecule
+ */
+SKETCHER_API bool has_deferred_CIP_labels(const RDKit::ROMol& mol);
+
+/**
+ * Assign the CIP labels that update_molecule_on_change deferred, and update the
+ * stereo annotations to match.  This does nothing if no labels were deferred.
+ *
+ * @param mol The molecule to update
+ */
+SKETCHER_API void assign_deferred_CIP_labels(RDKit::ROMol& mol);
+
 } // namespace sketcher
 } // namespace schrodinger
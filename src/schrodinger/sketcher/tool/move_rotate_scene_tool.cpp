@@ -118,6 +118,9 @@ void MoveRotateSceneTool::onLeftButtonDragStart(
     // begin an undo macro in case we have to merge atoms at the end of the
     // drag
     m_mol_model->beginUndoMacro(description);
+    // move only the affected graphics items during the drag, and commit the
+    // new coordinates to the model once it's finished
+    m_mol_model->beginTransientTransform();
     StandardSceneToolBase::onLeftButtonDragStart(event);
 }
 
@@ -70,7 +70,9 @@ template <typename T> void
 SelectSceneTool<T>::onLeftButtonDragMove(QGraphicsSceneMouseEvent* const event)
 {
     StandardSceneToolBase::onLeftButtonDragMove(event);
-    auto items = m_scene->getCollidingItemsUsingBondMidpoints(&m_select_item);
+    // preview the selection using predictive highlighting
+    auto items = m_scene->getInteractiveItemsInPolygon(
+        m_select_item.getSelectionPolygon());
     m_predictive_highlighting_item.highlightItems(items);
 }
 
@@ -80,7 +82,8 @@ template <typename T> void SelectSceneTool<T>::onLeftButtonDragRelease(
     StandardSceneToolBase::onLeftButtonDragRelease(event);
     m_select_item.setVisible(false);
     m_predictive_highlighting_item.clearHighlightingPath();
-    auto items = m_scene->getCollidingItemsUsingBondMidpoints(&m_select_item);
+    auto items = m_scene->getInteractiveItemsInPolygon(
+        m_select_item.getSelectionPolygon());
     onSelectionMade(items, event);
 }
 
@@ -134,6 +134,7 @@ void StandardSceneToolBase::onMiddleButtonDragStart(
     emit newCursorHintRequested(m_rotate_cursor_hint);
     emit atomDragStarted();
     m_mol_model->beginUndoMacro("Rotate");
+    m_mol_model->beginTransientTransform();
     AbstractSceneTool::onMiddleButtonDragStart(event);
 }
 
@@ -164,6 +165,7 @@ void StandardSceneToolBase::onRightButtonDragStart(
     emit newCursorHintRequested(m_translate_cursor_hint);
     emit atomDragStarted();
     m_mol_model->beginUndoMacro("Translate");
+    m_mol_model->beginTransientTransform();
     AbstractSceneTool::onRightButtonDragStart(event);
 }
 
@@ -186,8 +188,13 @@ void StandardSceneToolBase::onRightButtonDragRelease(
 void StandardSceneToolBase::finishDrag()
 {
     emit newCursorHintRequested(getDefaultCursorPixmap());
-    mergeOverlappingAtoms();
+    // commit the drag to the model before merging any atoms
+    m_mol_model->finishTransientTransform();
+    bool were_atoms_merged = mergeOverlappingAtoms();
+    // the model's signals are deferred until the undo macro ends, so we wait
+    // until then to report that the drag is finished
     m_mol_model->endUndoMacro();
+    emit atomDragFinished(were_atoms_merged);
     setObjectsToMove({}, {});
 }
 
@@ -197,6 +204,7 @@ void StandardSceneToolBase::setObjectsToMove(
 {
     m_atoms_to_move = atoms;
     m_non_mol_objs_to_move = non_mol_objects;
+    m_drag_merge_finder.reset();
 }
 
 void StandardSceneToolBase::setCurrentSelectionAsObjectsToMove()
@@ -300,7 +308,12 @@ RDGeom::Point3D StandardSceneToolBase::findPivotPointForRotation()
 std::vector<std::pair<unsigned int, unsigned int>>
 StandardSceneToolBase::getOverlappingAtomIdxs()
 {
-    return get_overlapping_atom_idxs(m_mol_model->getMol(), m_atoms_to_move);
+    const auto* mol = m_mol_model->getMol();
+    if (!m_drag_merge_finder.has_value() ||
+        !m_drag_merge_finder->isValidFor(*m_mol_model)) {
+        m_drag_merge_finder.emplace(*m_mol_model, m_atoms_to_move);
+    }
+    return m_drag_merge_finder->getOverlappingAtomIdxs(*mol);
 }
 
 void StandardSceneToolBase::updateMergeHintItem()
@@ -320,7 +333,7 @@ void StandardSceneToolBase::updateMergeHintItem()
     m_merge_hint_item.setCoordinates(circle_centers);
 }
 
-void StandardSceneToolBase::mergeOverlappingAtoms()
+bool StandardSceneToolBase::mergeOverlappingAtoms()
 {
     auto overlapping_idxs = getOverlappingAtomIdxs();
     bool have_atoms_to_merge = !overlapping_idxs.empty();
@@ -338,53 +351,97 @@ void StandardSceneToolBase::mergeOverlappingAtoms()
                        });
         m_mol_model->mergeAtoms(overlapping_atoms);
     }
-    emit atomDragFinished(have_atoms_to_merge);
+    return have_atoms_to_merge;
 }
 
-std::vector<std::pair<unsigned int, unsigned int>> get_overlapping_atom_idxs(
-    const RDKit::ROMol* const mol,
-    const std::unordered_set<const RDKit::Atom*> atoms_to_move)
+DragMergeFinder::DragMergeFinder(
+    const RDKit::ROMol& mol,
+    const std::unordered_set<const RDKit::Atom*>& atoms_to_move) :
+    m_num_atoms(mol.getNumAtoms()),
+    m_stationary_atoms(MAX_DIST_FOR_DRAG_MERGE)
 {
-    std::vector<std::pair<unsigned int, unsigned int>> overlaps;
     if (atoms_to_move.empty()) {
-        // nothing is being moved, so there are no overlaps to report
-        return overlaps;
+        // nothing is being moved, so there will never be overlaps to report
+        return;
+    }
+    std::vector<bool> is_moving(m_num_atoms, false);
+    for (auto* atom : atoms_to_move) {
+        m_to_move_idxs.push_back(atom->getIdx());
+        is_moving[atom->getIdx()] = true;
+    }
+    std::sort(m_to_move_idxs.begin(), m_to_move_idxs.end());
+    RDKit::MolOps::getMolFrags(mol, m_frag_map);
+    const auto& conf = mol.getConformer();
+    for (unsigned int i = 0; i < m_num_atoms; ++i) {
+        if (!is_moving[i]) {
+            m_stationary_atoms.insert(i, conf.getAtomPos(i));
+        }
+    }
+}
+
+DragMergeFinder::DragMergeFinder(
+    const MolModel& mol_model,
+    const std::unordered_set<const RDKit::Atom*>& atoms_to_move) :
+    DragMergeFinder(*mol_model.getMol(), atoms_to_move)
+{
+    const auto* mol = mol_model.getMol();
+    for (auto to_move_idx : m_to_move_idxs) {
+        m_to_move_tags.push_back(
+            mol_model.getTagForAtom(mol->getAtomWithIdx(to_move_idx)));
+    }
+    m_undo_stack_index = mol_model.getUndoStackIndex();
+}
+
+bool DragMergeFinder::isValidFor(const MolModel& mol_model) const
+{
+    // any edit to the molecule outside of the drag moves the undo stack to a
+    // different command
+    const auto* mol = mol_model.getMol();
+    if (m_undo_stack_index != mol_model.getUndoStackIndex() ||
+        mol->getNumAtoms() != m_num_atoms) {
+        return false;
     }
-    // figure out the indices of the moving and stationary atoms
-    std::unordered_set<unsigned int> to_move_indices;
-    std::unordered_set<unsigned int> stationary_indices;
-    std::transform(atoms_to_move.begin(), atoms_to_move.end(),
-                   std::inserter(to_move_indices, to_move_indices.begin()),
-                   [](auto atom) { return atom->getIdx(); });
-    for (unsigned int i = 0; i < mol->getNumAtoms(); ++i) {
-        if (!to_move_indices.count(i)) {
-            stationary_indices.insert(i);
+    for (size_t i = 0; i < m_to_move_idxs.size(); ++i) {
+        auto* atom = mol->getAtomWithIdx(m_to_move_idxs[i]);
+        if (mol_model.getTagForAtom(atom) != m_to_move_tags[i]) {
+            return false;
         }
     }
+    return true;
+}
 
-    // figure out which atoms are actually overlapping
-    std::vector<int> frag_map;
-    const auto& conf = mol->getConformer();
-    RDKit::MolOps::getMolFrags(*mol, frag_map);
-    for (auto to_move_idx : to_move_indices) {
-        auto to_move_frag_num = frag_map[to_move_idx];
+std::vector<std::pair<unsigned int, unsigned int>>
+DragMergeFinder::getOverlappingAtomIdxs(const RDKit::ROMol& mol) const
+{
+    std::vector<std::pair<unsigned int, unsigned int>> overlaps;
+    if (m_to_move_idxs.empty()) {
+        return overlaps;
+    }
+    const auto& conf = mol.getConformer();
+    const RDGeom::Point3D max_offset(MAX_DIST_FOR_DRAG_MERGE,
+                                     MAX_DIST_FOR_DRAG_MERGE, 0);
+    for (auto to_move_idx : m_to_move_idxs) {
+        auto to_move_frag_num = m_frag_map[to_move_idx];
         const auto& to_move_coords = conf.getAtomPos(to_move_idx);
         // we're looking for the closest overlapping atom
         int idx_to_merge = -1;
         double best_dist_sq = MAX_DIST_SQ_FOR_DRAG_MERGE;
-        for (auto stationary_idx : stationary_indices) {
-            if (frag_map[stationary_idx] == to_move_frag_num) {
-                // these two atoms are from the same molecule, so we never
-                // consider them overlapping
-                continue;
+        auto check_stationary_atom = [&](unsigned int stationary_idx) {
+            // atoms from the same molecule are never considered overlapping
+            if (m_frag_map[stationary_idx] != to_move_frag_num) {
+                const auto& stationary_coords = conf.getAtomPos(stationary_idx);
+                auto dist_sq = (stationary_coords - to_move_coords).lengthSq();
+                if (dist_sq <= best_dist_sq) {
+                    idx_to_merge = stationary_idx;
+                    best_dist_sq = dist_sq;
+                }
             }
-            const auto& stationary_coords = conf.getAtomPos(stationary_idx);
-            auto dist_sq = (stationary_coords - to_move_coords).lengthSq();
-            if (dist_sq <= best_dist_sq) {
-                idx_to_merge = stationary_idx;
-                best_dist_sq = dist_sq;
-            }
-        }
+            // keep looking in case there's a closer atom
+            return false;
+        };
+        m_stationary_atoms.any_of(to_move_coords - max_offset,
+                                  to_move_coords + max_offset,
+                                  check_stationary_atom);
         if (idx_to_merge >= 0) {
             // there was an overlapping atom, so record the pair
             overlaps.emplace_back(to_move_idx, idx_to_merge);
@@ -393,6 +450,13 @@ std::vector<std::pair<unsigned int, unsigned int>> get_overlapping_atom_idxs(
     return overlaps;
 }
 
+std::vector<std::pair<unsigned int, unsigned int>> get_overlapping_atom_idxs(
+    const RDKit::ROMol* const mol,
+    const std::unordered_set<const RDKit::Atom*> atoms_to_move)
+{
+    return DragMergeFinder(*mol, atoms_to_move).getOverlappingAtomIdxs(*mol);
+}
+
 void StandardSceneToolBase::updateMonomericAttachmentPointLabels(
     const QPointF& scene_pos)
 {
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <optional>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include <QColor>
@@ -11,8 +13,10 @@
 #include <rdkit/GraphMol/Atom.h>
 #include <rdkit/Geometry/point.h>
 
+#include "schrodinger/rdkit_extensions/helm/spatial_grid.h"
 #include "schrodinger/sketcher/definitions.h"
 #include "schrodinger/sketcher/model/non_molecular_object.h"
+#include "schrodinger/sketcher/model/tags.h"
 #include "schrodinger/sketcher/molviewer/constants.h"
 #include "schrodinger/sketcher/molviewer/fonts.h"
 #include "schrodinger/sketcher/molviewer/monomer_constants.h"
@@ -25,6 +29,7 @@ namespace RDKit
 {
 class Atom;
 class Bond;
+class ROMol;
 } // namespace RDKit
 
 namespace schrodinger
@@ -73,6 +78,60 @@ class MergeHintItem : public QGraphicsItemGroup
     QPen m_circle_pen;
 };
 
+/**
+ * Finds the pairs of atoms that will be merged at the end of a drag. The
+ * fragment of every atom and a spatial grid of the stationary atoms are
+ * computed once, when the finder is created, so each query only compares the
+ * moving atoms against the stationary atoms in nearby grid cells. A finder
+ * remains valid as long as the molecule's topology and the coordinates of its
+ * stationary atoms don't change, i.e. for the length of a drag.
+ */
+class SKETCHER_API DragMergeFinder
+{
+  public:
+    /**
+     * @param mol the molecule being dragged
+     * @param atoms_to_move the atoms being moved by the drag
+     */
+    DragMergeFinder(
+        const RDKit::ROMol& mol,
+        const std::unordered_set<const RDKit::Atom*>& atoms_to_move);
+
+    /**
+     * @param mol_model the model containing the molecule being dragged
+     * @param atoms_to_move the atoms being moved by the drag
+     */
+    DragMergeFinder(
+        const MolModel& mol_model,
+        const std::unordered_set<const RDKit::Atom*>& atoms_to_move);
+
+    /**
+     * @return whether this finder can still be used for the molecule in the
+     * given model, i.e. whether the undo stack is still at the command it was
+     * at when the finder was created and the same atoms are being moved.
+     * Always false for finders that weren't created from a model.
+     */
+    bool isValidFor(const MolModel& mol_model) const;
+
+    /**
+     * @param mol the molecule this finder was created for, with the moving
+     * atoms at their current coordinates
+     * @return the atom indices for all currently overlapping pairs of atoms.
+     * See StandardSceneToolBase::getOverlappingAtomIdxs for details.
+     */
+    std::vector<std::pair<unsigned int, unsigned int>>
+    getOverlappingAtomIdxs(const RDKit::ROMol& mol) const;
+
+  private:
+    unsigned int m_num_atoms;
+    std::vector<unsigned int> m_to_move_idxs;
+    // the tags of the atoms in m_to_move_idxs, if created from a model
+    std::vector<AtomTag> m_to_move_tags;
+    std::optional<int> m_undo_stack_index;
+    std::vector<int> m_frag_map;
+    rdkit_extensions::SpatialGrid m_stationary_atoms;
+};
+
 /**
  * A scene tool that contains the behavior shared between all (or at least most)
  * scene tools. With this scene tool, middle-button drags will rotate the
@@ -245,10 +304,17 @@ class SKETCHER_API StandardSceneToolBase : public AbstractSceneTool
      */
     std::vector<std::pair<unsigned int, unsigned int>> getOverlappingAtomIdxs();
 
+    /**
+     * The finder used by getOverlappingAtomIdxs. It's created on the first
+     * query of a drag and discarded whenever the objects to move change.
+     */
+    std::optional<DragMergeFinder> m_drag_merge_finder;
+
     /**
      * Merge all overlapping atoms at the end of a rotation or translation.
+     * @return whether any atoms were merged
      */
-    void mergeOverlappingAtoms();
+    bool mergeOverlappingAtoms();
 
     std::unordered_set<const RDKit::Atom*> m_atoms_to_move;
     std::unordered_set<const NonMolecularObject*> m_non_mol_objs_to_move;
@@ -5,15 +5,30 @@
  * space and a name), converts them to monomeric representation, and outputs
  * HELM format to stdout (with optional name).
  *
+ * More generally, converts records between any of the supported file formats
+ * (SMILES, SDF, MAE, PDB, HELM, FASTA, ...), reading from and writing to
+ * optionally compressed files, using several threads while preserving the
+ * order of the input records.
+ *
  * Copyright Schrodinger LLC, All Rights Reserved.
  --------------------------------------------------------------------------- */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
 
+#include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 
 #include <QByteArray>
@@ -22,9 +37,11 @@
 #include <rdkit/GraphMol/ROMol.h>
 #include <rdkit/GraphMol/RWMol.h>
 
-#include "schrodinger/rdkit_extensions/atomistic_conversions.h"
+#include "schrodinger/rdkit_extensions/capture_rdkit_log.h"
 #include "schrodinger/rdkit_extensions/convert.h"
+#include "schrodinger/rdkit_extensions/fasta/transcode.h"
 #include "schrodinger/rdkit_extensions/file_format.h"
+#include "schrodinger/rdkit_extensions/file_stream.h"
 #include "schrodinger/rdkit_extensions/monomer_database.h"
 
 using namespace schrodinger::rdkit_extensions;
@@ -41,8 +58,37 @@ void cleanup_temp_db()
     }
 }
 
+// Number of records handed to each thread per batch; batches are written out
+// in input order before the next one is read
+constexpr size_t RECORDS_PER_THREAD_PER_BATCH = 64;
+
+const std::unordered_map<std::string, Format> FORMAT_NAMES = {
+    {"smiles", Format::SMILES},
+    {"cxsmiles", Format::EXTENDED_SMILES},
+    {"sdf", Format::MDL_MOLV3000},
+    {"mae", Format::MAESTRO},
+    {"pdb", Format::PDB},
+    {"inchi", Format::INCHI},
+    {"helm", Format::HELM},
+    {"fasta", Format::FASTA},
+};
+
+const std::unordered_map<std::string, Format> FASTA_TYPES = {
+    {"peptide", Format::FASTA_PEPTIDE},
+    {"rna", Format::FASTA_RNA},
+    {"dna", Format::FASTA_DNA},
+};
+
 struct Options {
     std::string db_path;
+    std::string input_path;
+    std::string output_path;
+    std::string errors_path;
+    std::optional<Format> input_format;
+    std::optional<Format> output_format;
+    Format fasta_type = Format::FASTA_PEPTIDE;
+    unsigned int num_threads = 1;
+    bool show_progress = false;
 };
 
 auto help_message = R"(
@@ -52,9 +98,26 @@ Reads SMILES strings from stdin (one per line, optionally followed by a space
 and a name), converts them to monomeric representation, and outputs HELM
 format to stdout (with optional name).
 
+Any other supported input and output formats may be used instead. Formats are
+taken from the file extensions unless given explicitly, and files ending in
+.gz or .zst are (de)compressed on the fly. Records are converted in parallel,
+and are always written in input order.
+
 Options:
-  --db FILE     Load custom monomer database from FILE (.sqlite/.db or .json)
-  -h, --help    Show this help message and exit\n";
+  -i, --input FILE         Read records from FILE instead of stdin
+  -o, --output FILE        Write records to FILE instead of stdout
+  --input-format FORMAT    One of smiles, cxsmiles, sdf, mae, pdb, inchi, helm
+                           or fasta (default: from extension, else smiles)
+  --output-format FORMAT   Same choices as --input-format (default: from
+                           extension, else helm)
+  --fasta-type TYPE        Sequence type of FASTA input: peptide, rna or dna
+                           (default: peptide)
+  -j, --threads N          Number of conversion threads (default: 1)
+  --errors FILE            Write records that fail to convert to FILE
+  --progress               Report progress and throughput to stderr
+  --db FILE                Load custom monomer database from FILE
+                           (.sqlite/.db or .json)
+  -h, --help               Show this help message and exit
 )";
 
 void print_usage(const char* program_name)
@@ -62,11 +125,36 @@ void print_usage(const char* program_name)
     std::cout << "Usage: " << program_name << " [OPTIONS]\n" << help_message;
 }
 
+[[noreturn]] void exit_with_usage_error(const char* program_name,
+                                        const std::string& message)
+{
+    std::cerr << "Error: " << message << "\n";
+    print_usage(program_name);
+    std::exit(1);
+}
+
+Format parse_format_name(const char* program_name, std::string name)
+{
+    boost::to_lower(name);
+    auto found = FORMAT_NAMES.find(name);
+    if (found == FORMAT_NAMES.end()) {
+        exit_with_usage_error(program_name, "Unknown format: " + name);
+    }
+    return found->second;
+}
+
 // Parse command-line arguments
 Options parse_args(int argc, char* argv[])
 {
     Options options;
 
+    auto get_value = [&](int& i, const std::string& arg) -> std::string {
+        if (i + 1 >= argc) {
+            exit_with_usage_error(argv[0], arg + " requires a value");
+        }
+        return argv[++i];
+    };
+
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
 
@@ -74,22 +162,64 @@ Options parse_args(int argc, char* argv[])
             print_usage(argv[0]);
             std::exit(0);
         } else if (arg == "--db") {
-            if (i + 1 >= argc) {
-                std::cerr << "Error: --db requires a file path\n";
-                print_usage(argv[0]);
-                std::exit(1);
+            options.db_path = get_value(i, arg);
+        } else if (arg == "-i" || arg == "--input") {
+            options.input_path = get_value(i, arg);
+        } else if (arg == "-o" || arg == "--output") {
+            options.output_path = get_value(i, arg);
+        } else if (arg == "--errors") {
+            options.errors_path = get_value(i, arg);
+        } else if (arg == "--input-format") {
+            options.input_format =
+                parse_format_name(argv[0], get_value(i, arg));
+        } else if (arg == "--output-format") {
+            options.output_format =
+                parse_format_name(argv[0], get_value(i, arg));
+        } else if (arg == "--fasta-type") {
+            auto type = get_value(i, arg);
+            boost::to_lower(type);
+            auto found = FASTA_TYPES.find(type);
+            if (found == FASTA_TYPES.end()) {
+                exit_with_usage_error(argv[0], "Unknown FASTA type: " + type);
+            }
+            options.fasta_type = found->second;
+        } else if (arg == "-j" || arg == "--threads") {
+            auto value = get_value(i, arg);
+            try {
+                auto num_threads = std::stoi(value);
+                if (num_threads < 1) {
+                    throw std::out_of_range(value);
+                }
+                options.num_threads = static_cast<unsigned int>(num_threads);
+            } catch (const std::exception&) {
+                exit_with_usage_error(argv[0],
+                                      "Invalid number of threads: " + value);
             }
-            options.db_path = argv[++i];
+        } else if (arg == "--progress") {
+            options.show_progress = true;
         } else {
-            std::cerr << "Error: Unknown option: " << arg << "\n";
-            print_usage(argv[0]);
-            std::exit(1);
+            exit_with_usage_error(argv[0], "Unknown option: " + arg);
         }
     }
 
     return options;
 }
 
+// Determines the format of a (possibly compressed) file from its extension
+Format get_format_from_path(const boost::filesystem::path& path)
+{
+    try {
+        return get_file_format(path);
+    } catch (const std::invalid_argument&) {
+        // get_file_format only knows a few compressed extensions, so retry
+        // without the compression suffix (e.g. "input.fasta.gz")
+        if (get_compression_type_from_ext(path) == CompressionType::UNKNOWN) {
+            throw;
+        }
+        return get_file_format(path.stem());
+    }
+}
+
 // Load a JSON or SQLite monomer database into the MonomerDatabase singleton.
 void load_custom_database(const std::string& db_path)
 {
@@ -135,6 +265,232 @@ void load_custom_database(const std::string& db_path)
                                  " (expected .sqlite or .json)");
     }
 }
+
+[[nodiscard]] bool is_line_format(const Format format)
+{
+    return format == Format::SMILES || format == Format::EXTENDED_SMILES ||
+           format == Format::INCHI || format == Format::HELM;
+}
+
+[[nodiscard]] bool is_fasta_input_format(const Format format)
+{
+    return format == Format::FASTA_PEPTIDE || format == Format::FASTA_RNA ||
+           format == Format::FASTA_DNA;
+}
+
+/**
+ * Splits an input stream into the text blocks of the individual records, so
+ * that each one can be passed to to_rdkit on its own.
+ */
+class RecordReader
+{
+  public:
+    RecordReader(std::istream& input, Format format) :
+        m_input(input),
+        m_format(format)
+    {
+        if (is_fasta_input_format(format)) {
+            m_fasta_reader.emplace(input);
+        }
+    }
+
+    [[nodiscard]] std::optional<std::string> next()
+    {
+        if (m_fasta_reader) {
+            return m_fasta_reader->next();
+        } else if (is_line_format(m_format)) {
+            return next_line();
+        } else if (m_format == Format::MDL_MOLV3000) {
+            return next_terminated_block("$$$$");
+        } else if (m_format == Format::PDB) {
+            return next_terminated_block("END");
+        } else if (m_format == Format::MAESTRO) {
+            return next_maestro_block();
+        }
+        // Formats without a record separator are read as a single record
+        if (m_exhausted) {
+            return std::nullopt;
+        }
+        m_exhausted = true;
+        std::stringstream buffer;
+        buffer << m_input.rdbuf();
+        return buffer.str();
+    }
+
+  private:
+    std::optional<std::string> next_line()
+    {
+        std::string line;
+        while (std::getline(m_input, line)) {
+            boost::trim_right(line);
+            if (!line.empty()) {
+                return line;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Returns the lines up to and including the given terminator line
+    std::optional<std::string>
+    next_terminated_block(std::string_view terminator)
+    {
+        std::string block;
+        std::string line;
+        while (std::getline(m_input, line)) {
+            block += line;
+            block += '\n';
+            boost::trim_right(line);
+            if (line == terminator) {
+                return block;
+            }
+        }
+        // allow a missing terminator on the last record
+        if (boost::trim_copy(block).empty()) {
+            return std::nullopt;
+        }
+        return block;
+    }
+
+    // Returns the next top-level f_m_ct block, prefixed with the file header
+    // so that it can be parsed on its own
+    std::optional<std::string> next_maestro_block()
+    {
+        std::string block;
+        std::string line;
+        int depth = 0;
+        bool in_quotes = false;
+        while (std::getline(m_input, line)) {
+            block += line;
+            block += '\n';
+            bool escaped = false;
+            for (auto c : line) {
+                if (escaped) {
+                    escaped = false;
+                } else if (c == '\\') {
+                    escaped = in_quotes;
+                } else if (c == '"') {
+                    in_quotes = !in_quotes;
+                } else if (!in_quotes && c == '{') {
+                    ++depth;
+                } else if (!in_quotes && c == '}') {
+                    --depth;
+                }
+            }
+            if (depth != 0 || boost::trim_copy(block).empty() ||
+                block.find('{') == std::string::npos) {
+                continue;
+            }
+            if (boost::trim_left_copy(block).starts_with("f_m_ct")) {
+                return m_maestro_header + block;
+            }
+            // the unnamed version block at the top of the file
+            m_maestro_header += block;
+            block.clear();
+        }
+        return std::nullopt;
+    }
+
+    std::istream& m_input;
+    Format m_format;
+    std::optional<fasta::FastaRecordReader> m_fasta_reader;
+    std::string m_maestro_header;
+    bool m_exhausted = false;
+};
+
+/**
+ * Converts a single record, using direct transcoding for sequence formats when
+ * possible so that no mol needs to be built.
+ */
+[[nodiscard]] std::string convert_record(const std::string& record,
+                                         const Format input_format,
+                                         const Format output_format)
+{
+    std::string output;
+    if (is_fasta_input_format(input_format) && output_format == Format::HELM) {
+        output = fasta::fasta_to_helm(record, input_format);
+    } else if (input_format == Format::HELM && output_format == Format::FASTA) {
+        output = fasta::helm_to_fasta(record);
+    } else {
+        auto mol = to_rdkit(record, input_format);
+        output = to_string(*mol, output_format);
+
+        std::string name;
+        if (is_line_format(output_format) &&
+            mol->getPropIfPresent("_Name", name) && !name.empty()) {
+            boost::trim_right(output);
+            output += " " + name;
+        }
+    }
+
+    if (!output.empty() && output.back() != '\n') {
+        output += '\n';
+    }
+    return output;
+}
+
+struct ConversionResult {
+    std::string output;
+    std::optional<std::string> error;
+};
+
+/**
+ * Converts all records using the given number of threads. Results are stored
+ * by index, so the caller can write them out in input order.
+ */
+[[nodiscard]] std::vector<ConversionResult>
+convert_records(const std::vector<std::string>& records,
+                const Format input_format, const Format output_format,
+                const unsigned int num_threads)
+{
+    std::vector<ConversionResult> results(records.size());
+    std::atomic<size_t> next_index = 0;
+    auto convert_next_records = [&]() {
+        for (auto i = next_index++; i < records.size(); i = next_index++) {
+            try {
+                results[i].output =
+                    convert_record(records[i], input_format, output_format);
+            } catch (const std::exception& e) {
+                results[i].error = e.what();
+            }
+        }
+    };
+
+    // this thread converts records too
+    auto num_workers = std::min<size_t>(num_threads, records.size());
+    num_workers = num_workers > 0 ? num_workers - 1 : 0;
+    std::vector<std::thread> workers;
+    workers.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+        workers.emplace_back(convert_next_records);
+    }
+    convert_next_records();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return results;
+}
+
+// MaeWriter includes the file header with every structure, but only the first
+// one should be kept when concatenating them
+void strip_maestro_header(std::string& mae_text)
+{
+    auto ct_start = mae_text.find("f_m_ct");
+    if (ct_start != std::string::npos) {
+        mae_text.erase(0, ct_start);
+    }
+}
+
+/**
+ * Prepares the lazily populated monomer database caches before any threads
+ * are started, since they are not safe to populate concurrently.
+ */
+void warm_monomer_database_caches()
+{
+    auto& db = MonomerDatabase::instance();
+    std::ignore = db.getEnumeratedCoreSmiles();
+    std::ignore = db.getComplexMonomerQueries();
+}
+
 } // namespace
 
 int main(int argc, char* argv[])
@@ -146,42 +502,134 @@ int main(int argc, char* argv[])
         if (!options.db_path.empty()) {
             load_custom_database(options.db_path);
         }
-
+        if (options.num_threads > 1) {
+            warm_monomer_database_caches();
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error loading database: " << e.what() << std::endl;
         return 1;
     }
 
-    std::string line;
-    auto status = 0;
-
-    while (std::getline(std::cin, line)) {
-        if (line.empty()) {
-            continue;
+    std::unique_ptr<maybe_compressed_istream> input_file;
+    std::unique_ptr<maybe_compressed_ostream> output_file;
+    std::unique_ptr<std::ofstream> errors_file;
+    try {
+        if (!options.input_path.empty()) {
+            input_file =
+                std::make_unique<maybe_compressed_istream>(options.input_path);
+            if (!options.input_format) {
+                options.input_format = get_format_from_path(options.input_path);
+            }
+        }
+        if (!options.output_path.empty()) {
+            output_file =
+                std::make_unique<maybe_compressed_ostream>(options.output_path);
+            if (!options.output_format) {
+                options.output_format =
+                    get_format_from_path(options.output_path);
+            }
         }
+        if (!options.errors_path.empty()) {
+            errors_file = std::make_unique<std::ofstream>(options.errors_path);
+            if (!errors_file->is_open()) {
+                throw std::runtime_error("Failed to open file: " +
+                                         options.errors_path);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
 
-        try {
-            auto mol = to_rdkit(line, Format::SMILES);
-            auto name = std::string{};
-            mol->getPropIfPresent("_Name", name);
+    // FASTA is only used to write, the input needs a sequence type
+    auto input_format = options.input_format.value_or(Format::SMILES);
+    if (input_format == Format::FASTA) {
+        input_format = options.fasta_type;
+    }
+    auto output_format = options.output_format.value_or(Format::HELM);
+    if (is_fasta_input_format(output_format)) {
+        output_format = Format::FASTA;
+    }
 
-            const RDKit::ROMol& mol_ref = *mol;
-            auto monomer_mol = toMonomeric(mol_ref);
+    std::istream& input = input_file ? *input_file : std::cin;
+    std::ostream& output = output_file ? *output_file : std::cout;
+    RecordReader reader(input, input_format);
+
+    auto status = 0;
+    size_t num_processed = 0;
+    size_t num_failed = 0;
+    auto start_time = std::chrono::steady_clock::now();
+    auto report_progress = [&](bool done) {
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start_time;
+        auto rate = elapsed.count() > 0 ? num_processed / elapsed.count() : 0.0;
+        std::cerr << "\rProcessed " << num_processed << " records ("
+                  << num_failed << " failed) in " << elapsed.count() << "s, "
+                  << static_cast<size_t>(rate) << " records/s"
+                  << (done ? "\n" : "") << std::flush;
+    };
+
+    // Conversions capture RDKit errors on each worker thread, and the error
+    // log's enabled state is global, so it is saved and restored once around
+    // the whole run rather than by every capture.
+    std::optional<CaptureRDErrorLog> run_capture_log;
+    if (options.num_threads > 1) {
+        run_capture_log.emplace();
+    }
 
-            std::string helm = to_string(*monomer_mol, Format::HELM);
-            std::cout << helm;
-            if (!name.empty()) {
-                std::cout << " " << name;
+    const auto batch_size = RECORDS_PER_THREAD_PER_BATCH * options.num_threads;
+    std::vector<std::string> records;
+    records.reserve(batch_size);
+    bool input_exhausted = false;
+    while (!input_exhausted) {
+        records.clear();
+        while (records.size() < batch_size) {
+            auto record = reader.next();
+            if (!record) {
+                input_exhausted = true;
+                break;
             }
-            std::cout << std::endl;
+            records.push_back(std::move(*record));
+        }
+
+        auto results = convert_records(records, input_format, output_format,
+                                       options.num_threads);
+        for (size_t i = 0; i < results.size(); ++i) {
+            auto& result = results[i];
+            ++num_processed;
+            if (result.error) {
+                std::cerr << "Error processing "
+                          << (input_format == Format::SMILES ? "SMILES"
+                                                             : "record")
+                          << " '" << boost::trim_copy(records[i])
+                          << "': " << *result.error << std::endl;
+                if (errors_file) {
+                    *errors_file << records[i];
+                    if (is_line_format(input_format)) {
+                        *errors_file << '\n';
+                    }
+                }
+                // Keep going, but exit with error status when done.
+                ++num_failed;
+                status = 1;
+                continue;
+            }
+            if (output_format == Format::MAESTRO &&
+                num_processed - num_failed > 1) {
+                strip_maestro_header(result.output);
+            }
+            output << result.output;
+        }
+        output.flush();
 
-        } catch (const std::exception& e) {
-            std::cerr << "Error processing SMILES '" << line
-                      << "': " << e.what() << std::endl;
-            // Keep going, but exit with error status when done.
-            status = 1;
+        if (options.show_progress) {
+            report_progress(input_exhausted);
         }
     }
 
+    if (run_capture_log) {
+        // anything logged on this thread outside of a conversion
+        std::cerr << run_capture_log->messages();
+    }
     return status;
 }
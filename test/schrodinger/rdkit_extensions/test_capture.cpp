@@ -8,6 +8,12 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <future>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include <rdkit/GraphMol/GraphMol.h>
 #include <rdkit/GraphMol/SmilesParse/SmilesParse.h>
 #include <rdkit/RDGeneral/RDLog.h>
@@ -51,3 +57,112 @@ BOOST_AUTO_TEST_CASE(testCaptureErrorLogEnabled)
     // We should have initialized && restored the error stream
     BOOST_CHECK(rdErrorLog && rdErrorLog->dp_dest == &std::cerr);
 }
+
+BOOST_AUTO_TEST_CASE(testCaptureErrorLogPerThread)
+{
+    // Each thread should only capture the errors logged on that thread
+    std::vector<std::string> bad_smarts{"garbage", "rubbish", "trash", "junk"};
+    std::vector<std::string> messages(bad_smarts.size());
+
+    {
+        CaptureRDErrorLog main_thread_capture_log;
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < bad_smarts.size(); ++i) {
+            threads.emplace_back([&, i]() {
+                CaptureRDErrorLog capture_log;
+                for (int j = 0; j < 10; ++j) {
+                    RDKit::SmartsToMol(bad_smarts[i]);
+                }
+                messages[i] = capture_log.messages();
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        BOOST_TEST(main_thread_capture_log.messages().empty());
+    }
+
+    for (size_t i = 0; i < bad_smarts.size(); ++i) {
+        for (size_t j = 0; j < bad_smarts.size(); ++j) {
+            auto err_msg = "Failed parsing SMARTS '" + bad_smarts[j] + "'";
+            BOOST_TEST((messages[i].find(err_msg) != std::string::npos) ==
+                       (i == j));
+        }
+    }
+
+    // We should have restored the error stream
+    BOOST_CHECK(rdErrorLog && rdErrorLog->dp_dest == &std::cerr);
+}
+
+BOOST_AUTO_TEST_CASE(testCaptureErrorLogEnabledStateAcrossThreads)
+{
+    // A capture ending on one thread must not disable logging for a capture
+    // that is still active on another, and the state from before the first
+    // capture must be restored once the last one ends
+    if (rdErrorLog == nullptr) {
+        RDLog::InitLogs();
+    }
+    RDLog::LogStateSetter silence_rdkit_logging;
+    BOOST_REQUIRE(!rdErrorLog->df_enabled);
+
+    std::promise<void> first_capture_started;
+    std::promise<void> first_capture_ended;
+    std::thread first_thread([&]() {
+        CaptureRDErrorLog capture_log;
+        first_capture_started.set_value();
+        first_capture_ended.get_future().wait();
+    });
+    first_capture_started.get_future().wait();
+
+    std::string messages;
+    {
+        CaptureRDErrorLog capture_log;
+        first_capture_ended.set_value();
+        first_thread.join();
+        RDKit::SmartsToMol("garbage");
+        messages = capture_log.messages();
+    }
+    BOOST_TEST(messages.find("Failed parsing SMARTS 'garbage'") !=
+               std::string::npos);
+    BOOST_TEST(!rdErrorLog->df_enabled);
+}
+
+BOOST_AUTO_TEST_CASE(testCaptureErrorLogFallbackFromSeveralThreads)
+{
+    // Threads that aren't capturing write to the original destination while a
+    // capture is active elsewhere, and their messages must not be interleaved
+    if (rdErrorLog == nullptr) {
+        RDLog::InitLogs();
+    }
+    std::ostringstream original_dest;
+    auto* saved_dest = rdErrorLog->dp_dest;
+    rdErrorLog->dp_dest = &original_dest;
+
+    const std::string message = "message logged outside of a capture";
+    const size_t num_threads = 4;
+    const size_t num_messages = 100;
+    {
+        CaptureRDErrorLog main_thread_capture_log;
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < num_threads; ++i) {
+            threads.emplace_back([&]() {
+                for (size_t j = 0; j < num_messages; ++j) {
+                    BOOST_LOG(rdErrorLog) << message << std::endl;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        BOOST_TEST(main_thread_capture_log.messages().empty());
+    }
+    rdErrorLog->dp_dest = saved_dest;
+
+    std::istringstream lines(original_dest.str());
+    size_t num_lines = 0;
+    for (std::string line; std::getline(lines, line); ++num_lines) {
+        BOOST_TEST(line.find(message) == line.size() - message.size());
+    }
+    BOOST_TEST(num_lines == num_threads * num_messages);
+}
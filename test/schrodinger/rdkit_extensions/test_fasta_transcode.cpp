@@ -0,0 +1,121 @@
+#define BOOST_TEST_MODULE test_fasta_transcode
+
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <rdkit/GraphMol/RWMol.h>
+
+#include "schrodinger/rdkit_extensions/fasta_examples.h"
+#include "schrodinger/rdkit_extensions/fasta/to_rdkit.h"
+#include "schrodinger/rdkit_extensions/fasta/to_string.h"
+#include "schrodinger/rdkit_extensions/fasta/transcode.h"
+#include "schrodinger/rdkit_extensions/helm/to_rdkit.h"
+#include "schrodinger/rdkit_extensions/helm/to_string.h"
+#include "schrodinger/test/checkexceptionmsg.h"
+
+using schrodinger::rdkit_extensions::Format;
+
+namespace bdata = boost::unit_test::data;
+
+BOOST_DATA_TEST_CASE(TestPeptideFastaToHelm,
+                     bdata::make(fasta::VALID_PEPTIDE_EXAMPLES), input_fasta)
+{
+    auto mol = fasta::peptide_fasta_to_rdkit(input_fasta);
+    BOOST_TEST(fasta::fasta_to_helm(input_fasta, Format::FASTA_PEPTIDE) ==
+               helm::rdkit_to_helm(*mol));
+}
+
+BOOST_DATA_TEST_CASE(TestNucleotideFastaToHelm,
+                     bdata::make(fasta::VALID_NUCLEOTIDE_EXAMPLES),
+                     input_fasta)
+{
+    auto mol = fasta::rna_fasta_to_rdkit(input_fasta);
+    BOOST_TEST(fasta::fasta_to_helm(input_fasta, Format::FASTA_RNA) ==
+               helm::rdkit_to_helm(*mol));
+
+    mol = fasta::dna_fasta_to_rdkit(input_fasta);
+    BOOST_TEST(fasta::fasta_to_helm(input_fasta, Format::FASTA_DNA) ==
+               helm::rdkit_to_helm(*mol));
+}
+
+BOOST_DATA_TEST_CASE(TestInvalidFastaToHelm,
+                     bdata::make(fasta::INVALID_PEPTIDE_EXAMPLES), input_fasta)
+{
+    BOOST_CHECK_THROW(
+        std::ignore = fasta::fasta_to_helm(input_fasta, Format::FASTA_PEPTIDE),
+        std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(TestFastaToHelmWithUnsupportedFormat)
+{
+    TEST_CHECK_EXCEPTION_MSG_SUBSTR(
+        std::ignore = fasta::fasta_to_helm(">\nAAPL", Format::FASTA),
+        std::invalid_argument, "FASTA_PEPTIDE, FASTA_DNA or FASTA_RNA");
+}
+
+BOOST_AUTO_TEST_CASE(TestFastaToHelmWithQuotedAnnotation)
+{
+    // quotes can't be written in a HELM annotation, so this should fail the
+    // same way as the mol-based conversion
+    TEST_CHECK_EXCEPTION_MSG_SUBSTR(
+        std::ignore = fasta::fasta_to_helm(">a \"quoted\" one\nAAPL",
+                                           Format::FASTA_PEPTIDE),
+        std::invalid_argument, "Couldn't convert FASTA sequence to mol.");
+}
+
+BOOST_DATA_TEST_CASE(
+    TestHelmToFasta,
+    bdata::make(std::vector<std::string>{
+        "PEPTIDE1{A.A.O.L}$$$$V2.0",
+        R"(PEPTIDE1{A.A.A}"some description"|PEPTIDE2{D.D.D}"something"$$$$V2.0)",
+        "PEPTIDE1{A.D(C)P.G}$$$$V2.0",
+        "PEPTIDE1{A.G.C.K.L}$PEPTIDE1,PEPTIDE1,5:R2-1:R1$$$V2.0",
+        R"(PEPTIDE1{A.C.D}|PEPTIDE2{D.A.C}$$G3(PEPTIDE1,PEPTIDE2)${"Name":"Test peptides"}$V2.0)",
+        R"(RNA1{R(A)P.R(A)P.R(U)P}"something"$$$$V2.0)",
+        R"(RNA1{[dR](A)P.[dR](A)P.[dR](A)P}"some description"|RNA2{[dR](T)P.[dR](T)P.[dR](T)P}"something"$$$$V2.0)",
+    }),
+    input_helm)
+{
+    auto mol = helm::helm_to_rdkit(input_helm);
+    BOOST_TEST(fasta::helm_to_fasta(input_helm) == fasta::rdkit_to_fasta(*mol));
+}
+
+BOOST_DATA_TEST_CASE(TestUnsupportedHelmToFasta,
+                     bdata::make(std::vector<std::string>{
+                         "PEPTIDE1{A.G'3'}$$$$V2.0",
+                         "PEPTIDE1{A.G.C.K.L}|BLOB1{Bead}$$$$V2.0",
+                         "PEPTIDE1{A.A.(E+Q).L}$$$$V2.0",
+                         "PEPTIDE1{A.[dA].C}$$$$V2.0",
+                         "RNA1{R}$$$$V2.0",
+                         "RNA1{R(A)P.[dR](A)P}$$$$V2.0",
+                         "RNA1{R(Z)P}$$$$V2.0",
+                     }),
+                     input_helm)
+{
+    BOOST_CHECK_THROW(std::ignore = fasta::helm_to_fasta(input_helm),
+                      std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(TestFastaRecordReader)
+{
+    std::istringstream input{"\n>first\nAAA\nCCC\n\n>second\nDDD\n>third\nEE"};
+    fasta::FastaRecordReader reader{input};
+
+    std::vector<std::string> records;
+    while (auto record = reader.next()) {
+        records.push_back(*record);
+    }
+    BOOST_TEST(records == (std::vector<std::string>{
+                             ">first\nAAA\nCCC\n\n",
+                             ">second\nDDD\n",
+                             ">third\nEE\n",
+                         }),
+               boost::test_tools::per_element());
+
+    BOOST_TEST(fasta::fasta_to_helm(records[0], Format::FASTA_PEPTIDE) ==
+               R"(PEPTIDE1{A.A.A.C.C.C}"first"$$$$V2.0)");
+}
@@ -44,3 +44,29 @@ BOOST_DATA_TEST_CASE(TestBranchMonomerGroups,
                                     std::invalid_argument,
                                     "Only one branch monomer is allowed");
 }
+
+BOOST_DATA_TEST_CASE(TestSmilesMonomerClassification,
+                     bdata::make(std::vector<std::string>{
+                         "dR", "meA", "Orn", "Aib", "NIB", "CCO", "ClCCBr",
+                         "c1ccccc1", "C[*:1]", "OC(=O)C"}) ^
+                         bdata::make(std::vector<bool>{false, false, false,
+                                                       false, true, true, true,
+                                                       true, true, true}),
+                     monomer_id, is_smiles)
+{
+    BOOST_TEST(helm::is_smiles_monomer(monomer_id) == is_smiles);
+}
+
+BOOST_AUTO_TEST_CASE(TestRepeatedSmilesMonomerClassification)
+{
+    // the classification is memoized per distinct id, so repeated ids have to
+    // get the same answer regardless of where they appear
+    auto parsed_info =
+        helm::parse_helm("PEPTIDE1{[dA].[meA].[dA].[meA]}|CHEM1{[CCO]}|"
+                         "CHEM2{[CCO]}$$$$V2.0");
+    for (const auto& polymer : parsed_info->polymers) {
+        for (const auto& monomer : polymer.monomers) {
+            BOOST_TEST(monomer.is_smiles == polymer.id.starts_with("CHEM"));
+        }
+    }
+}
@@ -5,9 +5,15 @@
 #include <rdkit/GraphMol/RWMol.h>
 #include "schrodinger/rdkit_extensions/helm/monomer_coordgen.h"
 
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <ranges>
+#include <set>
 #include <vector>
 #include <string>
 
+#include "schrodinger/rdkit_extensions/coord_utils.h"
 #include "schrodinger/rdkit_extensions/helm.h"
 #include "schrodinger/rdkit_extensions/helm/to_rdkit.h"
 
@@ -506,6 +512,173 @@ BOOST_DATA_TEST_CASE(
                                      << helm
                                      << "\nExpected coords: " << expected_str
                                      << "\nComputed coords: " << actual_str);
+
+    // laying out the polymers concurrently must not change the coordinates
+    auto threaded_mol = helm::helm_to_rdkit(helm);
+    schrodinger::rdkit_extensions::compute_monomer_mol_coords(*threaded_mol,
+                                                              4);
+    auto& threaded_conformer = threaded_mol->getConformer();
+    for (unsigned int i = 0; i < mol->getNumAtoms(); ++i) {
+        BOOST_TEST(threaded_conformer.getAtomPos(i).x ==
+                   conformer.getAtomPos(i).x);
+        BOOST_TEST(threaded_conformer.getAtomPos(i).y ==
+                   conformer.getAtomPos(i).y);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestConcurrentLayoutOfSeveralPolymers)
+{
+    // The cyclic polymers are laid out with turns, which must mark their
+    // monomers as placed using indices into the whole molecule so that the
+    // polymers bonded to them are laid out the same way on any thread
+    std::vector<std::string> helms{
+        "PEPTIDE1{C.A.A.A.A.A.A.A.A.A.A.A.A.A.A.A.A.A.A.C}|PEPTIDE2{D.E.F.G}|"
+        "PEPTIDE3{K.L.M.N.P.Q.R.S.T.V.W.Y}$PEPTIDE1,PEPTIDE1,1:R3-20:R3|"
+        "PEPTIDE1,PEPTIDE2,10:R3-1:R1|PEPTIDE2,PEPTIDE3,4:R2-1:R1|"
+        "PEPTIDE3,PEPTIDE3,12:R2-1:R1$$$V2.0",
+        "PEPTIDE1{C.A.C.A.A.A.A.A.A.A.A.A.A.A.A.A.A.A.A.C.A.C}|"
+        "PEPTIDE2{A.C.A.A.A.A.A.A.A.A.A.A.A.A.A.C.A}|PEPTIDE3{D.E.F.G}$"
+        "PEPTIDE1,PEPTIDE1,1:R3-22:R3|PEPTIDE1,PEPTIDE1,3:R3-20:R3|"
+        "PEPTIDE2,PEPTIDE2,2:R3-16:R3|PEPTIDE1,PEPTIDE2,11:R1-1:R1|"
+        "PEPTIDE2,PEPTIDE3,9:R3-1:R1$$$V2.0",
+    };
+    for (const auto& helm : helms) {
+        BOOST_TEST_CONTEXT(helm)
+        {
+            auto mol = helm_to_rdkit(helm);
+            compute_monomer_mol_coords(*mol);
+            auto threaded_mol = helm_to_rdkit(helm);
+            compute_monomer_mol_coords(*threaded_mol, 4);
+            auto& conformer = mol->getConformer();
+            auto& threaded_conformer = threaded_mol->getConformer();
+            for (unsigned int i = 0; i < mol->getNumAtoms(); ++i) {
+                BOOST_TEST(threaded_conformer.getAtomPos(i).x ==
+                           conformer.getAtomPos(i).x);
+                BOOST_TEST(threaded_conformer.getAtomPos(i).y ==
+                           conformer.getAtomPos(i).y);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestUpdateMonomerCoords)
+{
+    using schrodinger::rdkit_extensions::update_monomer_mol_coords;
+    auto mol = helm_to_rdkit("PEPTIDE1{A.C.D.E}|PEPTIDE2{F.G.H}$$$$V2.0");
+    compute_monomer_mol_coords(*mol);
+    const auto& positions = mol->getConformer().getPositions();
+
+    // nothing changed, so nothing moves
+    auto unchanged_positions = positions;
+    update_monomer_mol_coords(*mol, {});
+    for (unsigned int i = 0; i < positions.size(); ++i) {
+        BOOST_TEST(positions[i].x == unchanged_positions[i].x);
+        BOOST_TEST(positions[i].y == unchanged_positions[i].y);
+    }
+
+    // append a monomer to the second peptide, starting from the coordinates
+    // from before the edit
+    auto edited_mol =
+        helm_to_rdkit("PEPTIDE1{A.C.D.E}|PEPTIDE2{F.G.H.I}$$$$V2.0");
+    auto conformer = new RDKit::Conformer(edited_mol->getNumAtoms());
+    for (unsigned int i = 0; i < mol->getNumAtoms(); ++i) {
+        conformer->setAtomPos(i, positions[i]);
+    }
+    edited_mol->addConformer(conformer, true);
+    update_monomer_mol_coords(*edited_mol, {7});
+
+    // the first peptide keeps its coordinates
+    const auto& edited_positions = edited_mol->getConformer().getPositions();
+    for (unsigned int i = 0; i < 4; ++i) {
+        BOOST_TEST(edited_positions[i].x == positions[i].x);
+        BOOST_TEST(edited_positions[i].y == positions[i].y);
+    }
+    BOOST_TEST(
+        schrodinger::rdkit_extensions::coordinates_are_valid(*edited_mol));
+}
+
+BOOST_AUTO_TEST_CASE(TestUpdateMonomerCoordsOfSinglePolymer)
+{
+    using schrodinger::rdkit_extensions::update_monomer_mol_coords;
+    const std::string helm = "PEPTIDE1{A.C.D.E.F}$$$$V2.0";
+    auto expected_mol = helm_to_rdkit(helm);
+    compute_monomer_mol_coords(*expected_mol);
+
+    // changing the only polymer lays out the whole mol again
+    auto mol = helm_to_rdkit(helm);
+    compute_monomer_mol_coords(*mol);
+    mol->getConformer().setAtomPos(4, RDGeom::Point3D(100, 100, 0));
+    update_monomer_mol_coords(*mol, {4});
+    for (unsigned int i = 0; i < mol->getNumAtoms(); ++i) {
+        BOOST_TEST(mol->getConformer().getAtomPos(i).x ==
+                   expected_mol->getConformer().getAtomPos(i).x);
+        BOOST_TEST(mol->getConformer().getAtomPos(i).y ==
+                   expected_mol->getConformer().getAtomPos(i).y);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestUpdateMonomerCoordsChecksMovedChemMonomers)
+{
+    using schrodinger::rdkit_extensions::update_monomer_mol_coords;
+    auto mol = helm_to_rdkit(
+        "CHEM1{[SMCC]}|PEPTIDE1{A.A.A}|PEPTIDE2{G.G.G}|PEPTIDE3{L}$PEPTIDE1,"
+        "CHEM1,3:R2-1:R1|CHEM1,PEPTIDE2,1:R2-1:R1$$$V2.0");
+    compute_monomer_mol_coords(*mol);
+
+    // spread everything out, except that the monomer of the third peptide is
+    // placed exactly where the CHEM linker will be moved to: between the two
+    // monomers it connects
+    auto& conformer = mol->getConformer();
+    for (unsigned int i = 0; i < mol->getNumAtoms(); ++i) {
+        conformer.setAtomPos(i, RDGeom::Point3D(10.0 * i, 50.0, 0.0));
+    }
+    const unsigned int chem_idx = 0;
+    const unsigned int lone_monomer_idx = mol->getNumAtoms() - 1;
+    auto neighbors = mol->atomNeighbors(mol->getAtomWithIdx(chem_idx));
+    conformer.setAtomPos((*neighbors.begin())->getIdx(),
+                         RDGeom::Point3D(0.0, 0.0, 0.0));
+    conformer.setAtomPos((*std::next(neighbors.begin()))->getIdx(),
+                         RDGeom::Point3D(3.0, 0.0, 0.0));
+    conformer.setAtomPos(lone_monomer_idx, RDGeom::Point3D(1.5, 0.0, 0.0));
+
+    // nothing changed, but moving the linker makes it clash with the third
+    // peptide, so the whole mol must be laid out again
+    update_monomer_mol_coords(*mol, {});
+    BOOST_TEST(schrodinger::rdkit_extensions::has_no_clashes(*mol));
+}
+
+BOOST_AUTO_TEST_CASE(TestCompute2DCoordsWithFrozenMonomersAddsConformer)
+{
+    const std::string helm = "PEPTIDE1{A.C.D.E}|PEPTIDE2{F.G.H}$$$$V2.0";
+    auto mol = helm_to_rdkit(helm);
+    auto original_id = compute_monomer_mol_coords(*mol);
+    auto original_positions = mol->getConformer(original_id).getPositions();
+
+    // freeze the first peptide, and move the second one so that it needs to
+    // be laid out again
+    for (unsigned int i = 4; i < mol->getNumAtoms(); ++i) {
+        mol->getConformer(original_id)
+            .setAtomPos(i, RDGeom::Point3D(100.0 + i, 100.0, 0.0));
+    }
+    auto moved_positions = mol->getConformer(original_id).getPositions();
+    auto new_id =
+        schrodinger::rdkit_extensions::compute2DCoords(*mol, {0, 1, 2, 3});
+
+    // the coordinates are added as a new conformer, and the existing one is
+    // left alone
+    BOOST_TEST(new_id != original_id);
+    BOOST_TEST(mol->getNumConformers() == 2);
+    const auto& old_positions = mol->getConformer(original_id).getPositions();
+    const auto& new_positions = mol->getConformer(new_id).getPositions();
+    for (unsigned int i = 0; i < mol->getNumAtoms(); ++i) {
+        BOOST_TEST(old_positions[i].x == moved_positions[i].x);
+        BOOST_TEST(old_positions[i].y == moved_positions[i].y);
+    }
+    // the frozen peptide keeps its coordinates in the new conformer
+    for (unsigned int i = 0; i < 4; ++i) {
+        BOOST_TEST(new_positions[i].x == original_positions[i].x);
+        BOOST_TEST(new_positions[i].y == original_positions[i].y);
+    }
 }
 
 BOOST_AUTO_TEST_SUITE(TestMonomerCoordgenCheckCoords)
@@ -650,6 +823,101 @@ BOOST_AUTO_TEST_CASE(TouchingBondsNoCross)
     BOOST_CHECK(!schrodinger::rdkit_extensions::has_no_bond_crossings(mol));
 }
 
+BOOST_AUTO_TEST_CASE(ClashesInLargeLayout)
+{
+    // a large lattice of well separated monomers, spanning negative and
+    // positive coordinates, with chain bonds along each row
+    std::vector<std::pair<double, double>> xy;
+    std::vector<std::pair<int, int>> bonds;
+    constexpr int LATTICE_SIZE = 60;
+    for (int row = 0; row < LATTICE_SIZE; ++row) {
+        for (int col = 0; col < LATTICE_SIZE; ++col) {
+            if (col > 0) {
+                bonds.push_back({static_cast<int>(xy.size()) - 1,
+                                 static_cast<int>(xy.size())});
+            }
+            xy.push_back({(col - LATTICE_SIZE / 2) * 1.5,
+                          (row - LATTICE_SIZE / 2) * 1.5});
+        }
+    }
+    BOOST_TEST(schrodinger::rdkit_extensions::has_no_clashes(
+        make_molecule_with_coords(xy, bonds)));
+    BOOST_TEST(schrodinger::rdkit_extensions::has_no_bond_crossings(
+        make_molecule_with_coords(xy, bonds)));
+
+    // a monomer right next to the last one added
+    auto clashing_xy = xy;
+    clashing_xy.push_back({xy.back().first + 0.1, xy.back().second - 0.1});
+    BOOST_TEST(!schrodinger::rdkit_extensions::has_no_clashes(
+        make_molecule_with_coords(clashing_xy, bonds)));
+
+    // a long bond crossing many rows
+    auto crossing_xy = xy;
+    crossing_xy.push_back({-100.0, -100.0});
+    crossing_xy.push_back({100.0, 100.0});
+    auto crossing_bonds = bonds;
+    crossing_bonds.push_back({static_cast<int>(xy.size()),
+                              static_cast<int>(xy.size()) + 1});
+    BOOST_TEST(!schrodinger::rdkit_extensions::has_no_bond_crossings(
+        make_molecule_with_coords(crossing_xy, crossing_bonds)));
+
+    // the same long bond, far away from the lattice
+    for (auto& [x, y] : std::views::drop(crossing_xy, xy.size())) {
+        x += 1000.0;
+    }
+    BOOST_TEST(schrodinger::rdkit_extensions::has_no_bond_crossings(
+        make_molecule_with_coords(crossing_xy, crossing_bonds)));
+}
+
+BOOST_AUTO_TEST_CASE(BondCrossingsMatchAllPairsCheck)
+{
+    // compare against checking every pair of bonds on random layouts, most of
+    // which have crossings and some of which don't
+    std::mt19937 generator(42);
+    for (int layout = 0; layout < 50; ++layout) {
+        auto num_atoms = 4 + layout;
+        std::uniform_real_distribution<double> coord(-2.0 * num_atoms,
+                                                     2.0 * num_atoms);
+        std::uniform_int_distribution<int> atom(0, num_atoms - 1);
+        std::vector<std::pair<double, double>> xy;
+        for (int i = 0; i < num_atoms; ++i) {
+            xy.push_back({coord(generator), coord(generator)});
+        }
+        std::set<std::pair<int, int>> bonds;
+        for (int i = 0; i < num_atoms / 2; ++i) {
+            auto begin = atom(generator);
+            auto end = atom(generator);
+            if (begin != end) {
+                bonds.insert(std::minmax(begin, end));
+            }
+        }
+        auto mol = make_molecule_with_coords(xy, {bonds.begin(), bonds.end()});
+
+        bool expected_no_crossings = true;
+        const auto& conformer = mol.getConformer();
+        for (auto bond1 : mol.bonds()) {
+            for (auto bond2 : mol.bonds()) {
+                if (bond1->getIdx() >= bond2->getIdx() ||
+                    bond1->getBeginAtomIdx() == bond2->getBeginAtomIdx() ||
+                    bond1->getBeginAtomIdx() == bond2->getEndAtomIdx() ||
+                    bond1->getEndAtomIdx() == bond2->getBeginAtomIdx() ||
+                    bond1->getEndAtomIdx() == bond2->getEndAtomIdx()) {
+                    continue;
+                }
+                if (schrodinger::rdkit_extensions::bonds_are_too_close(
+                        conformer.getAtomPos(bond1->getBeginAtomIdx()),
+                        conformer.getAtomPos(bond1->getEndAtomIdx()),
+                        conformer.getAtomPos(bond2->getBeginAtomIdx()),
+                        conformer.getAtomPos(bond2->getEndAtomIdx()))) {
+                    expected_no_crossings = false;
+                }
+            }
+        }
+        BOOST_TEST(schrodinger::rdkit_extensions::has_no_bond_crossings(mol) ==
+                   expected_no_crossings);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(IsGeometricallyRegularRing2D_RegularPolygon)
 {
     // Create a regular hexagon (6-sided polygon), should be detected as
@@ -743,4 +1011,126 @@ BOOST_AUTO_TEST_CASE(TestPositionInCoilsScore)
     }
 }
 
+/**
+ * Reference implementation of the coiling turn search, which scores the turns
+ * of every candidate layout with score_coiling_layout and keeps the first one
+ * with the lowest score
+ */
+static std::vector<schrodinger::rdkit_extensions::TurnInfo>
+find_best_coiling_turns_exhaustively(const RDKit::ROMol& polymer)
+{
+    using schrodinger::rdkit_extensions::CustomBondInfo;
+    using schrodinger::rdkit_extensions::TurnInfo;
+    std::vector<CustomBondInfo> custom_bonds;
+    for (const auto& bond : polymer.bonds()) {
+        if (bond->hasProp(CUSTOM_BOND)) {
+            auto [i, j] = std::minmax(bond->getBeginAtomIdx(),
+                                      bond->getEndAtomIdx());
+            custom_bonds.push_back({i, j});
+        }
+    }
+    std::sort(
+        custom_bonds.begin(), custom_bonds.end(),
+        [](const auto& a, const auto& b) { return a.monomer_i < b.monomer_i; });
+
+    auto num_monomers = polymer.getNumAtoms();
+    std::vector<TurnInfo> best_turns;
+    float best_score = 0;
+    for (auto increment : {2, -2}) {
+        for (auto turn_size = 0; turn_size < 3; ++turn_size) {
+            for (auto chain_size = 1; chain_size < 8; ++chain_size) {
+                for (auto first_chain_size = 1; first_chain_size <= chain_size;
+                     ++first_chain_size) {
+                    auto cur_turn_size = turn_size;
+                    if (increment < 0) {
+                        unsigned int placed_residues = first_chain_size;
+                        while (placed_residues < num_monomers) {
+                            placed_residues += cur_turn_size + chain_size;
+                            cur_turn_size += abs(increment);
+                        }
+                        cur_turn_size -= abs(increment);
+                    }
+                    std::vector<TurnInfo> turns;
+                    unsigned int residues_accounted = 0;
+                    unsigned int cur_chain_size = first_chain_size;
+                    bool downward = true;
+                    while (residues_accounted < num_monomers) {
+                        if (cur_turn_size < 0) {
+                            turns.clear();
+                            break;
+                        }
+                        auto position = residues_accounted + cur_chain_size;
+                        if (position >= num_monomers) {
+                            break;
+                        }
+                        turns.push_back(
+                            {position, static_cast<unsigned int>(cur_turn_size),
+                             downward, 0});
+                        residues_accounted += cur_chain_size + cur_turn_size;
+                        cur_chain_size = chain_size;
+                        cur_turn_size += increment;
+                        downward = !downward;
+                    }
+                    if (turns.empty()) {
+                        continue;
+                    }
+                    auto score = static_cast<float>(
+                        schrodinger::rdkit_extensions::score_coiling_layout(
+                            polymer, turns, custom_bonds));
+                    if (best_turns.empty() || score < best_score) {
+                        best_turns = turns;
+                        best_score = score;
+                    }
+                }
+            }
+        }
+    }
+    return best_turns;
+}
+
+BOOST_AUTO_TEST_CASE(TestCoilingTurnsMatchExhaustiveSearch)
+{
+    // The coiling turn search prunes candidates, but must still pick the same
+    // layout as scoring every candidate in full
+    std::mt19937 rng(1234);
+    for (unsigned int num_monomers = 8; num_monomers <= 60; num_monomers += 4) {
+        for (unsigned int num_bonds = 1; num_bonds <= 4; ++num_bonds) {
+            // pairing the first half of the sorted positions with the second
+            // half gives bonds that don't cross
+            std::vector<unsigned int> positions(num_monomers);
+            std::iota(positions.begin(), positions.end(), 1);
+            std::shuffle(positions.begin(), positions.end(), rng);
+            positions.resize(num_bonds * 2);
+            std::sort(positions.begin(), positions.end());
+
+            std::string helm = "PEPTIDE1{C";
+            for (unsigned int i = 1; i < num_monomers; ++i) {
+                helm += ".C";
+            }
+            helm += "}$";
+            for (unsigned int i = 0; i < num_bonds; ++i) {
+                helm += (i == 0 ? "" : "|");
+                helm += "PEPTIDE1,PEPTIDE1," + std::to_string(positions[i]) +
+                        ":R3-" + std::to_string(positions[i + num_bonds]) +
+                        ":R3";
+            }
+            helm += "$$$";
+            BOOST_TEST_CONTEXT(helm)
+            {
+                auto mol = helm_to_rdkit(helm);
+                auto turns = schrodinger::rdkit_extensions::
+                    compute_coiling_turns_for_chain(*mol);
+                auto expected_turns =
+                    find_best_coiling_turns_exhaustively(*mol);
+                BOOST_TEST_REQUIRE(turns.size() == expected_turns.size());
+                for (size_t i = 0; i < turns.size(); ++i) {
+                    BOOST_TEST(turns[i].position == expected_turns[i].position);
+                    BOOST_TEST(turns[i].size == expected_turns[i].size);
+                    BOOST_TEST(turns[i].downward == expected_turns[i].downward);
+                }
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
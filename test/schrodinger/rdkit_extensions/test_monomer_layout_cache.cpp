@@ -0,0 +1,93 @@
+#define BOOST_TEST_MODULE rdkit_extensions_monomer_layout_cache
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/test/unit_test.hpp>
+#include <rdkit/GraphMol/RWMol.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "schrodinger/rdkit_extensions/helm/monomer_coordgen.h"
+#include "schrodinger/rdkit_extensions/helm/monomer_layout_cache.h"
+#include "schrodinger/rdkit_extensions/helm/to_rdkit.h"
+
+using namespace schrodinger::rdkit_extensions;
+
+static std::vector<RDGeom::Point3D> make_positions(double x)
+{
+    return {RDGeom::Point3D(x, 0, 0), RDGeom::Point3D(x, 1.5, 0)};
+}
+
+BOOST_AUTO_TEST_CASE(TestLeastRecentlyUsedLayoutIsEvicted)
+{
+    MonomerLayoutCache cache(2);
+    cache.insert("a", make_positions(1));
+    cache.insert("b", make_positions(2));
+    // use "a" so that "b" becomes the least recently used layout
+    BOOST_TEST(cache.get("a").has_value());
+    cache.insert("c", make_positions(3));
+
+    BOOST_TEST(cache.size() == 2);
+    BOOST_TEST(!cache.get("b").has_value());
+    BOOST_TEST(cache.get("a")->at(0).x == 1);
+    BOOST_TEST(cache.get("c")->at(0).x == 3);
+
+    cache.clear();
+    BOOST_TEST(cache.size() == 0);
+    BOOST_TEST(!cache.get("a").has_value());
+}
+
+BOOST_AUTO_TEST_CASE(TestLayoutsAreLoadedFromDirectory)
+{
+    auto directory = boost::filesystem::temp_directory_path() /
+                     boost::filesystem::unique_path();
+    auto store = std::make_shared<DirectoryMonomerLayoutStore>(directory);
+    const std::vector<RDGeom::Point3D> positions{
+        RDGeom::Point3D(0.1, 1.0 / 3, 0), RDGeom::Point3D(-2e10, 7.25, 0)};
+    MonomerLayoutCache(1, store).insert("some key", positions);
+
+    // a fresh cache only finds the layout in the store
+    MonomerLayoutCache cache(1, store);
+    auto loaded_positions = cache.get("some key");
+    BOOST_REQUIRE(loaded_positions.has_value());
+    BOOST_TEST(loaded_positions->size() == positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        BOOST_TEST(loaded_positions->at(i).x == positions[i].x);
+        BOOST_TEST(loaded_positions->at(i).y == positions[i].y);
+    }
+    BOOST_TEST(cache.size() == 1);
+    BOOST_TEST(!cache.get("another key").has_value());
+
+    boost::filesystem::remove_all(directory);
+}
+
+BOOST_AUTO_TEST_CASE(TestComputeMonomerCoordsUsesCache)
+{
+    const std::string helm =
+        "PEPTIDE1{A.C.D.E.F}|PEPTIDE2{G.H.I}$PEPTIDE1,PEPTIDE2,3:R3-1:R1$$$V2.0";
+    auto expected_mol = helm::helm_to_rdkit(helm);
+    compute_monomer_mol_coords(*expected_mol);
+
+    auto cache = std::make_shared<MonomerLayoutCache>(8);
+    set_monomer_layout_cache(cache);
+    auto mol = helm::helm_to_rdkit(helm);
+    compute_monomer_mol_coords(*mol);
+    BOOST_TEST(cache->size() == 1);
+
+    // laying out the same monomer graph again reuses the cached layout
+    auto cached_mol = helm::helm_to_rdkit(helm);
+    compute_monomer_mol_coords(*cached_mol);
+    BOOST_TEST(cache->size() == 1);
+    set_monomer_layout_cache(nullptr);
+
+    for (auto laid_out_mol : {mol.get(), cached_mol.get()}) {
+        auto& conformer = laid_out_mol->getConformer();
+        for (unsigned int i = 0; i < expected_mol->getNumAtoms(); ++i) {
+            BOOST_TEST(conformer.getAtomPos(i).x ==
+                       expected_mol->getConformer().getAtomPos(i).x);
+            BOOST_TEST(conformer.getAtomPos(i).y ==
+                       expected_mol->getConformer().getAtomPos(i).y);
+        }
+    }
+}
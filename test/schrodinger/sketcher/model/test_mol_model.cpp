@@ -387,6 +387,170 @@ BOOST_AUTO_TEST_CASE(test_addAtomChain)
     BOOST_TEST(mol->getNumBonds() == 4);
 }
 
+/**
+ * An undo command from outside of MolModel that counts how many times it's been
+ * undone
+ */
+class CountingUndoCommand : public QUndoCommand
+{
+  public:
+    CountingUndoCommand(int& num_undos) : QUndoCommand(), m_num_undos(num_undos)
+    {
+    }
+    void redo() override
+    {
+    }
+    void undo() override
+    {
+        ++m_num_undos;
+    }
+
+  protected:
+    int& m_num_undos;
+};
+
+/**
+ * Make sure that the oldest commands are discarded once the molecule snapshots
+ * in the undo history get too large, but that newer commands and commands from
+ * outside of MolModel can still be undone
+ */
+BOOST_AUTO_TEST_CASE(test_maxUndoHistorySize)
+{
+    QUndoStack undo_stack;
+    TestMolModel model(&undo_stack);
+    const RDKit::ROMol* mol = model.getMol();
+    int num_other_undos = 0;
+    undo_stack.push(new CountingUndoCommand(num_other_undos));
+    // snapshots with 0, 1, 2, and 3 atoms fit in the history, but adding the
+    // snapshot with 4 atoms requires discarding the snapshots with 0 and 1
+    // atoms, i.e. the first two commands
+    model.setMaxUndoHistorySize(9);
+    model.addMonomer("A", ChainType::PEPTIDE, {1.0, 2.0, 0.0});
+    model.addMonomer("G", ChainType::PEPTIDE, {3.0, 4.0, 0.0});
+    model.addMonomer("L", ChainType::PEPTIDE, {5.0, 6.0, 0.0});
+    model.addMonomer("S", ChainType::PEPTIDE, {7.0, 8.0, 0.0});
+    BOOST_TEST(undo_stack.count() == 5);
+    BOOST_TEST(mol->getNumAtoms() == 4);
+
+    undo_stack.undo();
+    BOOST_TEST(mol->getNumAtoms() == 3);
+    undo_stack.undo();
+    BOOST_TEST(mol->getNumAtoms() == 2);
+    // the discarded commands don't do anything
+    undo_stack.undo();
+    undo_stack.undo();
+    BOOST_TEST(mol->getNumAtoms() == 2);
+    // but the other command is still there
+    BOOST_TEST(num_other_undos == 0);
+    undo_stack.undo();
+    BOOST_TEST(num_other_undos == 1);
+    BOOST_TEST(!undo_stack.canUndo());
+
+    for (int i = 0; i < 5; ++i) {
+        undo_stack.redo();
+    }
+    BOOST_TEST(mol->getNumAtoms() == 4);
+    check_coords(mol, 3, 7.0, 8.0);
+
+    // the history is still too large, but commands that don't change the
+    // molecule never discard anything
+    model.selectAll();
+    undo_stack.undo();
+    undo_stack.undo();
+    BOOST_TEST(mol->getNumAtoms() == 3);
+}
+
+/**
+ * Make sure that commands that were undone and then replaced by a new command
+ * don't count towards the undo history size
+ */
+BOOST_AUTO_TEST_CASE(test_maxUndoHistorySize_after_undo)
+{
+    QUndoStack undo_stack;
+    TestMolModel model(&undo_stack);
+    const RDKit::ROMol* mol = model.getMol();
+    // snapshots with 0, 1, 2, and 3 monomers fit in the history
+    model.setMaxUndoHistorySize(6);
+    for (int i = 0; i < 3; ++i) {
+        model.addMonomer("A", ChainType::PEPTIDE, {2.0 * i, 0.0, 0.0});
+    }
+    undo_stack.undo();
+    undo_stack.undo();
+    BOOST_TEST(mol->getNumAtoms() == 1);
+
+    // the new command replaces the snapshots with 2 and 3 monomers, so nothing
+    // needs to be discarded
+    model.addMonomer("G", ChainType::PEPTIDE, {5.0, 0.0, 0.0});
+    BOOST_TEST(mol->getNumAtoms() == 2);
+    undo_stack.undo();
+    BOOST_TEST(mol->getNumAtoms() == 1);
+    undo_stack.undo();
+    BOOST_TEST(mol->getNumAtoms() == 0);
+}
+
+/**
+ * Make sure that adding, mutating, and removing atoms and bonds only store the
+ * atoms and bonds that changed, and that undoing and redoing them puts every
+ * atom and bond back at its original index
+ */
+BOOST_AUTO_TEST_CASE(test_undo_history_stores_only_changes)
+{
+    QUndoStack undo_stack;
+    TestMolModel model(&undo_stack);
+    const RDKit::ROMol* mol = model.getMol();
+    import_mol_text(&model, "CC[C@H](N)CCCCCCCCCCCCCCCCCCCO");
+    // the symbol, tag, and coordinates of each atom and the tag, atom tags,
+    // and bond type of each bond, in index order
+    using State = std::pair<std::vector<std::tuple<std::string, int, double>>,
+                            std::vector<std::tuple<int, int, int, int>>>;
+    auto get_state = [&model, mol]() {
+        State state;
+        for (auto* atom : mol->atoms()) {
+            auto x = mol->getConformer().getAtomPos(atom->getIdx()).x;
+            state.first.emplace_back(atom->getSymbol(),
+                                     model.getTagForAtom(atom), x);
+        }
+        for (auto* bond : mol->bonds()) {
+            state.second.emplace_back(model.getTagForBond(bond),
+                                      model.getTagForAtom(bond->getBeginAtom()),
+                                      model.getTagForAtom(bond->getEndAtom()),
+                                      bond->getBondType());
+        }
+        return state;
+    };
+    auto initial_state = get_state();
+    BOOST_TEST(mol->getStereoGroups().size() == 1);
+
+    // the molecule alone is larger than this limit, so the commands below would
+    // discard each other if they stored the whole molecule
+    model.setMaxUndoHistorySize(20);
+    model.addAtom(Element::C, RDGeom::Point3D(-5.0, 5.0, 0.0),
+                  mol->getAtomWithIdx(0));
+    model.mutateAtoms({mol->getAtomWithIdx(6)}, Element::S);
+    model.mutateBonds({mol->getBondWithIdx(8)}, BondTool::DOUBLE);
+    // remove an atom from the middle of the molecule, which also removes the
+    // chiral center
+    model.remove({mol->getAtomWithIdx(4)}, {}, {}, {}, {});
+    BOOST_TEST(mol->getNumAtoms() == initial_state.first.size());
+    BOOST_TEST(mol->getNumBonds() == initial_state.second.size() - 1);
+    BOOST_TEST(mol->getAtomWithIdx(2)->getChiralTag() ==
+               RDKit::Atom::CHI_UNSPECIFIED);
+    auto edited_state = get_state();
+
+    for (int i = 0; i < 4; ++i) {
+        undo_stack.undo();
+    }
+    BOOST_TEST((get_state() == initial_state));
+    BOOST_TEST(mol->getStereoGroups().size() == 1);
+    BOOST_TEST(mol->getAtomWithIdx(2)->getChiralTag() !=
+               RDKit::Atom::CHI_UNSPECIFIED);
+
+    for (int i = 0; i < 4; ++i) {
+        undo_stack.redo();
+    }
+    BOOST_TEST((get_state() == edited_state));
+}
+
 BOOST_AUTO_TEST_CASE(test_addAtom_query)
 {
     QUndoStack undo_stack;
@@ -1178,11 +1342,90 @@ BOOST_AUTO_TEST_CASE(test_addMol_size_cutoff)
     QUndoStack undo_stack;
     TestMolModel model(&undo_stack);
     import_mol_text(&model, std::string(MAX_NUM_ATOMS_FOR_IMPORT, 'C'));
+    BOOST_TEST(model.getMol()->getNumAtoms() == MAX_NUM_ATOMS_FOR_IMPORT);
     BOOST_CHECK_THROW(
         import_mol_text(&model, std::string(MAX_NUM_ATOMS_FOR_IMPORT + 1, 'C')),
         std::runtime_error);
 }
 
+/**
+ * Make sure that CIP labels that were deferred for a large molecule are
+ * assigned on request and on export
+ */
+BOOST_AUTO_TEST_CASE(test_assignDeferredCIPLabels)
+{
+    QUndoStack undo_stack;
+    TestMolModel model(&undo_stack);
+    QSignalSpy model_changed_spy(&model, &MolModel::modelChanged);
+    auto large_smiles =
+        "C[C@H](N)" + std::string(LARGE_MOLECULE_ATOM_THRESHOLD, 'C');
+    import_mol_text(&model, large_smiles);
+    BOOST_TEST(has_deferred_CIP_labels(*model.getMol()));
+    BOOST_TEST(!model.getMol()->getAtomWithIdx(1)->hasProp(
+        RDKit::common_properties::_CIPCode));
+    auto exported_mol = model.getMolForExport();
+    BOOST_TEST(exported_mol->getAtomWithIdx(1)->hasProp(
+        RDKit::common_properties::_CIPCode));
+    BOOST_TEST(!has_deferred_CIP_labels(*exported_mol));
+
+    model_changed_spy.clear();
+    model.assignDeferredCIPLabels();
+    BOOST_TEST(model_changed_spy.count() == 1);
+    BOOST_TEST(!has_deferred_CIP_labels(*model.getMol()));
+    BOOST_TEST(model.getMol()->getAtomWithIdx(1)->hasProp(
+        RDKit::common_properties::_CIPCode));
+
+    // nothing to do once the labels are assigned
+    model.assignDeferredCIPLabels();
+    BOOST_TEST(model_changed_spy.count() == 1);
+
+    // later snapshots keep the labels, but restoring a snapshot from before
+    // they were assigned defers them again
+    model.addAtom(Element::C, RDGeom::Point3D(100, 100, 0));
+    undo_stack.undo();
+    BOOST_TEST(!has_deferred_CIP_labels(*model.getMol()));
+    undo_stack.undo();
+    undo_stack.redo();
+    BOOST_TEST(has_deferred_CIP_labels(*model.getMol()));
+}
+
+/**
+ * Make sure that edits only recalculate CIP labels in the connected components
+ * that they change
+ */
+BOOST_AUTO_TEST_CASE(test_edits_only_relabel_changed_components)
+{
+    QUndoStack undo_stack;
+    TestMolModel model(&undo_stack);
+    import_mol_text(&model, "C[C@H](N)O.C[C@@H](N)O");
+    const auto* mol = model.getMol();
+    auto get_label = [mol](unsigned int atom_idx) {
+        std::string label;
+        mol->getAtomWithIdx(atom_idx)->getPropIfPresent(
+            RDKit::common_properties::_CIPCode, label);
+        return label;
+    };
+    auto set_label = [mol](unsigned int atom_idx) {
+        const_cast<RDKit::Atom*>(mol->getAtomWithIdx(atom_idx))
+            ->setProp(RDKit::common_properties::_CIPCode, std::string("X"));
+    };
+    BOOST_TEST(!get_label(1).empty());
+    BOOST_TEST(!get_label(5).empty());
+    set_label(1);
+    set_label(5);
+
+    // mutate the oxygen of the second component
+    model.mutateAtoms({mol->getAtomWithIdx(7)}, Element::S);
+    BOOST_TEST(get_label(1) == "X");
+    BOOST_TEST(get_label(5) != "X");
+    BOOST_TEST(!get_label(5).empty());
+
+    // bonding the components together relabels both of them
+    model.addBond(mol->getAtomWithIdx(0), mol->getAtomWithIdx(4),
+                  RDKit::Bond::BondType::SINGLE);
+    BOOST_TEST(get_label(1) != "X");
+}
+
 /**
  * Make sure that the selection is updated when a molecule is added
  */
@@ -1453,61 +1696,109 @@ BOOST_AUTO_TEST_CASE(test_selection)
 
     // toggle the selection
     model.select({atom1}, {}, {}, {}, {arrow}, SelectMode::TOGGLE);
-    // toggle emits the signal twice
-    test_selection_changed_emitted(true, 2); // 20
+    // toggle is a single undo macro, so the signal is only emitted once
+    test_selection_changed_emitted(true); // 19
     BOOST_TEST(model.getSelectedAtoms().empty());
     BOOST_TEST(model.getSelectedBonds() == bond_set({bond1}));
     BOOST_TEST(model.getSelectedNonMolecularObjects() ==
                nmo_set({arrow, plus}));
     model.select({atom1}, {}, {}, {}, {arrow}, SelectMode::TOGGLE);
-    test_selection_changed_emitted(true, 2); // 22
+    test_selection_changed_emitted(true); // 20
     BOOST_TEST(model.getSelectedAtoms() == atom_set({atom1}));
     BOOST_TEST(model.getSelectedBonds() == bond_set({bond1}));
     BOOST_TEST(model.getSelectedNonMolecularObjects() == nmo_set({plus}));
     undo_stack.undo();
-    test_selection_changed_emitted(true, 2); // 24
+    test_selection_changed_emitted(true); // 21
     BOOST_TEST(model.getSelectedAtoms().empty());
     BOOST_TEST(model.getSelectedBonds() == bond_set({bond1}));
     BOOST_TEST(model.getSelectedNonMolecularObjects() ==
                nmo_set({arrow, plus}));
     undo_stack.undo();
-    test_selection_changed_emitted(true, 2); // 26
+    test_selection_changed_emitted(true); // 22
     BOOST_TEST(model.getSelectedAtoms() == atom_set({atom1}));
     BOOST_TEST(model.getSelectedBonds() == bond_set({bond1}));
     BOOST_TEST(model.getSelectedNonMolecularObjects() == nmo_set({plus}));
 
     // select-only
     model.select({atom2}, {bond3}, {}, {}, {arrow}, SelectMode::SELECT_ONLY);
-    // select_only emits the signal twice
-    test_selection_changed_emitted(true, 2); // 28
+    // select_only is a single undo macro, so the signal is only emitted once
+    test_selection_changed_emitted(true); // 23
     BOOST_TEST(model.getSelectedAtoms() == atom_set({atom2}));
     BOOST_TEST(model.getSelectedBonds() == bond_set({bond3}));
     BOOST_TEST(model.getSelectedNonMolecularObjects() == nmo_set({arrow}));
     undo_stack.undo();
-    test_selection_changed_emitted(true, 2); // 30
+    test_selection_changed_emitted(true); // 24
     BOOST_TEST(model.getSelectedAtoms() == atom_set({atom1}));
     BOOST_TEST(model.getSelectedBonds() == bond_set({bond1}));
     BOOST_TEST(model.getSelectedNonMolecularObjects() == nmo_set({plus}));
     undo_stack.redo();
-    test_selection_changed_emitted(true, 2); // 32
+    test_selection_changed_emitted(true); // 25
     BOOST_TEST(model.getSelectedAtoms() == atom_set({atom2}));
     BOOST_TEST(model.getSelectedBonds() == bond_set({bond3}));
     BOOST_TEST(model.getSelectedNonMolecularObjects() == nmo_set({arrow}));
 
     // select-only with no atoms or bonds specified should clear the selection
     model.select({}, {}, {}, {}, {}, SelectMode::SELECT_ONLY);
-    // in this case only one signal is emitted
-    test_selection_changed_emitted(true); // 33
+    test_selection_changed_emitted(true); // 26
     BOOST_TEST(model.getSelectedAtoms().empty());
     BOOST_TEST(model.getSelectedBonds().empty());
     BOOST_TEST(model.getSelectedNonMolecularObjects().empty());
     undo_stack.undo();
-    test_selection_changed_emitted(true); // 34
+    test_selection_changed_emitted(true); // 27
     BOOST_TEST(model.getSelectedAtoms() == atom_set({atom2}));
     BOOST_TEST(model.getSelectedBonds() == bond_set({bond3}));
     BOOST_TEST(model.getSelectedNonMolecularObjects() == nmo_set({arrow}));
 }
 
+/**
+ * Make sure that the signals emitted by the commands in an undo macro, or
+ * while a SignalCoalescer exists, are merged and emitted once
+ */
+BOOST_AUTO_TEST_CASE(test_signals_coalesced)
+{
+    QUndoStack undo_stack;
+    TestMolModel model(&undo_stack);
+    QSignalSpy model_changed_spy(&model, &MolModel::modelChanged);
+    QSignalSpy selection_changed_spy(&model, &MolModel::selectionChanged);
+    auto check_emitted_once = [&model_changed_spy, &selection_changed_spy]() {
+        BOOST_TEST(model_changed_spy.count() == 1);
+        BOOST_TEST(selection_changed_spy.count() == 1);
+        model_changed_spy.clear();
+        selection_changed_spy.clear();
+    };
+
+    {
+        auto undo_macro_raii = model.createUndoMacro("Add atoms");
+        model.addAtom(Element::C, RDGeom::Point3D(1.0, 2.0, 0.0));
+        model.addAtom(Element::N, RDGeom::Point3D(3.0, 4.0, 0.0));
+        model.selectAll();
+        BOOST_TEST(model_changed_spy.count() == 0);
+        BOOST_TEST(selection_changed_spy.count() == 0);
+    }
+    BOOST_TEST(model.getMol()->getNumAtoms() == 2);
+    check_emitted_once();
+
+    // undoing and redoing the macro is coalesced as well
+    undo_stack.undo();
+    BOOST_TEST(model.getMol()->getNumAtoms() == 0);
+    check_emitted_once();
+    undo_stack.redo();
+    BOOST_TEST(model.getMol()->getNumAtoms() == 2);
+    check_emitted_once();
+
+    // commands that aren't part of a macro can be coalesced using a
+    // SignalCoalescer
+    {
+        MolModel::SignalCoalescer signal_coalescer(&model);
+        model.addAtom(Element::O, RDGeom::Point3D(5.0, 6.0, 0.0));
+        model.clearSelection();
+        BOOST_TEST(model_changed_spy.count() == 0);
+        BOOST_TEST(selection_changed_spy.count() == 0);
+    }
+    BOOST_TEST(undo_stack.count() == 3);
+    check_emitted_once();
+}
+
 BOOST_AUTO_TEST_CASE(test_select_all_and_invert)
 {
     QUndoStack undo_stack;
@@ -2930,6 +3221,60 @@ BOOST_AUTO_TEST_CASE(test_translateByVector)
     check_coords(plus->getCoords(), plus_position.x, plus_position.y);
 }
 
+/**
+ * Ensure that a transient transform moves the atoms without pushing an undo
+ * command for every move, and commits a single command once it's finished
+ */
+BOOST_AUTO_TEST_CASE(test_transientTransform)
+{
+    QUndoStack undo_stack;
+    TestMolModel model(&undo_stack);
+    const RDKit::ROMol* mol = model.getMol();
+    import_mol_text(&model, "CC");
+    auto start_position = mol->getConformer().getAtomPos(0);
+    auto other_start_position = mol->getConformer().getAtomPos(1);
+    auto num_commands = undo_stack.count();
+    QSignalSpy transient_spy(&model, &MolModel::transientCoordinatesChanged);
+    QSignalSpy coords_spy(&model, &MolModel::coordinatesChanged);
+
+    model.beginTransientTransform();
+    BOOST_TEST(model.isInTransientTransform());
+    auto atom = mol->getAtomWithIdx(0);
+    const RDGeom::Point3D translation_vector(1.0, 2.0, 0.0);
+    for (int i = 0; i < 3; ++i) {
+        model.translateByVector(translation_vector, {atom});
+    }
+    check_coords(mol->getConformer().getAtomPos(0),
+                 start_position.x + 3 * translation_vector.x,
+                 start_position.y + 3 * translation_vector.y);
+    check_coords(mol->getConformer().getAtomPos(1), other_start_position.x,
+                 other_start_position.y);
+    BOOST_TEST(undo_stack.count() == num_commands);
+    BOOST_TEST(transient_spy.count() == 3);
+    BOOST_TEST(coords_spy.count() == 0);
+
+    model.finishTransientTransform();
+    BOOST_TEST(!model.isInTransientTransform());
+    BOOST_TEST(undo_stack.count() == num_commands + 1);
+    BOOST_TEST(coords_spy.count() == 1);
+    check_coords(mol->getConformer().getAtomPos(0),
+                 start_position.x + 3 * translation_vector.x,
+                 start_position.y + 3 * translation_vector.y);
+
+    undo_stack.undo();
+    check_coords(mol->getConformer().getAtomPos(0), start_position.x,
+                 start_position.y);
+    undo_stack.redo();
+    check_coords(mol->getConformer().getAtomPos(0),
+                 start_position.x + 3 * translation_vector.x,
+                 start_position.y + 3 * translation_vector.y);
+
+    // finishing a transform that didn't move anything doesn't add a command
+    model.beginTransientTransform();
+    model.finishTransientTransform();
+    BOOST_TEST(undo_stack.count() == num_commands + 1);
+}
+
 /**
  * Given a mol, confirm that all atoms have the given chirality labels, and all
  * bonds have the given type and direction
@@ -222,6 +222,40 @@ BOOST_AUTO_TEST_CASE(test_updateCachedData_atomLabel)
     }
 }
 
+/**
+ * Make sure that atoms with identical labels share a cached label layout, and
+ * that the cache is discarded when the font size changes
+ */
+BOOST_AUTO_TEST_CASE(test_updateCachedData_cachedLayout)
+{
+    auto [atom_items, test_scene] = createAtomItems("[NH4+].[NH4+]");
+    auto& fonts = test_scene->m_fonts;
+    auto first = atom_items[0];
+    auto second = atom_items[1];
+    BOOST_TEST(first->m_charge_and_radical_label_text == "+");
+    BOOST_TEST(first->m_H_count_label_text == "4");
+    AtomLabelLayoutKey key{"N", "", "+", "", "4", true, HsDirection::RIGHT};
+    auto layout = fonts.getCachedAtomLabelLayout(key);
+    BOOST_TEST_REQUIRE(layout.has_value());
+    for (auto item : {first, second}) {
+        BOOST_TEST(item->m_main_label_rect == layout->main_label_rect);
+        BOOST_TEST(item->m_H_label_rect == layout->H_label_rect);
+        BOOST_TEST(item->m_H_count_label_rect == layout->H_count_label_rect);
+        BOOST_TEST(item->m_charge_and_radical_label_rect ==
+                   layout->charge_and_radical_label_rect);
+    }
+    BOOST_TEST(
+        fonts.getTightBoundingRect(fonts.m_main_label_font, "N") ==
+        QFontMetricsF(fonts.m_main_label_font).tightBoundingRect("N"));
+
+    auto old_main_label_rect = first->m_main_label_rect;
+    fonts.setSize(fonts.size() * 2);
+    BOOST_TEST(!fonts.getCachedAtomLabelLayout(key).has_value());
+    first->updateCachedData();
+    BOOST_TEST(first->m_main_label_rect.width() > old_main_label_rect.width());
+    BOOST_TEST(fonts.getCachedAtomLabelLayout(key).has_value());
+}
+
 BOOST_AUTO_TEST_CASE(test_deuterium_and_tritium_display)
 {
 
@@ -0,0 +1,82 @@
+#define BOOST_TEST_MODULE Test_Sketcher
+
+#include <QImage>
+#include <QPainter>
+#include <QSignalSpy>
+
+#include "../test_common.h"
+#include "schrodinger/sketcher/molviewer/molecule_tile_cache.h"
+
+BOOST_GLOBAL_FIXTURE(QApplicationRequiredFixture);
+
+namespace schrodinger
+{
+namespace sketcher
+{
+
+static const QRectF LAYER_RECT(-40, -30, 100, 50);
+
+static void paint_layer(QPainter* painter)
+{
+    painter->fillRect(LAYER_RECT, Qt::red);
+}
+
+/**
+ * Paint the given scene rect using the cache, and paint whatever isn't cached
+ * directly
+ *
+ * @return the resulting image and the number of uncached rects
+ */
+static std::pair<QImage, int> paint_using_cache(MoleculeTileCache& cache,
+                                                const QRectF& scene_rect)
+{
+    QImage image(200, 100, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+    QPainter painter(&image);
+    painter.translate(100, 50);
+    painter.scale(0.5, 0.5);
+    auto uncached_rects = cache.paint(&painter, scene_rect);
+    for (const auto& rect : uncached_rects) {
+        painter.save();
+        painter.setClipRect(rect);
+        paint_layer(&painter);
+        painter.restore();
+    }
+    painter.end();
+    return {image, static_cast<int>(uncached_rects.size())};
+}
+
+/**
+ * Make sure that tiles are rasterized in the background once requested, and
+ * that they're discarded when invalidated
+ */
+BOOST_AUTO_TEST_CASE(test_tiles_rasterized_and_invalidated)
+{
+    MoleculeTileCache cache(paint_layer);
+    QSignalSpy tiles_ready_spy(&cache, &MoleculeTileCache::tilesReady);
+    QRectF scene_rect(-200, -100, 400, 200);
+
+    auto [uncached_image, num_uncached] = paint_using_cache(cache, scene_rect);
+    BOOST_TEST(num_uncached > 0);
+    BOOST_TEST(cache.getNumCachedTiles() == 0);
+    BOOST_REQUIRE(tiles_ready_spy.wait(5000));
+    BOOST_TEST(cache.getNumCachedTiles() == static_cast<size_t>(num_uncached));
+
+    // painting from the tiles gives the same result as painting directly
+    auto [cached_image, num_uncached_after] =
+        paint_using_cache(cache, scene_rect);
+    BOOST_TEST(num_uncached_after == 0);
+    BOOST_TEST(cached_image == uncached_image);
+
+    // only the tiles that overlap the invalidated rect are discarded
+    auto num_tiles = cache.getNumCachedTiles();
+    cache.invalidate(QRectF(1, 1, 1, 1));
+    BOOST_TEST(cache.getNumCachedTiles() == num_tiles - 1);
+    BOOST_TEST(paint_using_cache(cache, scene_rect).second == 1);
+
+    cache.invalidateAll();
+    BOOST_TEST(cache.getNumCachedTiles() == 0);
+}
+
+} // namespace sketcher
+} // namespace schrodinger
@@ -3,13 +3,21 @@
 #include <rdkit/GraphMol/Depictor/RDDepictor.h>
 #include <rdkit/GraphMol/ROMol.h>
 #include <rdkit/GraphMol/SmilesParse/SmilesParse.h>
+#include <QImage>
+#include <QPainter>
+#include <QPolygonF>
 #include <QRectF>
+#include <QStyleOptionGraphicsItem>
+#include <QUndoStack>
 
 #include "../test_common.h"
 #include "schrodinger/rdkit_extensions/convert.h"
+#include "schrodinger/sketcher/molviewer/atom_display_settings.h"
 #include "schrodinger/sketcher/molviewer/atom_item.h"
+#include "schrodinger/sketcher/molviewer/bond_display_settings.h"
 #include "schrodinger/sketcher/molviewer/bond_item.h"
 #include "schrodinger/sketcher/molviewer/constants.h"
+#include "schrodinger/sketcher/molviewer/coord_utils.h"
 #include "schrodinger/sketcher/molviewer/scene.h"
 
 BOOST_GLOBAL_FIXTURE(QApplicationRequiredFixture);
@@ -84,6 +92,314 @@ BOOST_AUTO_TEST_CASE(test_getInteractiveItems)
     BOOST_TEST(scene->items().size() == 8);
 }
 
+/**
+ * Make sure that changes to the molecule reuse the existing graphics items, and
+ * that the reused items refer to the current RDKit atoms
+ */
+BOOST_AUTO_TEST_CASE(test_items_reused_on_update)
+{
+    auto scene = TestScene::getScene();
+    import_mol_text(scene->m_mol_model, "CCCCO", Format::SMILES);
+    const auto* mol = scene->m_mol_model->getMol();
+    std::vector<const QGraphicsItem*> orig_items;
+    for (const auto* atom : mol->atoms()) {
+        orig_items.push_back(scene->getGraphicsItemForAtom(atom));
+    }
+    auto check_items_reused = [&]() {
+        BOOST_TEST(scene->getInteractiveItems().size() == 9);
+        for (const auto* atom : mol->atoms()) {
+            const auto* item = scene->getGraphicsItemForAtom(atom);
+            BOOST_TEST(item == orig_items[atom->getIdx()]);
+            BOOST_TEST(qgraphicsitem_cast<const AtomItem*>(item)->getAtom() ==
+                       atom);
+        }
+    };
+
+    scene->m_mol_model->setAtomCharge(mol->getAtomWithIdx(4), -1);
+    check_items_reused();
+
+    // mutating an atom replaces the RDKit atom
+    scene->m_mol_model->mutateAtoms({mol->getAtomWithIdx(4)}, Element::N);
+    check_items_reused();
+    BOOST_TEST(mol->getAtomWithIdx(4)->getSymbol() == "N");
+
+    // undo replaces every RDKit atom
+    auto* undo_stack = scene->m_mol_model->findChild<QUndoStack*>();
+    undo_stack->undo();
+    check_items_reused();
+    BOOST_TEST(mol->getAtomWithIdx(4)->getSymbol() == "O");
+
+    // removing an atom only removes its own items
+    scene->m_mol_model->remove({mol->getAtomWithIdx(4)}, {}, {}, {}, {});
+    BOOST_TEST(scene->getInteractiveItems().size() == 7);
+    for (const auto* atom : mol->atoms()) {
+        BOOST_TEST(scene->getGraphicsItemForAtom(atom) ==
+                   orig_items[atom->getIdx()]);
+    }
+}
+
+/**
+ * Make sure that large molecules are displayed in large-molecule mode, and that
+ * the scene draws them in place of their atom and bond items when zoomed out
+ */
+BOOST_AUTO_TEST_CASE(test_large_molecule_mode)
+{
+    auto scene = TestScene::getScene();
+    import_mol_text(scene->m_mol_model, "CCCC", Format::SMILES);
+    BOOST_TEST(!scene->isLargeMoleculeMode());
+
+    scene->m_mol_model->clear();
+    import_mol_text(scene->m_mol_model,
+                    std::string(LARGE_MOLECULE_ATOM_THRESHOLD + 1, 'C'),
+                    Format::SMILES);
+    BOOST_TEST(scene->isLargeMoleculeMode());
+
+    QImage blank_image(200, 200, QImage::Format_ARGB32);
+    blank_image.fill(Qt::white);
+    BondItem* bond_item = nullptr;
+    for (auto* item : scene->getInteractiveItems()) {
+        bond_item = qgraphicsitem_cast<BondItem*>(item);
+        if (bond_item != nullptr) {
+            break;
+        }
+    }
+    BOOST_REQUIRE(bond_item != nullptr);
+    auto paint_bond_item = [bond_item, &blank_image](qreal scale) {
+        auto image = blank_image.copy();
+        QPainter painter(&image);
+        painter.translate(100, 100);
+        painter.scale(scale, scale);
+        QStyleOptionGraphicsItem option;
+        option.exposedRect = bond_item->boundingRect();
+        bond_item->paint(&painter, &option, nullptr);
+        painter.end();
+        return image;
+    };
+    // bond items paint a plain line below the simplified level of detail...
+    BOOST_TEST(paint_bond_item(LARGE_MOLECULE_SIMPLIFIED_LEVEL_OF_DETAIL / 2) !=
+               blank_image);
+    BOOST_TEST(paint_bond_item(1.0) != blank_image);
+
+    // ...so rendering the whole molecule into a small image, which is well
+    // below that level of detail, still shows the bonds
+    auto image = blank_image.copy();
+    QPainter painter(&image);
+    scene->render(&painter);
+    painter.end();
+    BOOST_TEST(image != blank_image);
+
+    scene->m_mol_model->clear();
+    BOOST_TEST(!scene->isLargeMoleculeMode());
+}
+
+/**
+ * Make sure that atoms and bonds are painted in simplified form when they would
+ * be painted below the level of detail thresholds
+ */
+BOOST_AUTO_TEST_CASE(test_level_of_detail_thresholds)
+{
+    auto scene = TestScene::getScene();
+    import_mol_text(scene->m_mol_model, "O=C=O", Format::SMILES);
+    auto render = [&scene]() {
+        QImage image(200, 200, QImage::Format_ARGB32);
+        image.fill(Qt::white);
+        QPainter painter(&image);
+        scene->render(&painter);
+        painter.end();
+        return image;
+    };
+    auto full_image = render();
+
+    // raise the thresholds so that the labels and bonds are simplified even
+    // at this scale
+    auto* sketcher_model = scene->m_sketcher_model;
+    AtomDisplaySettings atom_settings(
+        *sketcher_model->getAtomDisplaySettingsPtr());
+    atom_settings.m_min_label_pixel_size = 1000;
+    sketcher_model->setAtomDisplaySettings(atom_settings);
+    auto simplified_labels_image = render();
+    BOOST_TEST(simplified_labels_image != full_image);
+
+    BondDisplaySettings bond_settings(
+        *sketcher_model->getBondDisplaySettingsPtr());
+    bond_settings.m_min_bond_line_pixel_spacing = 1000;
+    sketcher_model->setBondDisplaySettings(bond_settings);
+    BOOST_TEST(render() != simplified_labels_image);
+
+    // thresholds of zero always paint everything in full
+    atom_settings.m_min_label_pixel_size = 0;
+    sketcher_model->setAtomDisplaySettings(atom_settings);
+    bond_settings.m_min_bond_line_pixel_spacing = 0;
+    sketcher_model->setBondDisplaySettings(bond_settings);
+    BOOST_TEST(render() == full_image);
+}
+
+BOOST_AUTO_TEST_CASE(test_batched_painting)
+{
+    auto scene = TestScene::getScene();
+    import_mol_text(scene->m_mol_model, "O=C=O", Format::SMILES);
+    auto render = [&scene]() {
+        QImage image(200, 200, QImage::Format_ARGB32);
+        image.fill(Qt::white);
+        QPainter painter(&image);
+        scene->render(&painter);
+        painter.end();
+        return image;
+    };
+    auto test_items_have_contents = [&scene](bool expected) {
+        for (auto* item : scene->getInteractiveItems()) {
+            BOOST_TEST(!(item->flags() & QGraphicsItem::ItemHasNoContents) ==
+                       expected);
+        }
+    };
+    QImage blank_image(200, 200, QImage::Format_ARGB32);
+    blank_image.fill(Qt::white);
+    BOOST_TEST(!scene->isBatchedPainting());
+    test_items_have_contents(true);
+
+    // the atom and bond items are still in the scene for hit-testing, but the
+    // molecule is painted by a single item
+    scene->setBatchedPaintingEnabled(true);
+    BOOST_TEST(scene->isBatchedPainting());
+    test_items_have_contents(false);
+    BOOST_TEST(scene->getInteractiveItems().size() == 5);
+    BOOST_TEST(render() != blank_image);
+
+    scene->setBatchedPaintingEnabled(false);
+    BOOST_TEST(!scene->isBatchedPainting());
+    test_items_have_contents(true);
+}
+
+BOOST_AUTO_TEST_CASE(test_spatial_index)
+{
+    auto scene = TestScene::getScene();
+    import_mol_text(scene->m_mol_model, "CCO", Format::SMILES);
+    const auto* mol = scene->m_mol_model->getMol();
+    const auto& index = scene->getSpatialIndex();
+    auto get_pos = [mol](unsigned int atom_idx) {
+        return to_scene_xy(mol->getConformer().getAtomPos(atom_idx));
+    };
+    const auto* atom = mol->getAtomWithIdx(1);
+    const auto* bond = mol->getBondWithIdx(0);
+    auto atom_pos = get_pos(1);
+    auto bond_midpoint = (get_pos(0) + get_pos(1)) / 2;
+
+    // hit-testing uses the shapes of the graphics items
+    auto* top_atom_item =
+        scene->getTopInteractiveItemAt(atom_pos, InteractiveItemFlag::ALL);
+    BOOST_TEST(top_atom_item == scene->getGraphicsItemForAtom(atom));
+    auto* top_bond_item = scene->getTopInteractiveItemAt(
+        bond_midpoint, InteractiveItemFlag::ALL);
+    BOOST_REQUIRE(qgraphicsitem_cast<BondItem*>(top_bond_item) != nullptr);
+    BOOST_TEST(qgraphicsitem_cast<BondItem*>(top_bond_item)->getBond() ==
+               bond);
+    BOOST_TEST(scene->getTopInteractiveItemAt(
+                   bond_midpoint, InteractiveItemFlag::ATOM) == nullptr);
+    BOOST_TEST(scene->getTopInteractiveItemAt(atom_pos + QPointF(1000, 1000),
+                                              InteractiveItemFlag::ALL) ==
+               nullptr);
+
+    // proximity queries use the model geometry
+    BOOST_TEST(index.getNearestAtom(atom_pos + QPointF(1, 1), 5) == atom);
+    BOOST_TEST(index.getNearestAtom(bond_midpoint, 1) == nullptr);
+    BOOST_TEST(index.getNearestBond(bond_midpoint + QPointF(0, 1), 5) == bond);
+
+    // only bonds whose midpoint is inside the polygon are included
+    QPolygonF polygon(QRectF(atom_pos - QPointF(1, 1), QSizeF(2, 2)));
+    BOOST_TEST(index.getAtomsInPolygon(polygon) ==
+               std::vector<const RDKit::Atom*>{atom});
+    BOOST_TEST(index.getBondsInPolygon(polygon).empty());
+    polygon = QPolygonF(QRectF(-1000, -1000, 2000, 2000));
+    BOOST_TEST(index.getAtomsInPolygon(polygon).size() == 3);
+    BOOST_TEST(index.getBondsInPolygon(polygon).size() == 2);
+
+    // the index follows coordinate changes
+    scene->m_mol_model->translateByVector(RDGeom::Point3D(100, 0, 0));
+    BOOST_TEST(index.getNearestAtom(atom_pos, 5) == nullptr);
+    BOOST_TEST(index.getNearestAtom(get_pos(1), 5) == atom);
+}
+
+/**
+ * Make sure that the spatial index follows atoms that are dragged without
+ * rebuilding it
+ */
+BOOST_AUTO_TEST_CASE(test_spatial_index_transient_move)
+{
+    auto scene = TestScene::getScene();
+    import_mol_text(scene->m_mol_model, "CCO.N", Format::SMILES);
+    const auto* mol = scene->m_mol_model->getMol();
+    const auto& index = scene->getSpatialIndex();
+    auto get_pos = [mol](unsigned int atom_idx) {
+        return to_scene_xy(mol->getConformer().getAtomPos(atom_idx));
+    };
+    const auto* oxygen = mol->getAtomWithIdx(2);
+    const auto* nitrogen = mol->getAtomWithIdx(3);
+    const auto* co_bond = mol->getBondWithIdx(1);
+    auto initial_oxygen_pos = get_pos(2);
+    auto nitrogen_pos = get_pos(3);
+
+    scene->m_mol_model->beginTransientTransform();
+    auto previous_oxygen_pos = initial_oxygen_pos;
+    for (int i = 0; i < 3; ++i) {
+        BOOST_TEST(index.getNearestAtom(previous_oxygen_pos, 5) == oxygen);
+        scene->m_mol_model->translateByVector(RDGeom::Point3D(10, 0, 0),
+                                              {oxygen});
+        BOOST_TEST(scene->m_mol_model->isInTransientTransform());
+        auto oxygen_pos = get_pos(2);
+        auto co_midpoint = (get_pos(1) + oxygen_pos) / 2;
+        // the index is updated in the middle of the drag
+        BOOST_TEST(index.getNearestAtom(previous_oxygen_pos, 5) == nullptr);
+        BOOST_TEST(index.getNearestAtom(oxygen_pos, 5) == oxygen);
+        BOOST_TEST(index.getNearestBond(co_midpoint, 5) == co_bond);
+        BOOST_TEST(scene->getTopInteractiveItemAt(oxygen_pos,
+                                                  InteractiveItemFlag::ALL) ==
+                   scene->getGraphicsItemForAtom(oxygen));
+        // atoms that weren't moved are still found
+        BOOST_TEST(index.getNearestAtom(nitrogen_pos, 5) == nitrogen);
+        previous_oxygen_pos = oxygen_pos;
+    }
+    scene->m_mol_model->finishTransientTransform();
+    BOOST_TEST(index.getNearestAtom(get_pos(2), 5) == mol->getAtomWithIdx(2));
+    BOOST_TEST(index.getNearestAtom(initial_oxygen_pos, 5) == nullptr);
+}
+
+/**
+ * Make sure that lasso and marquee selection use atom positions and bond
+ * midpoints
+ */
+BOOST_AUTO_TEST_CASE(test_getInteractiveItemsInPolygon)
+{
+    auto scene = TestScene::getScene();
+    import_mol_text(scene->m_mol_model, "CCO", Format::SMILES);
+    const auto* mol = scene->m_mol_model->getMol();
+    auto get_pos = [mol](unsigned int atom_idx) {
+        return to_scene_xy(mol->getConformer().getAtomPos(atom_idx));
+    };
+    auto* atom_item = scene->m_atom_to_atom_item.at(mol->getAtomWithIdx(0));
+
+    // a polygon around a single atom doesn't contain any bond midpoints
+    auto atom_pos = get_pos(0);
+    QPolygonF polygon(QRectF(atom_pos - QPointF(2, 2), QSizeF(4, 4)));
+    BOOST_TEST((scene->getInteractiveItemsInPolygon(polygon) ==
+                QList<QGraphicsItem*>{atom_item}));
+
+    // a triangle around the first bond's midpoint only selects that bond
+    auto bond_midpoint = (get_pos(0) + get_pos(1)) / 2;
+    polygon = QPolygonF({bond_midpoint + QPointF(-3, -3),
+                         bond_midpoint + QPointF(3, -3),
+                         bond_midpoint + QPointF(0, 3)});
+    auto items = scene->getInteractiveItemsInPolygon(polygon);
+    BOOST_REQUIRE(items.size() == 1);
+    BOOST_REQUIRE(qgraphicsitem_cast<BondItem*>(items[0]) != nullptr);
+    BOOST_TEST(qgraphicsitem_cast<BondItem*>(items[0])->getBond() ==
+               mol->getBondWithIdx(0));
+
+    polygon = QPolygonF(QRectF(-1000, -1000, 2000, 2000));
+    BOOST_TEST(scene->getInteractiveItemsInPolygon(polygon).size() == 5);
+    polygon.translate(5000, 0);
+    BOOST_TEST(scene->getInteractiveItemsInPolygon(polygon).empty());
+}
+
 BOOST_AUTO_TEST_CASE(test_item_selection)
 {
     auto scene = TestScene::getScene();
@@ -116,6 +432,39 @@ BOOST_AUTO_TEST_CASE(test_item_selection)
     test_selected_items(scene, false);
 }
 
+/**
+ * Make sure that the selection highlighting follows changes to the selection
+ * and to the coordinates of the selected items, since each item's highlighting
+ * path is cached
+ */
+BOOST_AUTO_TEST_CASE(test_selection_highlighting_updates)
+{
+    auto scene = TestScene::getScene();
+    import_mol_text(scene->m_mol_model, "CCO", Format::SMILES);
+    auto mol = scene->m_mol_model->getMol();
+    auto* atom = mol->getAtomWithIdx(2);
+
+    scene->m_mol_model->selectAll();
+    auto selection_rect = scene->getSelectionRect();
+    auto atom_pos = scene->m_atom_to_atom_item.at(atom)->pos();
+    BOOST_TEST(selection_rect.contains(atom_pos));
+
+    // the highlighting moves along with the molecule
+    scene->m_mol_model->translateByVector(RDGeom::Point3D(5, 0, 0));
+    auto offset = scene->m_atom_to_atom_item.at(atom)->pos() - atom_pos;
+    selection_rect.translate(offset);
+    BOOST_TEST((scene->getSelectionRect() == selection_rect));
+
+    // deselecting a single atom leaves the rest highlighted
+    scene->m_mol_model->select({atom}, {}, {}, {}, {}, SelectMode::DESELECT);
+    BOOST_TEST(scene->m_selection_highlighting_item->isVisible());
+    BOOST_TEST(scene->getSelectionRect().isValid());
+
+    scene->m_mol_model->clearSelection();
+    BOOST_TEST(!scene->m_selection_highlighting_item->isVisible());
+    BOOST_TEST(scene->getSelectionRect().isNull());
+}
+
 BOOST_AUTO_TEST_CASE(test_ensureCompleteAttachmentPoints)
 {
     auto scene = TestScene::getScene();
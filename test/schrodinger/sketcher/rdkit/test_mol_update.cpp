@@ -6,6 +6,7 @@
 #include "schrodinger/sketcher/rdkit/mol_update.h"
 #include "schrodinger/rdkit_extensions/convert.h"
 #include "schrodinger/rdkit_extensions/constants.h"
+#include "schrodinger/sketcher/molviewer/constants.h"
 #include <rdkit/GraphMol/RWMol.h>
 
 namespace schrodinger
@@ -104,5 +105,75 @@ BOOST_AUTO_TEST_CASE(test_prepare_mol_list_query)
                rdkit_extensions::DUMMY_ATOMIC_NUMBER);
 }
 
+/**
+ * Make sure that updating the molecule after a local change keeps the CIP
+ * labels of the unchanged components and relabels the changed ones
+ */
+BOOST_AUTO_TEST_CASE(test_update_molecule_on_change_incremental)
+{
+    auto mol = rdkit_extensions::to_rdkit("C[C@H](N)O.C[C@@H](N)O",
+                                          rdkit_extensions::Format::SMILES);
+    prepare_mol(*mol);
+    update_molecule_on_change(*mol);
+    auto* first_center = mol->getAtomWithIdx(1);
+    auto* second_center = mol->getAtomWithIdx(5);
+    auto get_label = [](const RDKit::Atom* atom) {
+        std::string label;
+        atom->getPropIfPresent(RDKit::common_properties::_CIPCode, label);
+        return label;
+    };
+    auto first_label = get_label(first_center);
+    auto second_label = get_label(second_center);
+    BOOST_TEST(!first_label.empty());
+    BOOST_TEST(!second_label.empty());
+
+    update_molecule_on_change(*mol, {first_center}, {});
+    BOOST_TEST(get_label(first_center) == first_label);
+    BOOST_TEST(get_label(second_center) == second_label);
+
+    // changed bonds also get their component relabeled
+    second_center->clearProp(RDKit::common_properties::_CIPCode);
+    update_molecule_on_change(*mol, {}, {mol->getBondWithIdx(4)});
+    BOOST_TEST(get_label(second_center) == second_label);
+}
+
+/**
+ * Make sure that CIP labels are deferred for large components, and that
+ * assign_deferred_CIP_labels assigns them along with their annotations
+ */
+BOOST_AUTO_TEST_CASE(test_deferred_CIP_labels)
+{
+    auto large_smiles =
+        "C[C@H](N)" + std::string(LARGE_MOLECULE_ATOM_THRESHOLD, 'C');
+    auto mol = rdkit_extensions::to_rdkit(large_smiles + ".C[C@@H](N)O",
+                                          rdkit_extensions::Format::SMILES);
+    prepare_mol(*mol);
+    update_molecule_on_change(*mol);
+    auto* large_center = mol->getAtomWithIdx(1);
+    auto* small_center =
+        mol->getAtomWithIdx(LARGE_MOLECULE_ATOM_THRESHOLD + 4);
+    BOOST_TEST(has_deferred_CIP_labels(*mol));
+    BOOST_TEST(!large_center->hasProp(RDKit::common_properties::_CIPCode));
+    BOOST_TEST(!large_center->hasProp(RDKit::common_properties::atomNote));
+    BOOST_TEST(small_center->hasProp(RDKit::common_properties::_CIPCode));
+
+    assign_deferred_CIP_labels(*mol);
+    BOOST_TEST(!has_deferred_CIP_labels(*mol));
+    BOOST_TEST(large_center->hasProp(RDKit::common_properties::_CIPCode));
+    BOOST_TEST(large_center->hasProp(RDKit::common_properties::atomNote));
+    BOOST_TEST(small_center->hasProp(RDKit::common_properties::_CIPCode));
+
+    // changing only the small component keeps the large component's labels
+    update_molecule_on_change(*mol, {small_center}, {});
+    BOOST_TEST(!has_deferred_CIP_labels(*mol));
+    BOOST_TEST(large_center->hasProp(RDKit::common_properties::_CIPCode));
+
+    // changing the large component defers its labels again
+    update_molecule_on_change(*mol, {large_center}, {});
+    BOOST_TEST(has_deferred_CIP_labels(*mol));
+    BOOST_TEST(!large_center->hasProp(RDKit::common_properties::_CIPCode));
+    BOOST_TEST(small_center->hasProp(RDKit::common_properties::_CIPCode));
+}
+
 } // namespace sketcher
 } // namespace schrodinger
\ No newline at end of file
@@ -4,7 +4,11 @@
 
 #define BOOST_TEST_MODULE sketcher_image_generation
 
+#include <algorithm>
+#include <cstdlib>
+
 #include <rdkit/GraphMol/GraphMol.h>
+#include <QImage>
 #include <QList>
 #include <boost/filesystem.hpp>
 #include <boost/test/framework.hpp>
@@ -161,6 +165,66 @@ BOOST_AUTO_TEST_CASE(test_image_scaling)
     BOOST_TEST(bytes_with_best_scale != bytes_with_scale_too_small);
 }
 
+BOOST_AUTO_TEST_CASE(test_get_batch_image_bytes)
+{
+    BOOST_TEST(get_batch_image_bytes(QList<RDKit::ROMol*>(), ImageFormat::PNG)
+                   .isEmpty());
+    auto rdmol_small = rdkit_extensions::to_rdkit("c");
+    auto rdmol_med = rdkit_extensions::to_rdkit("c1ccccc1");
+    auto rdmol_large = rdkit_extensions::to_rdkit("c1nccc2n1ccc2");
+    QList<RDKit::ROMol*> rdmols = {rdmol_small.get(), rdmol_med.get(),
+                                   rdmol_large.get()};
+    // each image should match the one rendered on its own, regardless of how
+    // many threads are used
+    for (unsigned int num_threads : {1u, 2u, 8u}) {
+        auto all_bytes = get_batch_image_bytes(
+            rdmols, ImageFormat::PNG, RenderOptions(), false, num_threads);
+        BOOST_TEST(all_bytes.size() == rdmols.size());
+        for (int i = 0; i < rdmols.size(); ++i) {
+            BOOST_TEST(all_bytes[i] ==
+                       get_image_bytes(*rdmols[i], ImageFormat::PNG));
+        }
+    }
+    auto svg_bytes = get_batch_image_bytes(rdmols, ImageFormat::SVG);
+    BOOST_TEST(svg_bytes.size() == rdmols.size());
+    for (const auto& bytes : svg_bytes) {
+        BOOST_TEST(QString::fromUtf8(bytes).contains("svg width=\"400px\""));
+    }
+
+    // reactions are rendered using a Scene
+    std::vector<std::string> texts = {"CCO", "CC(=O)O.OCC>>CC(=O)OCC"};
+    auto text_bytes = get_batch_image_bytes(texts, ImageFormat::PNG);
+    BOOST_TEST(text_bytes.size() == 2);
+    for (int i = 0; i < 2; ++i) {
+        BOOST_TEST(text_bytes[i] ==
+                   get_image_bytes(texts[i], ImageFormat::PNG));
+    }
+    BOOST_CHECK_THROW(
+        get_batch_image_bytes(std::vector<std::string>{"CCO", "garbage"},
+                              ImageFormat::PNG),
+        std::exception);
+    // errors on worker threads are rethrown on this one, including when the
+    // threads wait for each other to find a common scale
+    std::vector<std::string> texts_with_errors = {"CCO", "garbage", "CCC",
+                                                  "garbage"};
+    for (bool use_common_scale : {false, true}) {
+        BOOST_CHECK_THROW(get_batch_image_bytes(texts_with_errors,
+                                                ImageFormat::PNG,
+                                                RenderOptions(),
+                                                use_common_scale, 4),
+                          std::exception);
+    }
+
+    // with a common scale, the largest molecule is scaled as before and the
+    // smaller ones are drawn at the same scale instead of being enlarged
+    auto common_bytes =
+        get_batch_image_bytes(rdmols, ImageFormat::PNG, RenderOptions(), true);
+    BOOST_TEST(common_bytes[2] ==
+               get_image_bytes(*rdmol_large, ImageFormat::PNG));
+    BOOST_TEST(common_bytes[0] !=
+               get_image_bytes(*rdmol_small, ImageFormat::PNG));
+}
+
 BOOST_AUTO_TEST_CASE(test_SVG_size_output)
 {
     // test that the in SVG output width and height are correctly set in px
@@ -229,6 +293,57 @@ BOOST_AUTO_TEST_CASE(test_trim_image)
     BOOST_TEST(image_size.height() == 100);
 }
 
+/**
+ * @return the largest difference between the two images in any color channel
+ * of any pixel
+ * @pre the images are the same size
+ */
+static int get_max_pixel_difference(const QImage& image1, const QImage& image2)
+{
+    auto argb1 = image1.convertToFormat(QImage::Format_ARGB32);
+    auto argb2 = image2.convertToFormat(QImage::Format_ARGB32);
+    int max_difference = 0;
+    for (int y = 0; y < argb1.height(); ++y) {
+        for (int x = 0; x < argb1.width(); ++x) {
+            auto pixel1 = argb1.pixel(x, y);
+            auto pixel2 = argb2.pixel(x, y);
+            for (auto get_channel : {qRed, qGreen, qBlue, qAlpha}) {
+                max_difference =
+                    std::max(max_difference, std::abs(get_channel(pixel1) -
+                                                      get_channel(pixel2)));
+            }
+        }
+    }
+    return max_difference;
+}
+
+/**
+ * Molecules are painted without a Scene, so make sure that they look the same
+ * as the same molecules painted from text, which uses a Scene
+ */
+BOOST_AUTO_TEST_CASE(test_mol_painted_without_scene)
+{
+    RenderOptions opts;
+    opts.width_height = {400, 400};
+    opts.trim_image = true;
+    opts.background_color = Qt::white;
+    for (auto smiles :
+         {"C1=CC=CC=C1", "C[C@H](N)C(=O)O", "CC* |$;;_AP1$|", "[13CH3]CCl"}) {
+        auto mol = rdkit_extensions::to_rdkit(smiles);
+        auto image = get_qimage(*mol, opts);
+        auto image_from_text = get_qimage(std::string(smiles), opts);
+        BOOST_REQUIRE(image.size() == image_from_text.size());
+        // make sure that something was actually painted
+        QImage blank_image(image.size(), image.format());
+        blank_image.fill(Qt::white);
+        BOOST_TEST((image != blank_image));
+        // the molecules may be placed at different coordinates, which can
+        // slightly change the antialiasing, but a missing or misplaced line or
+        // label changes some pixels completely
+        BOOST_TEST(get_max_pixel_difference(image, image_from_text) <= 32);
+    }
+}
+
 /**
  * Verify that Qt's default title and description elements are removed from SVG,
  * and that the font specifications are updated to include fallback fonts
@@ -1,7 +1,10 @@
 #define BOOST_TEST_MODULE Test_Sketcher
 
+#include <QUndoStack>
+
 #include "../test_common.h"
 #include "schrodinger/rdkit_extensions/convert.h"
+#include "schrodinger/sketcher/model/mol_model.h"
 #include "schrodinger/sketcher/rdkit/coord_utils.h"
 #include "schrodinger/sketcher/molviewer/constants.h"
 #include "schrodinger/sketcher/tool/move_rotate_scene_tool.h"
@@ -43,5 +46,57 @@ BOOST_AUTO_TEST_CASE(test_get_overlapping_atom_idxs)
     BOOST_TEST(overlapping == exp_overlapping);
 }
 
+BOOST_AUTO_TEST_CASE(test_DragMergeFinder)
+{
+    // a long chain of stationary atoms, plus one atom that's dragged along it
+    auto mol = rdkit_extensions::to_rdkit("CCCCCCCCCCCCCCCCCCCC.C");
+    sketcher::update_2d_coordinates(*mol);
+    auto& conf = mol->getConformer();
+    for (unsigned int i = 0; i < 20; ++i) {
+        conf.setAtomPos(i, {i * BOND_LENGTH, 0, 0});
+    }
+    std::unordered_set<const RDKit::Atom*> atoms_to_move = {
+        mol->getAtomWithIdx(20)};
+    DragMergeFinder finder(*mol, atoms_to_move);
+
+    // the same finder should be usable as the atom moves
+    using Overlaps = std::vector<std::pair<unsigned int, unsigned int>>;
+    for (unsigned int i = 0; i < 20; ++i) {
+        conf.setAtomPos(20, {i * BOND_LENGTH + MAX_DIST_FOR_DRAG_MERGE / 2,
+                             -MAX_DIST_FOR_DRAG_MERGE / 2, 0});
+        BOOST_TEST(finder.getOverlappingAtomIdxs(*mol) == Overlaps({{20, i}}));
+    }
+    conf.setAtomPos(20, {BOND_LENGTH / 2, 0, 0});
+    BOOST_TEST(finder.getOverlappingAtomIdxs(*mol).empty());
+
+    // atoms from the same fragment are never merged
+    std::unordered_set<const RDKit::Atom*> chain_end = {mol->getAtomWithIdx(0)};
+    conf.setAtomPos(0, conf.getAtomPos(1));
+    BOOST_TEST(DragMergeFinder(*mol, chain_end)
+                   .getOverlappingAtomIdxs(*mol)
+                   .empty());
+
+    // a finder created from a model can only be used until the model's
+    // molecule is edited
+    QUndoStack undo_stack;
+    MolModel mol_model(&undo_stack);
+    import_mol_text(&mol_model, "CC.C");
+    const auto* model_mol = mol_model.getMol();
+    DragMergeFinder model_finder(mol_model, {model_mol->getAtomWithIdx(2)});
+    BOOST_TEST(model_finder.isValidFor(mol_model));
+    BOOST_TEST(!finder.isValidFor(mol_model));
+    mol_model.setAtomCharge(model_mol->getAtomWithIdx(0), 1);
+    BOOST_TEST(!model_finder.isValidFor(mol_model));
+    undo_stack.undo();
+    BOOST_TEST(model_finder.isValidFor(mol_model));
+
+    // importing the same molecule again leaves the undo stack at the same
+    // index, but the moved index now belongs to a different atom
+    undo_stack.undo();
+    import_mol_text(&mol_model, "CC.C");
+    BOOST_TEST(undo_stack.index() == 1);
+    BOOST_TEST(!model_finder.isValidFor(mol_model));
+}
+
 } // namespace sketcher
 } // namespace schrodinger